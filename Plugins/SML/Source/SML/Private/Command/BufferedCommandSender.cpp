@@ -0,0 +1,31 @@
+#include "Command/BufferedCommandSender.h"
+
+void UBufferedCommandSender::Initialize(UCommandSender* InWrappedSender) {
+    WrappedSender = InWrappedSender;
+    BufferedMessages.Empty();
+    bHasErrorMessages = false;
+}
+
+void UBufferedCommandSender::Flush(const FString& SummaryLine) {
+    BufferedMessages.Add(SummaryLine);
+    WrappedSender->SendChatMessage(FString::Join(BufferedMessages, TEXT("\n")), bHasErrorMessages ? FLinearColor::Red : FLinearColor::Green);
+    BufferedMessages.Empty();
+    bHasErrorMessages = false;
+}
+
+FString UBufferedCommandSender::GetSenderName() const {
+    return WrappedSender->GetSenderName();
+}
+
+bool UBufferedCommandSender::IsPlayerSender() const {
+    return WrappedSender->IsPlayerSender();
+}
+
+AFGPlayerController* UBufferedCommandSender::GetPlayer() const {
+    return WrappedSender->GetPlayer();
+}
+
+void UBufferedCommandSender::SendChatMessage(const FString& Message, const FLinearColor PrefixColor) {
+    BufferedMessages.Add(Message);
+    bHasErrorMessages |= PrefixColor == FLinearColor::Red;
+}
@@ -4,6 +4,8 @@
 
 AChatCommandInstance::AChatCommandInstance() {
 	bOnlyUsableByPlayer = false;
+	bOnlyUsableByConsole = false;
+	bDisabledForPlayers = false;
 	MinNumberOfArguments = 0;
 }
 
@@ -1,6 +1,14 @@
 #include "Command/ChatCommandLibrary.h"
 #include "Command/CommandSender.h"
+#include "Command/ChatCommandTokenizer.h"
 #include "FGPlayerController.h"
+#include "FGPlayerState.h"
+#include "GameFramework/GameModeBase.h"
+#include "Patching/NativeHookManager.h"
+#include "Command/BufferedCommandSender.h"
+#include "Command/ConsoleCommandSender.h"
+#include "Command/SMLCommands/BatchCommandInstance.h"
+#include "Command/SMLCommands/ExecCommandInstance.h"
 #include "Command/SMLCommands/HelpCommandInstance.h"
 #include "Command/SMLCommands/InfoCommandInstance.h"
 #include "Command/SMLCommands/PlayerListCommandInstance.h"
@@ -9,8 +17,6 @@
 
 DEFINE_LOG_CATEGORY(LogChatCommand);
 
-FString ParseCommandArgument(const FString& Line, int32& Off);
-
 void PrintCommandNotFound(UCommandSender* Player) {
 	Player->SendChatMessage(TEXT("Unknown command. Type /help for a list of commands."), FLinearColor::Red);
 }
@@ -19,8 +25,43 @@ void PrintCommandOnlyUsableByPlayer(UCommandSender* Player) {
 	Player->SendChatMessage(TEXT("This command is only usable by players."), FLinearColor::Red);
 }
 
+/** Runs chat command from the face of the server console, which is the only way to run console only commands */
+static bool ChatCommandConsoleExec(UWorld* InWorld, const TCHAR* Cmd, FOutputDevice& Ar) {
+	if (FParse::Command(&Cmd, TEXT("SML.RunChatCommand"))) {
+		//Console of the connected client does not belong to the server owner
+		if (InWorld == NULL || InWorld->GetNetMode() == NM_Client) {
+			Ar.Log(TEXT("Chat commands can only be run from the server console"));
+			return true;
+		}
+		AChatCommandSubsystem* CommandSubsystem = AChatCommandSubsystem::Get(InWorld);
+		if (CommandSubsystem == NULL) {
+			Ar.Log(TEXT("Chat command subsystem is not available in this world"));
+			return true;
+		}
+		FString CommandLine = FString(Cmd).TrimStartAndEnd();
+		CommandLine.RemoveFromStart(TEXT("/"));
+
+		UConsoleCommandSender* ConsoleSender = NewObject<UConsoleCommandSender>(CommandSubsystem);
+		ConsoleSender->SetOutputDevice(&Ar);
+		CommandSubsystem->RunChatCommand(CommandLine, ConsoleSender);
+		ConsoleSender->SetOutputDevice(NULL);
+		return true;
+	}
+	return false;
+}
+
+static FStaticSelfRegisteringExec ChatCommandConsoleExecRegistration(&ChatCommandConsoleExec);
+
+/** Batches can run other batches, but never deep enough to exhaust the stack */
+static constexpr int32 MaxNestedBatchDepth = 4;
+
+FString GetExecutionStatusName(EExecutionStatus ExecutionStatus) {
+	return StaticEnum<EExecutionStatus>()->GetNameStringByValue((int64) ExecutionStatus);
+}
+
 AChatCommandSubsystem::AChatCommandSubsystem() {
 	this->ReplicationPolicy = ESubsystemReplicationPolicy::SpawnOnServer;
+	this->BatchDepth = 0;
 }
 
 AChatCommandSubsystem* AChatCommandSubsystem::Get(UObject* WorldContext) {
@@ -32,8 +73,19 @@ AChatCommandSubsystem* AChatCommandSubsystem::Get(UObject* WorldContext) {
 }
 
 AChatCommandInstance* AChatCommandSubsystem::FindCommandByName(const FString& Name) {
-	AChatCommandInstance** ChatCommandInstance = CommandByNameMap.Find(Name);
-	return ChatCommandInstance ? *ChatCommandInstance : NULL;
+	return FindCommandByNameInternal(FStringView(*Name, Name.Len()));
+}
+
+AChatCommandInstance* AChatCommandSubsystem::FindCommandByNameInternal(FStringView Name) const {
+	const int32 CommandIndex = CommandNameTrie.Find(Name);
+	return CommandIndex != INDEX_NONE ? RegisteredCommands[CommandIndex] : NULL;
+}
+
+TArray<FString> AChatCommandSubsystem::GetCommandNameCompletions(const FString& Prefix) const {
+	TArray<FString> CommandNames;
+	CommandNameTrie.FindByPrefix(FStringView(*Prefix, Prefix.Len()), CommandNames);
+	CommandNames.Sort();
+	return CommandNames;
 }
 
 TArray<AChatCommandInstance*> AChatCommandSubsystem::GetRegisteredCommands() const {
@@ -44,34 +96,122 @@ void AChatCommandSubsystem::Init() {
 	RegisterCommand(TEXT("SML"), AHelpCommandInstance::StaticClass());
 	RegisterCommand(TEXT("SML"), AInfoCommandInstance::StaticClass());
 	RegisterCommand(TEXT("SML"), APlayerListCommandInstance::StaticClass());
+	RegisterCommand(TEXT("SML"), ABatchCommandInstance::StaticClass());
+	RegisterCommand(TEXT("SML"), AExecCommandInstance::StaticClass());
+
+	//Index players which have joined before subsystem has been spawned, like the host of the listen server
+	for (TPlayerControllerIterator<AFGPlayerController>::ServerAll It(GetWorld()); It; ++It) {
+		const APlayerState* PlayerState = It->GetPlayerState<APlayerState>();
+		if (PlayerState != NULL) {
+			PlayerNameIndex.SetPlayerName(*It, PlayerState->GetPlayerName());
+		}
+	}
+	PostLoginDelegateHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &AChatCommandSubsystem::HandlePlayerPostLogin);
+	LogoutDelegateHandle = FGameModeEvents::GameModeLogoutEvent.AddUObject(this, &AChatCommandSubsystem::HandlePlayerLogout);
+
+	//Keep player name index up to date on rename. Handler is bound to this subsystem, so it is removed in EndPlay
+	//Hook is only installed in shipping, same as the rest of the subsystem patches, because FG code is not available in the editor
+	if (FPlatformProperties::RequiresCookedData()) {
+		APlayerState* PlayerStateInstance = GetMutableDefault<AFGPlayerState>();
+		SetPlayerNameHookHandle = SUBSCRIBE_METHOD_VIRTUAL_AFTER(APlayerState::SetPlayerName, PlayerStateInstance, [this](APlayerState* PlayerState, const FString& NewPlayerName) {
+			AFGPlayerController* PlayerController = Cast<AFGPlayerController>(PlayerState->GetOwner());
+			if (PlayerController != NULL && PlayerState->GetWorld() == GetWorld()) {
+				PlayerNameIndex.SetPlayerName(PlayerController, NewPlayerName);
+			}
+		});
+	}
 }
 
-TArray<AFGPlayerController*> AChatCommandSubsystem::ParsePlayerName(UCommandSender* Caller, const FString& Name, UObject* WorldContext) {
-	UWorld* World = GEngine->GetWorldFromContextObject(WorldContext, EGetWorldErrorMode::Assert);
-	TArray<AFGPlayerController*> PlayerControllers;
-	
-	if (Name == TEXT("@self") || Name == TEXT("@s")) {
+void AChatCommandSubsystem::EndPlay(const EEndPlayReason::Type EndPlayReason) {
+	FGameModeEvents::GameModePostLoginEvent.Remove(PostLoginDelegateHandle);
+	FGameModeEvents::GameModeLogoutEvent.Remove(LogoutDelegateHandle);
+	if (FPlatformProperties::RequiresCookedData()) {
+		UNSUBSCRIBE_METHOD(APlayerState::SetPlayerName, SetPlayerNameHookHandle);
+	}
+	PlayerNameIndex.Reset();
+	Super::EndPlay(EndPlayReason);
+}
+
+static bool NameEqualsSelector(FStringView Name, const TCHAR* Selector) {
+	return FCString::Strlen(Selector) == Name.Len() && FCString::Strncmp(Name.GetData(), Selector, Name.Len()) == 0;
+}
+
+void AChatCommandSubsystem::ResolvePlayerName(UCommandSender* Caller, FStringView Name, bool bFuzzyMatch, TArray<AFGPlayerController*>& OutPlayers) const {
+	if (NameEqualsSelector(Name, TEXT("@self")) || NameEqualsSelector(Name, TEXT("@s"))) {
 		if (Caller->IsPlayerSender()) {
-			PlayerControllers.Add(Caller->GetPlayer());
+			OutPlayers.Add(Caller->GetPlayer());
 		}
 	}
-	else if (Name == TEXT("@all") || Name == TEXT("@a")) {
-		for (TPlayerControllerIterator<AFGPlayerController>::ServerAll It(World); It; ++It) {
-			PlayerControllers.Add(*It);
+	else if (NameEqualsSelector(Name, TEXT("@all")) || NameEqualsSelector(Name, TEXT("@a"))) {
+		for (TPlayerControllerIterator<AFGPlayerController>::ServerAll It(GetWorld()); It; ++It) {
+			OutPlayers.Add(*It);
 		}
 	}
+	else if (bFuzzyMatch) {
+		PlayerNameIndex.ResolvePlayersFuzzy(Name, OutPlayers);
+	}
 	else {
-		for (TPlayerControllerIterator<AFGPlayerController>::ServerAll It(World); It; ++It) {
-			AFGPlayerController* Controller = *It;
-			APlayerState* PlayerState = Controller->GetPlayerState<APlayerState>();
-			if (PlayerState != NULL && PlayerState->GetPlayerName() == Name) {
-				PlayerControllers.Add(Controller);
+		PlayerNameIndex.FindPlayersByName(Name, OutPlayers);
+	}
+}
+
+TArray<AFGPlayerController*> AChatCommandSubsystem::ParsePlayerName(UCommandSender* Caller, const FString& Name, UObject* WorldContext) {
+	AChatCommandSubsystem* CommandSubsystem = Get(WorldContext);
+	TArray<AFGPlayerController*> PlayerControllers;
+	if (CommandSubsystem != NULL) {
+		CommandSubsystem->ResolvePlayerName(Caller, FStringView(*Name, Name.Len()), false, PlayerControllers);
+	}
+	return PlayerControllers;
+}
+
+TArray<AFGPlayerController*> AChatCommandSubsystem::ParsePlayerNameFuzzy(UCommandSender* Caller, const FString& Name, UObject* WorldContext) {
+	AChatCommandSubsystem* CommandSubsystem = Get(WorldContext);
+	TArray<AFGPlayerController*> PlayerControllers;
+	if (CommandSubsystem != NULL) {
+		CommandSubsystem->ResolvePlayerName(Caller, FStringView(*Name, Name.Len()), true, PlayerControllers);
+	}
+	return PlayerControllers;
+}
+
+TArray<AFGPlayerController*> AChatCommandSubsystem::ParsePlayerNames(UCommandSender* Caller, const TArray<FString>& Names, UObject* WorldContext) {
+	AChatCommandSubsystem* CommandSubsystem = Get(WorldContext);
+	TArray<AFGPlayerController*> PlayerControllers;
+	if (CommandSubsystem != NULL) {
+		TArray<AFGPlayerController*> NamePlayerControllers;
+		for (const FString& Name : Names) {
+			NamePlayerControllers.Reset();
+			CommandSubsystem->ResolvePlayerName(Caller, FStringView(*Name, Name.Len()), false, NamePlayerControllers);
+			for (AFGPlayerController* PlayerController : NamePlayerControllers) {
+				PlayerControllers.AddUnique(PlayerController);
 			}
 		}
 	}
 	return PlayerControllers;
 }
 
+TArray<AFGPlayerController*> AChatCommandSubsystem::GetPlayerNameCompletions(const FString& Prefix) const {
+	TArray<AFGPlayerController*> PlayerControllers;
+	PlayerNameIndex.FindPlayersByPrefix(FStringView(*Prefix, Prefix.Len()), PlayerControllers);
+	return PlayerControllers;
+}
+
+void AChatCommandSubsystem::HandlePlayerPostLogin(AGameModeBase* GameMode, APlayerController* Controller) {
+	AFGPlayerController* PlayerController = Cast<AFGPlayerController>(Controller);
+	if (GameMode->GetWorld() == GetWorld() && PlayerController != NULL) {
+		const APlayerState* PlayerState = PlayerController->GetPlayerState<APlayerState>();
+		if (PlayerState != NULL) {
+			PlayerNameIndex.SetPlayerName(PlayerController, PlayerState->GetPlayerName());
+		}
+	}
+}
+
+void AChatCommandSubsystem::HandlePlayerLogout(AGameModeBase* GameMode, AController* Controller) {
+	AFGPlayerController* PlayerController = Cast<AFGPlayerController>(Controller);
+	if (GameMode->GetWorld() == GetWorld() && PlayerController != NULL) {
+		PlayerNameIndex.RemovePlayer(PlayerController);
+	}
+}
+
 FString MakeFQCommandName(const FString& ModId, const FString& Name) {
 	return FString::Printf(TEXT("%s:%s"), *ModId, *Name);
 }
@@ -81,7 +221,7 @@ void AChatCommandSubsystem::RegisterCommand(const FString& ModReference, TSubcla
 	AChatCommandInstance* CommandCDO = CommandClass->GetDefaultObject<AChatCommandInstance>();
 	const FString FqCommandName = MakeFQCommandName(ModReference, CommandCDO->CommandName);
 	//Only register command if it's not already registered
-	if (!CommandByNameMap.Contains(FqCommandName)) {
+	if (FindCommandByName(FqCommandName) == NULL) {
 		const FString ActorName = FString::Printf(TEXT("ChatCommand_%s_%s"), *ModReference, *CommandCDO->CommandName);
 		//Spawn command actor with predefined name
 		FActorSpawnParameters SpawnParams;
@@ -90,6 +230,11 @@ void AChatCommandSubsystem::RegisterCommand(const FString& ModReference, TSubcla
 		check(Command);
 		//Make sure ModReference is set for spawned command actor
 		Command->ModReference = *ModReference;
+		//Configuration is only loaded on startup, so there is no need to check it on every execution
+		Command->bDisabledForPlayers = FSatisfactoryModLoader::GetSMLConfiguration().DisabledChatCommands.Contains(FqCommandName);
+
+		//Add command actor to the registered actor list
+		const int32 CommandIndex = RegisteredCommands.Add(Command);
 
 		//register all command aliases
 		TArray<FString> AllCommandNames;
@@ -97,53 +242,95 @@ void AChatCommandSubsystem::RegisterCommand(const FString& ModReference, TSubcla
 		AllCommandNames.Append(Command->Aliases);
 	
 		for (const FString& CommandAlias : AllCommandNames) {
-			const FString FqCommandAlias = MakeFQCommandName(ModReference, CommandAlias);
-			CommandByNameMap.Add(CommandAlias.ToLower(), Command);
-			CommandByNameMap.Add(FqCommandAlias.ToLower(), Command);
+			CommandNameTrie.Add(CommandAlias, CommandIndex);
+			CommandNameTrie.Add(MakeFQCommandName(ModReference, CommandAlias), CommandIndex);
 		}
-		//Add command actor to the registered actor list
-		RegisteredCommands.Add(Command);
 		UE_LOG(LogChatCommand, Display, TEXT("Registered chat command %s:%s"), *ModReference, *Command->CommandName);
 	}
 }
 
 EExecutionStatus AChatCommandSubsystem::RunChatCommand(const FString& CommandLine, UCommandSender* Sender) {
-	//Empty command line, print help
-	if (CommandLine.IsEmpty()) {
-		PrintCommandNotFound(Sender);
-		return EExecutionStatus::BAD_ARGUMENTS;
+	const EExecutionStatus ExecutionStatus = ExecuteCommandLine(CommandLine, Sender);
+
+	//Print some logging information about command executed and response
+	UE_LOG(LogChatCommand, Display, TEXT("%s: /%s [%s]"), *Sender->GetSenderName(), *CommandLine, *GetExecutionStatusName(ExecutionStatus));
+	return ExecutionStatus;
+}
+
+EExecutionStatus AChatCommandSubsystem::RunChatCommandBatch(const TArray<FString>& CommandLines, UCommandSender* Sender) {
+	if (BatchDepth >= MaxNestedBatchDepth) {
+		Sender->SendChatMessage(TEXT("Command batches are nested too deep."), FLinearColor::Red);
+		return EExecutionStatus::UNCOMPLETED;
 	}
+	UBufferedCommandSender* BufferedSender = NewObject<UBufferedCommandSender>(this);
+	BufferedSender->Initialize(Sender);
+
+	EExecutionStatus BatchStatus = EExecutionStatus::COMPLETED;
+	int32 NumCompleted = 0;
+	BatchDepth++;
+	for (const FString& CommandLine : CommandLines) {
+		const EExecutionStatus ExecutionStatus = ExecuteCommandLine(CommandLine, BufferedSender);
+		UE_LOG(LogChatCommand, Verbose, TEXT("%s: /%s [%s]"), *Sender->GetSenderName(), *CommandLine, *GetExecutionStatusName(ExecutionStatus));
+		if (ExecutionStatus == EExecutionStatus::COMPLETED) {
+			NumCompleted++;
+		} else if (BatchStatus == EExecutionStatus::COMPLETED) {
+			BatchStatus = ExecutionStatus;
+		}
+	}
+	BatchDepth--;
+
+	const FString Summary = FString::Printf(TEXT("Executed %d commands, %d completed"), CommandLines.Num(), NumCompleted);
+	BufferedSender->Flush(Summary);
+	UE_LOG(LogChatCommand, Display, TEXT("%s: batch of %d commands [%s], %d completed"), *Sender->GetSenderName(), CommandLines.Num(), *GetExecutionStatusName(BatchStatus), NumCompleted);
+	return BatchStatus;
+}
+
+EExecutionStatus AChatCommandSubsystem::RunChatCommandScript(const FString& Script, UCommandSender* Sender) {
+	TArray<FString> ScriptLines;
+	Script.ParseIntoArrayLines(ScriptLines);
 
+	TArray<FString> CommandLines;
+	CommandLines.Reserve(ScriptLines.Num());
+	for (FString& ScriptLine : ScriptLines) {
+		ScriptLine.TrimStartAndEndInline();
+		if (ScriptLine.IsEmpty() || ScriptLine.StartsWith(TEXT("#"))) {
+			continue;
+		}
+		CommandLines.Add(ScriptLine.StartsWith(TEXT("/")) ? ScriptLine.RightChop(1) : MoveTemp(ScriptLine));
+	}
+	return RunChatCommandBatch(CommandLines, Sender);
+}
+
+EExecutionStatus AChatCommandSubsystem::ExecuteCommandLine(const FString& CommandLine, UCommandSender* Sender) {
 	//Split command into the separate arguments respecting escaped spaces and quotes
-	TArray<FString> ResultArgArray;
-	int32 Offset = 0;
-	while (CommandLine.Len() > Offset) {
-		FString resultArg = ParseCommandArgument(CommandLine, Offset);
-		ResultArgArray.Add(resultArg);
-		//skip argument separator
-		Offset++; 
+	TArray<FChatCommandToken> Tokens;
+	FChatCommandTokenizer::Tokenize(FStringView(*CommandLine, CommandLine.Len()), Tokens);
+
+	//Empty command line, print help
+	if (Tokens.Num() == 0) {
+		PrintCommandNotFound(Sender);
+		return EExecutionStatus::BAD_ARGUMENTS;
 	}
-	
-	//First element in the argument array is always a command name
-	const FString CommandAliasUsed = ResultArgArray[0];
 
-	//Remove command name from arguments array
-	ResultArgArray.RemoveAt(0);
-	AChatCommandInstance* CommandEntry = FindCommandByName(CommandAliasUsed);
+	//First token is always a command name
+	AChatCommandInstance* CommandEntry = FindCommandByNameInternal(Tokens[0].Text);
 	if (CommandEntry == nullptr) {
 		PrintCommandNotFound(Sender);
 		return EExecutionStatus::BAD_ARGUMENTS;
 	}
-	
-	const FString CommandFQName = MakeFQCommandName(CommandEntry->GetOwnerModReference().ToString(), CommandEntry->CommandName);
-	const FSMLConfiguration Configuration = FSatisfactoryModLoader::GetSMLConfiguration();
 
 	//Check if command has been disabled in SML configuration
-	if (Configuration.DisabledChatCommands.Contains(CommandFQName) && Sender->IsPlayerSender()) {
+	if (CommandEntry->bDisabledForPlayers && Sender->IsPlayerSender()) {
 		Sender->SendChatMessage(TEXT("This command has been disabled by server owner."), FLinearColor::Red);
 		return EExecutionStatus::INSUFFICIENT_PERMISSIONS;
 	}
 
+	//Check if command is console only, and we are trying to run it as player
+	if (CommandEntry->bOnlyUsableByConsole && Sender->IsPlayerSender()) {
+		Sender->SendChatMessage(TEXT("This command is only usable from the server console."), FLinearColor::Red);
+		return EExecutionStatus::INSUFFICIENT_PERMISSIONS;
+	}
+
 	//Check if command is play only, and we are trying to run it as server
 	if (CommandEntry->bOnlyUsableByPlayer && !Sender->IsPlayerSender()) {
 		PrintCommandOnlyUsableByPlayer(Sender);
@@ -151,50 +338,19 @@ EExecutionStatus AChatCommandSubsystem::RunChatCommand(const FString& CommandLin
 	}
 
 	//Check if command doesn't have enough arguments
-	if (CommandEntry->MinNumberOfArguments > ResultArgArray.Num()) {
+	if (CommandEntry->MinNumberOfArguments > Tokens.Num() - 1) {
 		CommandEntry->PrintCommandUsage(Sender);
 		return EExecutionStatus::BAD_ARGUMENTS;
 	}
 
-	//Actually run command now and return response
-	EExecutionStatus ExecutionStatus = CommandEntry->ExecuteCommand(Sender, ResultArgArray, CommandAliasUsed);
-
-	//Print some logging information about command executed and response
-	UEnum* ExecutionStatusEnum = StaticEnum<EExecutionStatus>();
-	const FString StatusString = ExecutionStatusEnum->GetNameStringByValue((int64) ExecutionStatus);
-	UE_LOG(LogChatCommand, Display, TEXT("%s: /%s [%s]"), *Sender->GetSenderName(), *CommandLine, *StatusString);
-
-	return ExecutionStatus;
-}
-
-FString ParseCommandArgument(const FString& Line, int32& Off) {
-	if (Off >= Line.Len()) return TEXT("");
-	const wchar_t EscapeChar = TEXT('\\');
-	const wchar_t FirstChar = Line[Off++];
-	bool bPreviousCharIsEscape = FirstChar == EscapeChar;
-	const bool bIsQuoted = FirstChar == TEXT('"');
-	const wchar_t breakCharacter = bIsQuoted ? TEXT('"') : TEXT(' ');
-	FString Result;
-	//if first char is not a quote, append it too!
-	if (!bIsQuoted && !bPreviousCharIsEscape) {
-		Result.AppendChar(FirstChar);
-	}
-	while (Line.Len() > Off) {
-		const wchar_t Character = Line[Off];
-		if (!bPreviousCharIsEscape) {
-			//break on the control character
-			if (Character == breakCharacter) break;
-			//set last character as escape
-			if (Character == EscapeChar) {
-				bPreviousCharIsEscape = true;
-				//continue here to skip resetting prevIsEscape
-				//and adding character to the result
-				continue;
-			}
-		}
-		Result.AppendChar(Character);
-		bPreviousCharIsEscape = false;
-		Off++;
+	//Arguments are only copied into strings once command is actually going to be executed
+	const FString CommandAliasUsed = Tokens[0].ToString();
+	TArray<FString> Arguments;
+	Arguments.Reserve(Tokens.Num() - 1);
+	for (int32 i = 1; i < Tokens.Num(); i++) {
+		Arguments.Add(Tokens[i].ToString());
 	}
-	return Result;
+
+	//Actually run command now and return response
+	return CommandEntry->ExecuteCommand(Sender, Arguments, CommandAliasUsed);
 }
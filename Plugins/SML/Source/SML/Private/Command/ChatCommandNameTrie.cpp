@@ -0,0 +1,62 @@
+#include "Command/ChatCommandNameTrie.h"
+
+FChatCommandNameTrie::FChatCommandNameTrie() {
+	Nodes.AddDefaulted();
+}
+
+int32 FChatCommandNameTrie::FindChild(int32 NodeIndex, TCHAR Character) const {
+	//Nodes rarely have more than a few children, so linear search is faster than any map here
+	for (const TPair<TCHAR, int32>& Child : Nodes[NodeIndex].Children) {
+		if (Child.Key == Character) {
+			return Child.Value;
+		}
+	}
+	return INDEX_NONE;
+}
+
+int32 FChatCommandNameTrie::FindNode(FStringView Name) const {
+	int32 NodeIndex = 0;
+	for (int32 i = 0; i < Name.Len() && NodeIndex != INDEX_NONE; i++) {
+		NodeIndex = FindChild(NodeIndex, FChar::ToLower(Name[i]));
+	}
+	return NodeIndex;
+}
+
+void FChatCommandNameTrie::Add(const FString& Name, int32 CommandIndex) {
+	int32 NodeIndex = 0;
+	for (const TCHAR Character : Name) {
+		const TCHAR LowerCharacter = FChar::ToLower(Character);
+		int32 ChildIndex = FindChild(NodeIndex, LowerCharacter);
+		if (ChildIndex == INDEX_NONE) {
+			ChildIndex = Nodes.AddDefaulted();
+			Nodes[NodeIndex].Children.Add(TPair<TCHAR, int32>(LowerCharacter, ChildIndex));
+		}
+		NodeIndex = ChildIndex;
+	}
+	Nodes[NodeIndex].CommandIndex = CommandIndex;
+	Nodes[NodeIndex].Name = Name;
+}
+
+int32 FChatCommandNameTrie::Find(FStringView Name) const {
+	const int32 NodeIndex = FindNode(Name);
+	return NodeIndex != INDEX_NONE ? Nodes[NodeIndex].CommandIndex : INDEX_NONE;
+}
+
+void FChatCommandNameTrie::FindByPrefix(FStringView Prefix, TArray<FString>& OutNames) const {
+	const int32 PrefixNodeIndex = FindNode(Prefix);
+	if (PrefixNodeIndex == INDEX_NONE) {
+		return;
+	}
+	TArray<int32, TInlineAllocator<32>> NodeStack;
+	NodeStack.Push(PrefixNodeIndex);
+	
+	while (NodeStack.Num() > 0) {
+		const FNode& Node = Nodes[NodeStack.Pop(false)];
+		if (Node.CommandIndex != INDEX_NONE) {
+			OutNames.Add(Node.Name);
+		}
+		for (const TPair<TCHAR, int32>& Child : Node.Children) {
+			NodeStack.Push(Child.Value);
+		}
+	}
+}
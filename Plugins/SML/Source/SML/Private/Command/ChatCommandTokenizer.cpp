@@ -0,0 +1,63 @@
+#include "Command/ChatCommandTokenizer.h"
+
+static constexpr TCHAR EscapeChar = TEXT('\\');
+static constexpr TCHAR QuoteChar = TEXT('"');
+static constexpr TCHAR SeparatorChar = TEXT(' ');
+
+FString FChatCommandToken::ToString() const {
+	if (!bHasEscapes) {
+		return FString(Text.Len(), Text.GetData());
+	}
+	FString Result;
+	Result.Reserve(Text.Len());
+	for (int32 i = 0; i < Text.Len(); i++) {
+		//Escape character is dropped, and the character following it is appended as is
+		if (Text[i] == EscapeChar && i + 1 < Text.Len()) {
+			i++;
+		}
+		Result.AppendChar(Text[i]);
+	}
+	return Result;
+}
+
+void FChatCommandTokenizer::Tokenize(FStringView CommandLine, TArray<FChatCommandToken>& OutTokens) {
+	const int32 Length = CommandLine.Len();
+	int32 Offset = 0;
+	
+	while (true) {
+		//Skip argument separators, multiple spaces in a row do not produce empty arguments
+		while (Offset < Length && CommandLine[Offset] == SeparatorChar) {
+			Offset++;
+		}
+		if (Offset >= Length) {
+			break;
+		}
+		const bool bIsQuoted = CommandLine[Offset] == QuoteChar;
+		const TCHAR BreakChar = bIsQuoted ? QuoteChar : SeparatorChar;
+		if (bIsQuoted) {
+			Offset++;
+		}
+		
+		const int32 TokenStart = Offset;
+		bool bHasEscapes = false;
+		while (Offset < Length) {
+			const TCHAR Character = CommandLine[Offset];
+			//Escape consumes the character following it, so escaped quotes and spaces do not end the argument
+			if (Character == EscapeChar && Offset + 1 < Length) {
+				bHasEscapes = true;
+				Offset += 2;
+				continue;
+			}
+			if (Character == BreakChar) {
+				break;
+			}
+			Offset++;
+		}
+		OutTokens.Add(FChatCommandToken{CommandLine.Mid(TokenStart, Offset - TokenStart), bHasEscapes});
+		
+		//Skip closing quote
+		if (bIsQuoted && Offset < Length) {
+			Offset++;
+		}
+	}
+}
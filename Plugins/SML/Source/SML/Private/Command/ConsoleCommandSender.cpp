@@ -0,0 +1,34 @@
+#include "Command/ConsoleCommandSender.h"
+#include "Command/ChatCommandLibrary.h"
+
+UConsoleCommandSender::UConsoleCommandSender() : OutputDevice(NULL) {
+}
+
+void UConsoleCommandSender::SetOutputDevice(FOutputDevice* InOutputDevice) {
+    OutputDevice = InOutputDevice;
+}
+
+FString UConsoleCommandSender::GetSenderName() const {
+    return TEXT("[Console]");
+}
+
+bool UConsoleCommandSender::IsPlayerSender() const {
+    return false;
+}
+
+AFGPlayerController* UConsoleCommandSender::GetPlayer() const {
+    return nullptr;
+}
+
+void UConsoleCommandSender::SendChatMessage(const FString& Message, const FLinearColor PrefixColor) {
+    const bool bIsError = PrefixColor == FLinearColor::Red;
+    if (bIsError) {
+        UE_LOG(LogChatCommand, Warning, TEXT("%s"), *Message);
+    } else {
+        UE_LOG(LogChatCommand, Display, TEXT("%s"), *Message);
+    }
+    //Log output already reaches the server console, so only forward to devices that are not the log itself
+    if (OutputDevice != NULL && OutputDevice != GLog) {
+        OutputDevice->Log(Message);
+    }
+}
@@ -0,0 +1,115 @@
+#include "Command/PlayerNameIndex.h"
+#include "FGPlayerController.h"
+#include "Algo/BinarySearch.h"
+
+/**
+ * Compares lowercase name with the first characters of the name, ignoring case of the latter
+ * Characters are compared by their code points, which is the same ordering entries are inserted with
+ */
+static int32 CompareLowerNamePrefix(const FString& LowerName, FStringView Name) {
+	const int32 CompareLength = FMath::Min(LowerName.Len(), Name.Len());
+	for (int32 i = 0; i < CompareLength; i++) {
+		const TCHAR NameCharacter = FChar::ToLower(Name[i]);
+		if (LowerName[i] != NameCharacter) {
+			return LowerName[i] < NameCharacter ? -1 : 1;
+		}
+	}
+	//Lowercase name shorter than the given name is ordered before it
+	return LowerName.Len() < Name.Len() ? -1 : 0;
+}
+
+void FPlayerNameIndex::SetPlayerName(AFGPlayerController* Controller, const FString& PlayerName) {
+	RemovePlayer(Controller);
+	
+	//Ordinal comparison, since FString::operator< folds the case in a platform specific way that disagrees with the binary search
+	FEntry NewEntry{Controller, PlayerName, PlayerName.ToLower()};
+	const int32 InsertIndex = Algo::LowerBound(Entries, NewEntry.LowerPlayerName, [](const FEntry& Entry, const FString& LowerPlayerName) {
+		return Entry.LowerPlayerName.Compare(LowerPlayerName, ESearchCase::CaseSensitive) < 0;
+	});
+	Entries.Insert(MoveTemp(NewEntry), InsertIndex);
+}
+
+void FPlayerNameIndex::RemovePlayer(AFGPlayerController* Controller) {
+	//Stale entries of destroyed controllers are dropped together with the removed one
+	Entries.RemoveAll([Controller](const FEntry& Entry) {
+		return !Entry.Controller.IsValid() || Entry.Controller.Get() == Controller;
+	});
+}
+
+void FPlayerNameIndex::Reset() {
+	Entries.Empty();
+}
+
+void FPlayerNameIndex::FindEntryRange(FStringView Name, bool bExactMatch, int32& OutStartIndex, int32& OutEndIndex) const {
+	int32 Low = 0;
+	int32 High = Entries.Num();
+	while (Low < High) {
+		const int32 Middle = Low + (High - Low) / 2;
+		if (CompareLowerNamePrefix(Entries[Middle].LowerPlayerName, Name) < 0) {
+			Low = Middle + 1;
+		} else {
+			High = Middle;
+		}
+	}
+	OutStartIndex = Low;
+	OutEndIndex = Low;
+	//Every entry of the range starts with the name, and for exact match it should not be any longer than it
+	while (OutEndIndex < Entries.Num() && CompareLowerNamePrefix(Entries[OutEndIndex].LowerPlayerName, Name) == 0 &&
+		(!bExactMatch || Entries[OutEndIndex].LowerPlayerName.Len() == Name.Len())) {
+		OutEndIndex++;
+	}
+}
+
+void FPlayerNameIndex::FindPlayersByName(FStringView Name, TArray<AFGPlayerController*>& OutPlayers) const {
+	if (Name.Len() == 0) {
+		return;
+	}
+	int32 StartIndex, EndIndex;
+	FindEntryRange(Name, true, StartIndex, EndIndex);
+	for (int32 i = StartIndex; i < EndIndex; i++) {
+		if (Entries[i].Controller.IsValid()) {
+			OutPlayers.Add(Entries[i].Controller.Get());
+		}
+	}
+}
+
+void FPlayerNameIndex::ResolvePlayersFuzzy(FStringView Name, TArray<AFGPlayerController*>& OutPlayers) const {
+	if (Name.Len() == 0) {
+		return;
+	}
+	int32 StartIndex, EndIndex;
+	FindEntryRange(Name, true, StartIndex, EndIndex);
+	
+	if (StartIndex != EndIndex) {
+		//Prefer players whose names match with the case, and fall back to all of the case insensitive matches otherwise
+		const int32 InitialNum = OutPlayers.Num();
+		for (int32 i = StartIndex; i < EndIndex; i++) {
+			if (Entries[i].Controller.IsValid() && FCString::Strncmp(*Entries[i].PlayerName, Name.GetData(), Name.Len()) == 0) {
+				OutPlayers.Add(Entries[i].Controller.Get());
+			}
+		}
+		if (OutPlayers.Num() == InitialNum) {
+			for (int32 i = StartIndex; i < EndIndex; i++) {
+				if (Entries[i].Controller.IsValid()) {
+					OutPlayers.Add(Entries[i].Controller.Get());
+				}
+			}
+		}
+		return;
+	}
+	
+	FindEntryRange(Name, false, StartIndex, EndIndex);
+	if (EndIndex - StartIndex == 1 && Entries[StartIndex].Controller.IsValid()) {
+		OutPlayers.Add(Entries[StartIndex].Controller.Get());
+	}
+}
+
+void FPlayerNameIndex::FindPlayersByPrefix(FStringView Prefix, TArray<AFGPlayerController*>& OutPlayers) const {
+	int32 StartIndex, EndIndex;
+	FindEntryRange(Prefix, false, StartIndex, EndIndex);
+	for (int32 i = StartIndex; i < EndIndex; i++) {
+		if (Entries[i].Controller.IsValid()) {
+			OutPlayers.Add(Entries[i].Controller.Get());
+		}
+	}
+}
@@ -0,0 +1,14 @@
+#include "Command/SMLCommands/BatchCommandInstance.h"
+#include "Command/ChatCommandLibrary.h"
+
+ABatchCommandInstance::ABatchCommandInstance() {
+	CommandName = TEXT("batch");
+	Usage = TEXT("/batch \"<command>\" [\"<command>\"...] - Runs multiple commands at once, replying with their combined output");
+	MinNumberOfArguments = 1;
+}
+
+EExecutionStatus ABatchCommandInstance::ExecuteCommand_Implementation(UCommandSender* Sender, const TArray<FString>& Arguments, const FString& Label) {
+	AChatCommandSubsystem* CommandSubsystem = AChatCommandSubsystem::Get(this);
+	check(CommandSubsystem);
+	return CommandSubsystem->RunChatCommandBatch(Arguments, Sender);
+}
@@ -0,0 +1,39 @@
+#include "Command/SMLCommands/ExecCommandInstance.h"
+#include "Command/ChatCommandLibrary.h"
+#include "Command/CommandSender.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+AExecCommandInstance::AExecCommandInstance() {
+	CommandName = TEXT("exec");
+	Usage = TEXT("/exec <script> - Runs commands from the script in Configs/Scripts, replying with their combined output");
+	MinNumberOfArguments = 1;
+	//Scripts are maintained by the server owner, so they can only be run from the server console using SML.RunChatCommand
+	bOnlyUsableByConsole = true;
+}
+
+FString AExecCommandInstance::GetScriptsDirectory() {
+	return FPaths::ProjectDir() + TEXT("Configs/Scripts/");
+}
+
+EExecutionStatus AExecCommandInstance::ExecuteCommand_Implementation(UCommandSender* Sender, const TArray<FString>& Arguments, const FString& Label) {
+	//Only plain file names are accepted, so scripts outside of the scripts directory can never be executed
+	FString ScriptName = Arguments[0];
+	if (ScriptName.IsEmpty() || FPaths::GetCleanFilename(ScriptName) != ScriptName || ScriptName.Contains(TEXT(".."))) {
+		Sender->SendChatMessage(FString::Printf(TEXT("Invalid script name: %s"), *ScriptName), FLinearColor::Red);
+		return EExecutionStatus::BAD_ARGUMENTS;
+	}
+	if (FPaths::GetExtension(ScriptName).IsEmpty()) {
+		ScriptName.Append(TEXT(".txt"));
+	}
+
+	FString Script;
+	if (!FFileHelper::LoadFileToString(Script, *(GetScriptsDirectory() + ScriptName))) {
+		Sender->SendChatMessage(FString::Printf(TEXT("Script not found: %s"), *ScriptName), FLinearColor::Red);
+		return EExecutionStatus::BAD_ARGUMENTS;
+	}
+	
+	AChatCommandSubsystem* CommandSubsystem = AChatCommandSubsystem::Get(this);
+	check(CommandSubsystem);
+	return CommandSubsystem->RunChatCommandScript(Script, Sender);
+}
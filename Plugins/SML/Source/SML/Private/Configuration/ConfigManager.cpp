@@ -8,6 +8,7 @@
 #include "Engine/Engine.h"
 #include "ModLoading/ModLoadingLibrary.h"
 #include "Util/EngineUtil.h"
+#include "Util/PhaseTimeline.h"
 
 DEFINE_LOG_CATEGORY(LogConfigManager);
 
@@ -60,6 +61,8 @@ void UConfigManager::SaveConfigurationInternal(const FConfigId& ConfigId) {
 }
 
 void UConfigManager::LoadConfigurationInternal(const FConfigId& ConfigId, URootConfigValueHolder* RootConfigValueHolder, bool bSaveOnSchemaChange) {
+    FPhaseTimelineScope TimelineScope(TEXT("Config"), TEXT("LoadConfiguration"), ConfigId.ModReference);
+    
     //Determine configuration path and try to read it to string if it exists
     const FString ConfigurationFilePath = GetConfigurationFilePath(ConfigId);
 
@@ -241,6 +244,7 @@ void UConfigManager::RegisterModConfiguration(TSubclassOf<UModConfiguration> Con
 
     UModConfiguration* ClassDefaultObject = Configuration.GetDefaultObject();
     const FConfigId ConfigId = ClassDefaultObject->ConfigId;
+    FPhaseTimelineScope TimelineScope(TEXT("Config"), TEXT("RegisterConfiguration"), ConfigId.ModReference);
     FRegisteredConfigurationData* ExistingData = Configurations.Find(ConfigId);
 
     //Registration already exists for this configuration ID
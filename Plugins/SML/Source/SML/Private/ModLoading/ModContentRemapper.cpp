@@ -2,8 +2,13 @@
 
 #include "SatisfactoryModLoader.h"
 #include "Interfaces/IPluginManager.h"
+#include "Misc/StringBuilder.h"
+#include "Patching/NativeHookManager.h"
 #include "UObject/CoreRedirects.h"
 
+TMap<FName, FString> UModContentRemapper::PluginContentRoots;
+FRWLock UModContentRemapper::PluginContentRootsLock;
+
 void UModContentRemapper::RegisterPackageRedirect(const FString& OriginalPackage, const FString& NewPackage, bool bMatchSubstring) {
 	ECoreRedirectFlags Flags = ECoreRedirectFlags::Type_Package;
 	if (bMatchSubstring) {
@@ -26,37 +31,102 @@ bool UModContentRemapper::ShouldCreateSubsystem(UObject* Outer) const {
 	return FPlatformProperties::RequiresCookedData();
 }
 
-FCoreRedirect MakeRedirectForPlugin(IPlugin& Plugin) {
-	const FString OldPath = FString::Printf(TEXT("/Game/%s/"), *Plugin.GetName());
-	const FString NewPath = Plugin.GetMountedAssetPath();
-	const ECoreRedirectFlags Flags = ECoreRedirectFlags::Type_Package | ECoreRedirectFlags::Option_MatchSubstring;
-	return FCoreRedirect(Flags, OldPath, NewPath);
+bool UModContentRemapper::RegisterPluginContentRoot(IPlugin& Plugin) {
+	const FName PluginName = *Plugin.GetName();
+	FRWScopeLock ScopeLock(PluginContentRootsLock, SLT_Write);
+	if (PluginContentRoots.Contains(PluginName)) {
+		return false;
+	}
+	PluginContentRoots.Add(PluginName, Plugin.GetMountedAssetPath());
+	return true;
 }
 
-void UModContentRemapper::Initialize(FSubsystemCollectionBase& Collection) {
-	TArray<FCoreRedirect> PluginRemaps;
+bool UModContentRemapper::RemapPluginPackageName(const FCoreRedirectObjectName& ObjectName, FCoreRedirectObjectName& OutRemappedName) {
+	if (ObjectName.PackageName.IsNone()) {
+		return false;
+	}
+	TStringBuilder<256> PackageName;
+	ObjectName.PackageName.AppendString(PackageName);
+	
+	const FStringView GameContentRoot = TEXT("/Game/");
+	const FStringView PackageNameView = PackageName.ToView();
+	if (!PackageNameView.StartsWith(GameContentRoot, ESearchCase::IgnoreCase)) {
+		return false;
+	}
+	const FStringView RelativePath = PackageNameView.RightChop(GameContentRoot.Len());
+	int32 SlashIndex;
+	if (!RelativePath.FindChar(TEXT('/'), SlashIndex)) {
+		return false;
+	}
+	
+	//Plugin names are always present in the name table once registered, so we never need to add the segment to it
+	const FName FirstPathSegment(SlashIndex, RelativePath.GetData(), FNAME_Find);
+	if (FirstPathSegment.IsNone()) {
+		return false;
+	}
+	
+	FRWScopeLock ScopeLock(PluginContentRootsLock, SLT_ReadOnly);
+	const FString* ContentRoot = PluginContentRoots.Find(FirstPathSegment);
+	if (ContentRoot == NULL) {
+		return false;
+	}
+	TStringBuilder<256> RemappedPackageName;
+	RemappedPackageName.Append(*ContentRoot);
+	RemappedPackageName.Append(RelativePath.RightChop(SlashIndex + 1));
 	
+	OutRemappedName = ObjectName;
+	OutRemappedName.PackageName = FName(RemappedPackageName.ToString());
+	return true;
+}
+
+void UModContentRemapper::InstallPackageRedirectHook() {
+	static bool bHookInstalled = false;
+	if (bHookInstalled) {
+		return;
+	}
+	bHookInstalled = true;
+
+	//Package name is remapped for every lookup type, since class and object lookups of the plugin content
+	//(like linker import fixups and StaticLoadObject) carry the /Game/<Plugin>/ package name too
+	//Remapped names never start with /Game/, so remapping is never applied twice when one hooked function calls another
+	SUBSCRIBE_METHOD(FCoreRedirects::RedirectNameAndValues, [](auto& Call, ECoreRedirectFlags Type, const FCoreRedirectObjectName& OldObjectName, FCoreRedirectObjectName& NewObjectName, const FCoreRedirect** FoundValueRedirect) {
+		FCoreRedirectObjectName RemappedObjectName;
+		if (RemapPluginPackageName(OldObjectName, RemappedObjectName)) {
+			//Regular redirects still apply on top of the remapped plugin content path
+			if (!Call(Type, RemappedObjectName, NewObjectName, FoundValueRedirect)) {
+				NewObjectName = RemappedObjectName;
+			}
+			Call.Override(true);
+		}
+	});
+	
+	//GetRedirectedName is hooked separately, since the call to RedirectNameAndValues can be inlined into it
+	SUBSCRIBE_METHOD(FCoreRedirects::GetRedirectedName, [](auto& Call, ECoreRedirectFlags Type, const FCoreRedirectObjectName& OldObjectName) {
+		FCoreRedirectObjectName RemappedObjectName;
+		if (RemapPluginPackageName(OldObjectName, RemappedObjectName)) {
+			Call.Override(Call(Type, RemappedObjectName));
+		}
+	});
+}
+
+void UModContentRemapper::Initialize(FSubsystemCollectionBase& Collection) {
 	IPluginManager& PluginManager = IPluginManager::Get();
 	PluginManager.OnNewPluginCreated().AddUObject(this, &UModContentRemapper::OnNewPluginMounted);
 	PluginManager.OnNewPluginMounted().AddUObject(this, &UModContentRemapper::OnNewPluginMounted);
 	
+	int32 PluginRemapsRegistered = 0;
 	TArray<TSharedRef<IPlugin>> EnabledPluginsWithContent = PluginManager.GetEnabledPluginsWithContent();
 	for (const TSharedRef<IPlugin>& Plugin : EnabledPluginsWithContent) {
-		if (Plugin->GetType() == EPluginType::Mod) {
-			PluginRemaps.Add(MakeRedirectForPlugin(Plugin.Get()));
+		if (Plugin->GetType() == EPluginType::Mod && RegisterPluginContentRoot(Plugin.Get())) {
+			PluginRemapsRegistered++;
 		}
 	}
-	FCoreRedirects::AddRedirectList(PluginRemaps, TEXT("UModContentRemapper::Initialize"));
-	UE_LOG(LogSatisfactoryModLoader, Log, TEXT("Registered %d plugin content remaps"), PluginRemaps.Num());
+	InstallPackageRedirectHook();
+	UE_LOG(LogSatisfactoryModLoader, Log, TEXT("Registered %d plugin content remaps"), PluginRemapsRegistered);
 }
 
 void UModContentRemapper::OnNewPluginMounted(IPlugin& Plugin) {
 	if (Plugin.IsEnabled() && Plugin.GetType() == EPluginType::Mod && Plugin.CanContainContent()) {
-		const FString PluginName = Plugin.GetName();
-		if (!PluginsAlreadyHandled.Contains(PluginName)) {
-			const FCoreRedirect PluginRedirect = MakeRedirectForPlugin(Plugin);
-			FCoreRedirects::AddRedirectList({PluginRedirect}, TEXT("UModContentRemapper::OnNewPluginMounted"));
-			this->PluginsAlreadyHandled.Add(PluginName);
-		}
+		RegisterPluginContentRoot(Plugin);
 	}
 }
@@ -3,6 +3,9 @@
 #include "SatisfactoryModLoader.h"
 #include "Interfaces/IPluginManager.h"
 #include "Util/ImageLoadingUtil.h"
+#include "Async/Async.h"
+#include "Async/ParallelFor.h"
+#include "ImageUtils.h"
 #include "Json.h"
 
 //We only want to enforce plugin dependency versions outside of the editor
@@ -329,9 +332,10 @@ UModIconStorage::UModIconStorage() {
 
 UTexture2D* UModIconStorage::FindOrLoadModIcon(const FString& PluginName, bool& bOutIsBlankTexture) {
     //Icon is already loaded and cached
-    if (LoadedModIcons.Contains(PluginName)) {
-        UTexture2D* LoadedIcon = LoadedModIcons.FindChecked(PluginName);
-        bOutIsBlankTexture = LoadedIcon == BlankTexture;
+    UTexture2D* const* LoadedIcon = LoadedModIcons.Find(PluginName);
+    if (LoadedIcon != NULL) {
+        bOutIsBlankTexture = *LoadedIcon == BlankTexture;
+        return *LoadedIcon;
     }
 
     UTexture2D* ActuallyLoadedTexture = LoadModIcon(PluginName);
@@ -344,16 +348,152 @@ UTexture2D* UModIconStorage::FindOrLoadModIcon(const FString& PluginName, bool&
     return ActuallyLoadedTexture;
 }
 
-UTexture2D* UModIconStorage::LoadModIcon(const FString& PluginName) {
+FString UModIconStorage::GetModIconFilePath(const FString& PluginName) {
     const TSharedPtr<IPlugin> Plugin = IPluginManager::Get().FindPlugin(PluginName);
 
     //Make sure plugin is valid, enabled and it's actually a mod
     if (!Plugin.IsValid() || !Plugin->IsEnabled() || !UModLoadingLibrary::IsPluginAMod(*Plugin)) {
-        return NULL;
+        return TEXT("");
     }
 
     //Plugins have a fixed icon path, which is PluginRoot/Resources/Icon128.png
-    const FString Icon128FilePath = Plugin->GetBaseDir() / TEXT("Resources/Icon128.png");
+    return Plugin->GetBaseDir() / TEXT("Resources/Icon128.png");
+}
+
+void UModIconStorage::RequestModIcon(const FString& PluginName, const FOnModIconLoaded& Callback) {
+    UTexture2D* const* LoadedIcon = LoadedModIcons.Find(PluginName);
+    if (LoadedIcon != NULL) {
+        Callback.ExecuteIfBound(*LoadedIcon, *LoadedIcon == BlankTexture);
+        return;
+    }
+
+    //Icon is already being loaded, just wait for it to finish
+    TArray<FOnModIconLoaded>* PendingCallbacks = PendingIconRequests.Find(PluginName);
+    if (PendingCallbacks != NULL) {
+        PendingCallbacks->Add(Callback);
+        return;
+    }
+    PendingIconRequests.Add(PluginName, {Callback});
+
+    //Plugin manager and module manager are not thread safe, so everything needed for decoding is resolved beforehand
+    const FString IconFilePath = GetModIconFilePath(PluginName);
+    FImageLoadingUtil::EnsureImageWrapperModuleLoaded();
+    
+    TWeakObjectPtr<UModIconStorage> WeakThis = this;
+    Async(EAsyncExecution::ThreadPool, [WeakThis, PluginName, IconFilePath]() {
+        const TSharedRef<FDecodedImage> DecodedImage = MakeShared<FDecodedImage>();
+        FString ErrorMessage = TEXT("Plugin is not a loaded mod");
+        const bool bDecodedSuccessfully = !IconFilePath.IsEmpty() && FImageLoadingUtil::DecodeImageFromFile(IconFilePath, *DecodedImage, ErrorMessage);
+
+        //Only the texture creation and upload has to happen on the game thread
+        AsyncTask(ENamedThreads::GameThread, [WeakThis, PluginName, DecodedImage, bDecodedSuccessfully, ErrorMessage]() {
+            if (UModIconStorage* IconStorage = WeakThis.Get()) {
+                IconStorage->OnModIconDecoded(PluginName, *DecodedImage, bDecodedSuccessfully, ErrorMessage);
+            }
+        });
+    });
+}
+
+void UModIconStorage::OnModIconDecoded(const FString& PluginName, const FDecodedImage& DecodedImage, const bool bDecodedSuccessfully, const FString& ErrorMessage) {
+    //Icon could have been loaded synchronously while we were decoding it, in which case we reuse the loaded texture
+    UTexture2D* IconTexture = LoadedModIcons.FindRef(PluginName);
+    FString TextureErrorMessage = ErrorMessage;
+    
+    if (IconTexture == NULL && bDecodedSuccessfully) {
+        IconTexture = FImageLoadingUtil::CreateTextureFromDecodedImage(DecodedImage, TextureErrorMessage);
+    }
+    if (IconTexture == NULL) {
+        UE_LOG(LogSatisfactoryModLoader, Error, TEXT("Failed to load icon for plugin %s: %s"), *PluginName, *TextureErrorMessage);
+        IconTexture = BlankTexture;
+    }
+    LoadedModIcons.Add(PluginName, IconTexture);
+    
+    TArray<FOnModIconLoaded> PendingCallbacks;
+    PendingIconRequests.RemoveAndCopyValue(PluginName, PendingCallbacks);
+    for (const FOnModIconLoaded& Callback : PendingCallbacks) {
+        Callback.ExecuteIfBound(IconTexture, IconTexture == BlankTexture);
+    }
+}
+
+void UModIconStorage::RequestModIconAtlas(const TArray<FString>& PluginNames, int32 IconSize, const FOnModIconAtlasBuilt& Callback) {
+    IconSize = FMath::Clamp(IconSize, 8, 512);
+    
+    TArray<FString> IconFilePaths;
+    for (const FString& PluginName : PluginNames) {
+        IconFilePaths.Add(GetModIconFilePath(PluginName));
+    }
+    FImageLoadingUtil::EnsureImageWrapperModuleLoaded();
+
+    Async(EAsyncExecution::ThreadPool, [PluginNames, IconFilePaths, IconSize, Callback]() {
+        //Decode and scale every icon independently first
+        TArray<TArray<FColor>> ScaledIcons;
+        ScaledIcons.SetNum(IconFilePaths.Num());
+        
+        ParallelFor(IconFilePaths.Num(), [&](const int32 Index) {
+            FDecodedImage DecodedImage;
+            FString ErrorMessage;
+            if (IconFilePaths[Index].IsEmpty() || !FImageLoadingUtil::DecodeImageFromFile(IconFilePaths[Index], DecodedImage, ErrorMessage)) {
+                return;
+            }
+            //BGRA pixels have exactly the same memory layout as FColor
+            TArray<FColor> SourcePixels;
+            SourcePixels.SetNumUninitialized(DecodedImage.Width * DecodedImage.Height);
+            FMemory::Memcpy(SourcePixels.GetData(), DecodedImage.BGRAData.GetData(), SourcePixels.Num() * sizeof(FColor));
+            FImageUtils::ImageResize(DecodedImage.Width, DecodedImage.Height, SourcePixels, IconSize, IconSize, ScaledIcons[Index], false);
+        });
+
+        TArray<int32> PackedIcons;
+        for (int32 i = 0; i < ScaledIcons.Num(); i++) {
+            if (ScaledIcons[i].Num() == IconSize * IconSize) {
+                PackedIcons.Add(i);
+            }
+        }
+        
+        //Icons are packed into a grid as close to the square as possible
+        const int32 Columns = FMath::Max(1, FMath::CeilToInt(FMath::Sqrt((float) PackedIcons.Num())));
+        const int32 Rows = FMath::Max(1, FMath::DivideAndRoundUp(PackedIcons.Num(), Columns));
+        
+        const TSharedRef<FDecodedImage> AtlasImage = MakeShared<FDecodedImage>();
+        AtlasImage->Width = Columns * IconSize;
+        AtlasImage->Height = Rows * IconSize;
+        AtlasImage->BGRAData.SetNumZeroed(AtlasImage->Width * AtlasImage->Height * sizeof(FColor));
+        TMap<FString, FBox2D> IconUVRegions;
+
+        for (int32 i = 0; i < PackedIcons.Num(); i++) {
+            const int32 OriginX = (i % Columns) * IconSize;
+            const int32 OriginY = (i / Columns) * IconSize;
+            const TArray<FColor>& IconPixels = ScaledIcons[PackedIcons[i]];
+            
+            for (int32 Y = 0; Y < IconSize; Y++) {
+                uint8* DestinationRow = AtlasImage->BGRAData.GetData() + ((OriginY + Y) * AtlasImage->Width + OriginX) * sizeof(FColor);
+                FMemory::Memcpy(DestinationRow, IconPixels.GetData() + Y * IconSize, IconSize * sizeof(FColor));
+            }
+            const FVector2D AtlasSize(AtlasImage->Width, AtlasImage->Height);
+            IconUVRegions.Add(PluginNames[PackedIcons[i]], FBox2D(FVector2D(OriginX, OriginY) / AtlasSize, FVector2D(OriginX + IconSize, OriginY + IconSize) / AtlasSize));
+        }
+
+        AsyncTask(ENamedThreads::GameThread, [AtlasImage, IconUVRegions, bHasIcons = PackedIcons.Num() != 0, Callback]() {
+            FModIconAtlas Atlas;
+            if (bHasIcons) {
+                FString ErrorMessage;
+                Atlas.Texture = FImageLoadingUtil::CreateTextureFromDecodedImage(*AtlasImage, ErrorMessage);
+                if (Atlas.Texture == NULL) {
+                    UE_LOG(LogSatisfactoryModLoader, Error, TEXT("Failed to create mod icon atlas texture: %s"), *ErrorMessage);
+                }
+            }
+            if (Atlas.Texture != NULL) {
+                Atlas.IconUVRegions = IconUVRegions;
+            }
+            Callback.ExecuteIfBound(Atlas);
+        });
+    });
+}
+
+UTexture2D* UModIconStorage::LoadModIcon(const FString& PluginName) {
+    const FString Icon128FilePath = GetModIconFilePath(PluginName);
+    if (Icon128FilePath.IsEmpty()) {
+        return NULL;
+    }
 
     FString OutErrorMessage;
     UTexture2D* LoadedModIcon = FImageLoadingUtil::LoadImageFromFile(*Icon128FilePath, OutErrorMessage);
@@ -374,3 +514,17 @@ UTexture2D* UModLoadingLibrary::LoadModIconTexture(const FString& ModReference,
     }
     return ModIconTexture;
 }
+
+void UModLoadingLibrary::LoadModIconTextureAsync(const FString& Name, UTexture2D* FallbackIcon, const FOnModIconTextureLoaded& OnLoaded) {
+    const TWeakObjectPtr<UTexture2D> WeakFallbackIcon = FallbackIcon;
+    ModIconStorage->RequestModIcon(Name, FOnModIconLoaded::CreateLambda([OnLoaded, WeakFallbackIcon](UTexture2D* IconTexture, const bool bIsBlankTexture) {
+        UTexture2D* FallbackIcon = WeakFallbackIcon.Get();
+        OnLoaded.ExecuteIfBound(bIsBlankTexture && FallbackIcon ? FallbackIcon : IconTexture);
+    }));
+}
+
+void UModLoadingLibrary::BuildModIconAtlasAsync(const TArray<FString>& Names, int32 IconSize, const FOnModIconAtlasBuiltDynamic& OnBuilt) {
+    ModIconStorage->RequestModIconAtlas(Names, IconSize, FOnModIconAtlasBuilt::CreateLambda([OnBuilt](const FModIconAtlas& Atlas) {
+        OnBuilt.ExecuteIfBound(Atlas);
+    }));
+}
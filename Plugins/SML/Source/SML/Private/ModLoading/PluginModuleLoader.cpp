@@ -3,7 +3,11 @@
 #include "FGGameMode.h"
 #include "IPlatformFilePak.h"
 #include "Util/BlueprintAssetHelperLibrary.h"
+#include "Util/TopologicalSort/TopologicalSort.h"
 #include "SatisfactoryModLoader.h"
+#include "Engine/AssetManager.h"
+#include "Engine/StreamableManager.h"
+#include "Interfaces/IPluginManager.h"
 
 //Switch to enable mod loading in editor. Currently it's disabled because we don't have proper FactoryGame editor build
 #ifndef ENABLE_MOD_LOADING_IN_EDITOR
@@ -31,44 +35,183 @@ static bool PluginModuleLoaderExec(UWorld* InWorld, const TCHAR* Cmd, FOutputDev
 	return false;
 }
 
+TMap<UClass*, TSharedPtr<FPluginModuleLoader::FRootModuleDiscovery>> FPluginModuleLoader::RootModuleDiscoveries;
+
 TArray<FDiscoveredModule> FPluginModuleLoader::FindRootModulesOfType(TSubclassOf<UModModule> ModuleType) {
-	TArray<FDiscoveredModule> ResultingModules;
+	const TSharedRef<FRootModuleDiscovery> Discovery = FindOrStartDiscovery(ModuleType);
 
-	//Retrieve all loaded classes parenting from module class and check them
-	TArray<UClass*> NativeModuleClasses;
-	UBlueprintAssetHelperLibrary::FindNativeClassesByType(ModuleType, NativeModuleClasses);
+	//Block until the batched load is finished, completion callback might be deferred by the streamable manager so complete it manually
+	if (!Discovery->bCompleted) {
+		Discovery->LoadHandle->WaitUntilComplete();
+		CompleteDiscovery(ModuleType, Discovery);
+	}
+	return Discovery->DiscoveredModules;
+}
+
+void FPluginModuleLoader::FindRootModulesOfTypeAsync(TSubclassOf<UModModule> ModuleType, const FOnRootModulesDiscovered& OnDiscovered) {
+	const TSharedRef<FRootModuleDiscovery> Discovery = FindOrStartDiscovery(ModuleType);
 	
-	//Retrieve assets with bRootModule tag set to true using asset registry
-	TArray<UClass*> BlueprintModuleClasses;
-	UBlueprintAssetHelperLibrary::FindBlueprintAssetsByTag(ModuleType, TEXT("bRootModule"), {TEXT("True")}, BlueprintModuleClasses);
+	if (Discovery->bCompleted) {
+		OnDiscovered.ExecuteIfBound(Discovery->DiscoveredModules);
+		return;
+	}
+	if (OnDiscovered.IsBound()) {
+		Discovery->PendingCallbacks.Add(OnDiscovered);
+	}
+}
 
-	TSet<UClass*> AllModuleClasses;
-	AllModuleClasses.Reserve(NativeModuleClasses.Num() + BlueprintModuleClasses.Num());
-	AllModuleClasses.Append(NativeModuleClasses);
-	AllModuleClasses.Append(BlueprintModuleClasses);
+TSharedRef<FPluginModuleLoader::FRootModuleDiscovery> FPluginModuleLoader::FindOrStartDiscovery(UClass* ModuleType) {
+	const TSharedPtr<FRootModuleDiscovery>* ExistingDiscovery = RootModuleDiscoveries.Find(ModuleType);
+	if (ExistingDiscovery != NULL) {
+		//Mod set cannot change within the session, but blueprints can be recompiled in the editor, so we need to discover them again
+		const bool bHasOutdatedModules = (*ExistingDiscovery)->DiscoveredModules.ContainsByPredicate([](const FDiscoveredModule& Module) {
+			return Module.ModuleClass->HasAnyClassFlags(CLASS_NewerVersionExists);
+		});
+		if (!bHasOutdatedModules) {
+			return ExistingDiscovery->ToSharedRef();
+		}
+	}
+	const TSharedRef<FRootModuleDiscovery> Discovery = MakeShared<FRootModuleDiscovery>();
+	RootModuleDiscoveries.Add(ModuleType, Discovery);
+
+	//Retrieve all loaded classes parenting from module class, they do not need any loading
+	UBlueprintAssetHelperLibrary::FindNativeClassesByType(ModuleType, Discovery->NativeModuleClasses);
 	
-	//Iterate found classes and perform additional checking
-	for (UClass* RootModuleClass : AllModuleClasses) {
-		if (!RootModuleClass->HasAnyClassFlags(CLASS_Abstract | CLASS_NewerVersionExists | CLASS_Deprecated)) {
-			UModModule* ModModuleCDO = CastChecked<UModModule>(RootModuleClass->GetDefaultObject());
+	//Retrieve paths of the assets with bRootModule tag set to true using asset registry, without loading them yet
+	UBlueprintAssetHelperLibrary::FindBlueprintAssetClassPathsByTag(TEXT("bRootModule"), {TEXT("True")}, Discovery->BlueprintModuleClassPaths);
+
+	//Request all of the blueprint modules in a single batch, so their packages are loaded together instead of one by one
+	if (Discovery->BlueprintModuleClassPaths.Num()) {
+		const FString DebugName = FString::Printf(TEXT("RootModules_%s"), *ModuleType->GetName());
+		const TWeakPtr<FRootModuleDiscovery> WeakDiscovery = Discovery;
 		
-			//Make sure it is a root module after all, because FindNativeClassesByType doesn't check for this
-			if (ModModuleCDO->bRootModule) {
-				//Retrieve owning plugin name for the provided class
-				const FString OwnerPluginName = UBlueprintAssetHelperLibrary::FindPluginNameByObjectPath(RootModuleClass->GetPathName());
-
-				//Make sure valid owner has been found
-				if (OwnerPluginName.IsEmpty()) {
-					UE_LOG(LogSatisfactoryModLoader, Error, TEXT("Failed to determine owning plugin for root module %s"), *RootModuleClass->GetPathName());
-					continue;
+		Discovery->LoadHandle = UAssetManager::GetStreamableManager().RequestAsyncLoad(
+			TArray<FSoftObjectPath>(Discovery->BlueprintModuleClassPaths), FStreamableDelegate::CreateLambda([ModuleType, WeakDiscovery]() {
+				const TSharedPtr<FRootModuleDiscovery> PinnedDiscovery = WeakDiscovery.Pin();
+				if (PinnedDiscovery.IsValid()) {
+					CompleteDiscovery(ModuleType, PinnedDiscovery.ToSharedRef());
 				}
+			}), FStreamableManager::AsyncLoadHighPriority, false, false, DebugName);
+	}
+	//Nothing to load, or all of the classes have already been loaded
+	if (!Discovery->LoadHandle.IsValid() || Discovery->LoadHandle->HasLoadCompleted()) {
+		CompleteDiscovery(ModuleType, Discovery);
+	}
+	return Discovery;
+}
 
-				//Add module into the collection
-				ResultingModules.Add(FDiscoveredModule{OwnerPluginName, RootModuleClass});
+void FPluginModuleLoader::CompleteDiscovery(UClass* ModuleType, const TSharedRef<FRootModuleDiscovery>& Discovery) {
+	if (Discovery->bCompleted) {
+		return;
+	}
+	TSet<UClass*> AllModuleClasses;
+	AllModuleClasses.Reserve(Discovery->NativeModuleClasses.Num() + Discovery->BlueprintModuleClassPaths.Num());
+	AllModuleClasses.Append(Discovery->NativeModuleClasses);
+	
+	for (const FSoftClassPath& ClassPath : Discovery->BlueprintModuleClassPaths) {
+		//Class is either loaded by the batched request already, or failed to load, so it is enough to just resolve it
+		UClass* BlueprintModuleClass = ClassPath.ResolveClass();
+		if (BlueprintModuleClass != NULL) {
+			AllModuleClasses.Add(BlueprintModuleClass);
+		}
+	}
+
+	TArray<FDiscoveredModule> ResultingModules;
+	for (UClass* RootModuleClass : AllModuleClasses) {
+		if (!IsValidRootModuleClass(RootModuleClass, ModuleType)) {
+			continue;
+		}
+		//Retrieve owning plugin name for the provided class
+		const FString OwnerPluginName = UBlueprintAssetHelperLibrary::FindPluginNameByObjectPath(RootModuleClass->GetPathName());
+
+		//Make sure valid owner has been found
+		if (OwnerPluginName.IsEmpty()) {
+			UE_LOG(LogSatisfactoryModLoader, Error, TEXT("Failed to determine owning plugin for root module %s"), *RootModuleClass->GetPathName());
+			continue;
+		}
+		ResultingModules.Add(FDiscoveredModule{OwnerPluginName, RootModuleClass});
+	}
+	
+	SortModulesByPluginDependencies(ResultingModules);
+	Discovery->DiscoveredModules = ResultingModules;
+	Discovery->bCompleted = true;
+	
+	//Callbacks can start new discoveries, so move them out before firing them
+	const TArray<FOnRootModulesDiscovered> PendingCallbacks = MoveTemp(Discovery->PendingCallbacks);
+	for (const FOnRootModulesDiscovered& Callback : PendingCallbacks) {
+		Callback.ExecuteIfBound(Discovery->DiscoveredModules);
+	}
+}
+
+bool FPluginModuleLoader::IsValidRootModuleClass(UClass* RootModuleClass, UClass* ModuleType) {
+	//Asset registry tag lookup does not know about the class hierarchy, so make sure it is a module of the requested type
+	if (!RootModuleClass->IsChildOf(ModuleType)) {
+		return false;
+	}
+	if (RootModuleClass->HasAnyClassFlags(CLASS_Abstract | CLASS_NewerVersionExists | CLASS_Deprecated)) {
+		return false;
+	}
+	
+	//Make sure it is a root module after all, because FindNativeClassesByType doesn't check for this
+	UModModule* ModModuleCDO = CastChecked<UModModule>(RootModuleClass->GetDefaultObject());
+	return ModModuleCDO->bRootModule;
+}
+
+void FPluginModuleLoader::SortModulesByPluginDependencies(TArray<FDiscoveredModule>& Modules) {
+	//Sort by plugin name first so order of the independent modules does not depend on the asset registry
+	Modules.StableSort([](const FDiscoveredModule& A, const FDiscoveredModule& B) {
+		return A.OwnerPluginName < B.OwnerPluginName;
+	});
+	
+	TArray<FString> OwnerPluginNames;
+	for (const FDiscoveredModule& Module : Modules) {
+		OwnerPluginNames.Add(Module.OwnerPluginName);
+	}
+	TDirectedGraph<FString> DependencyGraph;
+	AddPluginDependencyClosure(OwnerPluginNames, DependencyGraph);
+
+	TArray<FString> SortedPlugins;
+	TSet<FString> CyclePlugins;
+	if (!FTopologicalSort::TopologicalSort(DependencyGraph, SortedPlugins, &CyclePlugins)) {
+		UE_LOG(LogSatisfactoryModLoader, Warning, TEXT("Found cycle in plugin dependencies between %s, their root modules will be ordered by name"),
+			*FString::Join(CyclePlugins.Array(), TEXT(", ")));
+		return;
+	}
+	
+	//Sorted list contains the whole dependency closure, only the plugins owning discovered modules are looked up in it
+	TMap<FString, int32> PluginOrder;
+	for (int32 i = 0; i < SortedPlugins.Num(); i++) {
+		PluginOrder.Add(SortedPlugins[i], i);
+	}
+	Modules.StableSort([&](const FDiscoveredModule& A, const FDiscoveredModule& B) {
+		return PluginOrder.FindChecked(A.OwnerPluginName) < PluginOrder.FindChecked(B.OwnerPluginName);
+	});
+}
+
+void FPluginModuleLoader::AddPluginDependencyClosure(const TArray<FString>& PluginNames, TDirectedGraph<FString>& DependencyGraph) {
+	TArray<TSharedRef<IPlugin>> PendingPlugins;
+	IPluginManager& PluginManager = IPluginManager::Get();
+	for (const FString& PluginName : PluginNames) {
+		const TSharedPtr<IPlugin> Plugin = PluginManager.FindPlugin(PluginName);
+		if (DependencyGraph.AddNode(PluginName) && Plugin.IsValid()) {
+			PendingPlugins.Add(Plugin.ToSharedRef());
+		}
+	}
+
+	//Dependencies are walked breadth first, every plugin is only expanded once when it's node is added
+	for (int32 i = 0; i < PendingPlugins.Num(); i++) {
+		const TSharedRef<IPlugin> Plugin = PendingPlugins[i];
+		for (const FPluginReferenceDescriptor& Dependency : Plugin->GetDescriptor().Plugins) {
+			const TSharedPtr<IPlugin> DependencyPlugin = PluginManager.FindPlugin(Dependency.Name);
+			if (!DependencyPlugin.IsValid()) {
+				continue;
+			}
+			if (DependencyGraph.AddNode(Dependency.Name)) {
+				PendingPlugins.Add(DependencyPlugin.ToSharedRef());
 			}
+			DependencyGraph.AddEdge(Dependency.Name, Plugin->GetName());
 		}
 	}
-	return ResultingModules;
 }
 
 bool FPluginModuleLoader::ShouldLoadModulesForWorld(UWorld* World) {
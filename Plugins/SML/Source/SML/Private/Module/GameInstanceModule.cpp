@@ -48,25 +48,32 @@ void UGameInstanceModule::RegisterDefaultContent() {
         ItemTooltipSubsystem->RegisterGlobalTooltipProvider(OwnerModReferenceString, GlobalTooltipProvider->GetDefaultObject());
     }
     
-    //Key Bindings and Axis Bindings
+    //Key Bindings and Axis Bindings, registered in one batch so keymaps are only rebuilt once
+    TArray<FModKeyBindRegistration> KeyBinds;
+    KeyBinds.Reserve(ModKeyBindings.Num());
     for (const FModKeyBindingInfo& KeyBindingInfo : ModKeyBindings) {
         //Because action binding editor UI is stupid and you cannot set action name directly apparently...
-        FInputActionKeyMapping FixedKeyMapping = KeyBindingInfo.KeyMapping;
-        FixedKeyMapping.ActionName = KeyBindingInfo.ActionName;
-        
-        //Register fixed key mapping with proper action name now
-        UModKeyBindRegistry::RegisterModKeyBind(OwnerModReferenceString, FixedKeyMapping, KeyBindingInfo.DisplayName);
+        FModKeyBindRegistration& KeyBind = KeyBinds.AddDefaulted_GetRef();
+        KeyBind.KeyMapping = KeyBindingInfo.KeyMapping;
+        KeyBind.KeyMapping.ActionName = KeyBindingInfo.ActionName;
+        KeyBind.DisplayName = KeyBindingInfo.DisplayName;
     }
     
+    TArray<FModAxisBindRegistration> AxisBinds;
+    AxisBinds.Reserve(ModAxisBindings.Num());
     for (const FModAxisBindingInfo& AxisBindingInfo : ModAxisBindings) {
         //Same problem as with action binding editor - see comment above
-        FInputAxisKeyMapping FixedPositiveAxisMapping = AxisBindingInfo.PositiveAxisMapping;
-        FInputAxisKeyMapping FixedNegativeAxisMapping = AxisBindingInfo.NegativeAxisMapping;
-        
-        FixedPositiveAxisMapping.AxisName = AxisBindingInfo.AxisName;
-        FixedNegativeAxisMapping.AxisName = AxisBindingInfo.AxisName;
-        
-        //Register fixed axis mapping with proper action names now
-        UModKeyBindRegistry::RegisterModAxisBind(OwnerModReferenceString, FixedPositiveAxisMapping, FixedNegativeAxisMapping, AxisBindingInfo.PositiveAxisDisplayName, AxisBindingInfo.NegativeAxisDisplayName);
+        FModAxisBindRegistration& AxisBind = AxisBinds.AddDefaulted_GetRef();
+        AxisBind.PositiveAxisMapping = AxisBindingInfo.PositiveAxisMapping;
+        AxisBind.NegativeAxisMapping = AxisBindingInfo.NegativeAxisMapping;
+        AxisBind.PositiveAxisMapping.AxisName = AxisBindingInfo.AxisName;
+        AxisBind.NegativeAxisMapping.AxisName = AxisBindingInfo.AxisName;
+        AxisBind.PositiveDisplayName = AxisBindingInfo.PositiveAxisDisplayName;
+        AxisBind.NegativeDisplayName = AxisBindingInfo.NegativeAxisDisplayName;
+    }
+    
+    //Register fixed key and axis mappings with proper action names now
+    if (KeyBinds.Num() || AxisBinds.Num()) {
+        UModKeyBindRegistry::RegisterModKeyBinds(OwnerModReferenceString, KeyBinds, AxisBinds);
     }
 }
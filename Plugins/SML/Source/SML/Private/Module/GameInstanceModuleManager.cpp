@@ -1,8 +1,12 @@
 #include "Module/GameInstanceModuleManager.h"
 #include "SatisfactoryModLoader.h"
 #include "ModLoading/PluginModuleLoader.h"
+#include "Module/GameWorldModule.h"
+#include "Module/MenuWorldModule.h"
+#include "Registry/ModKeyBindRegistry.h"
 #include "Registry/RemoteCallObjectRegistry.h"
 #include "Tooltip/ItemTooltipSubsystem.h"
+#include "Util/PhaseTimeline.h"
 
 UGameInstanceModuleManager::UGameInstanceModuleManager() {
     this->bIsInitializingCurrently = false;
@@ -18,12 +22,17 @@ UGameInstanceModule* UGameInstanceModuleManager::FindModule(const FName& ModRefe
 }
 
 void UGameInstanceModuleManager::Initialize(FSubsystemCollectionBase& Collection) {
+    FPhaseTimelineScope TimelineScope(TEXT("GameInstanceModule"), TEXT("Initialize"));
 	this->bIsInitializingCurrently = true;
     this->CurrentSubsystemCollection = &Collection;
     EnsureSMLSubsystemsInitialized();
     
     //Discover modules by scanning classpath
-    const TArray<FDiscoveredModule> DiscoveredModules = FPluginModuleLoader::FindRootModulesOfType(UGameInstanceModule::StaticClass());
+    TArray<FDiscoveredModule> DiscoveredModules;
+    {
+        FPhaseTimelineScope DiscoveryTimelineScope(TEXT("GameInstanceModule"), TEXT("DiscoverRootModules"));
+        DiscoveredModules = FPluginModuleLoader::FindRootModulesOfType(UGameInstanceModule::StaticClass());
+    }
 
     TMap<FString, FString> AlreadyLoadedMods;
     for (const FDiscoveredModule& Module : DiscoveredModules) {
@@ -44,11 +53,21 @@ void UGameInstanceModuleManager::Initialize(FSubsystemCollectionBase& Collection
     }
 
     UE_LOG(LogSatisfactoryModLoader, Log, TEXT("Discovered %d game instance modules"), AlreadyLoadedMods.Num());
+    LifecycleDispatchWaves = FLifecycleDispatchWaves::Build(RootModuleList);
     
     //Dispatch lifecycle events in a sequence
-    DispatchLifecycleEvent(ELifecyclePhase::CONSTRUCTION);
-    DispatchLifecycleEvent(ELifecyclePhase::INITIALIZATION);
-    DispatchLifecycleEvent(ELifecyclePhase::POST_INITIALIZATION);
+    {
+        //Key bindings of all modules are registered as a single batch, so keymaps are only rebuilt once
+        FScopedModKeyBindBatch KeyBindBatchScope;
+        DispatchLifecycleEvent(ELifecyclePhase::CONSTRUCTION);
+        DispatchLifecycleEvent(ELifecyclePhase::INITIALIZATION);
+        DispatchLifecycleEvent(ELifecyclePhase::POST_INITIALIZATION);
+    }
+
+    //Start loading world modules in the background, so they are ready by the time first world is initialized
+    //Discovery results are cached, so later world loads will not need to discover and load them again
+    FPluginModuleLoader::FindRootModulesOfTypeAsync(UMenuWorldModule::StaticClass());
+    FPluginModuleLoader::FindRootModulesOfTypeAsync(UGameWorldModule::StaticClass());
     
     this->bIsInitializingCurrently = false;
     this->CurrentSubsystemCollection = NULL;
@@ -72,6 +91,8 @@ void UGameInstanceModuleManager::EnsureSubsystemInitialized(const TSubclassOf<UG
 }
 
 void UGameInstanceModuleManager::CreateRootModule(const FName& ModReference, TSubclassOf<UGameInstanceModule> ObjectClass) {
+    FPhaseTimelineScope TimelineScope(TEXT("GameInstanceModule"), TEXT("CreateRootModule"), ModReference);
+    
     //Allocate module object and set mod reference
     UGameInstanceModule* RootGameInstanceModule = NewObject<UGameInstanceModule>(this, ObjectClass, ModReference);
     check(RootGameInstanceModule);
@@ -87,8 +108,6 @@ void UGameInstanceModuleManager::DispatchLifecycleEvent(ELifecyclePhase Phase) {
     UE_LOG(LogSatisfactoryModLoader, Log, TEXT("Dispatching lifecycle event %s to game instance modules"),
         *UModModule::LifecyclePhaseToString(Phase));
 
-    //Iterate modules in their order of registration and dispatch lifecycle event to them
-    for (UGameInstanceModule* RootModule : RootModuleList) {
-        RootModule->DispatchLifecycleEvent(Phase);
-    }
+    //Dispatch event to the modules wave by wave, so modules of the dependencies always receive it first
+    LifecycleDispatchWaves.Dispatch(Phase, TEXT("GameInstanceModule"));
 }
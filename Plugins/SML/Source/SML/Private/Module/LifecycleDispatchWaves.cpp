@@ -0,0 +1,86 @@
+#include "Module/LifecycleDispatchWaves.h"
+#include "Async/ParallelFor.h"
+#include "HAL/IConsoleManager.h"
+#include "ModLoading/PluginModuleLoader.h"
+#include "SatisfactoryModLoader.h"
+#include "Util/PhaseTimeline.h"
+#include "Util/TopologicalSort/TopologicalSort.h"
+
+static TAutoConsoleVariable<int32> CVarConcurrentLifecyclePreparation(
+    TEXT("SML.Modules.ConcurrentLifecyclePreparation"),
+    1,
+    TEXT("When non-zero, thread safe lifecycle preparation of the independent root modules runs concurrently on the worker threads"),
+    ECVF_Default);
+
+FLifecycleDispatchWaves FLifecycleDispatchWaves::BuildInternal(const TArray<UModModule*>& RootModules) {
+    FLifecycleDispatchWaves Result;
+    
+    //Graph covers the whole dependency closure, so plugins without root modules of this type still order the mods depending on them
+    TArray<FString> ModReferences;
+    for (UModModule* RootModule : RootModules) {
+        ModReferences.Add(RootModule->GetOwnerModReference().ToString());
+    }
+    TDirectedGraph<FString> DependencyGraph;
+    FPluginModuleLoader::AddPluginDependencyClosure(ModReferences, DependencyGraph);
+
+    //Every mod goes into the level right after the latest level of it's dependencies, so mods of the same level are independent
+    TArray<TArray<FString>> ModLevels;
+    TArray<TArray<FString>> CyclePaths;
+    if (!FTopologicalSort::TopologicalSortLevels(DependencyGraph, ModLevels, &CyclePaths)) {
+        for (TArray<FString>& CyclePath : CyclePaths) {
+            CyclePath.Add(CyclePath[0]);
+            UE_LOG(LogSatisfactoryModLoader, Warning, TEXT("Found cycle in mod dependencies: %s"), *FString::Join(CyclePath, TEXT(" -> ")));
+        }
+        UE_LOG(LogSatisfactoryModLoader, Warning, TEXT("Lifecycle events will be dispatched to modules one by one because of dependency cycles"));
+        
+        for (UModModule* RootModule : RootModules) {
+            Result.Waves.Add({RootModule});
+        }
+        return Result;
+    }
+
+    TMap<FString, int32> ModWaves;
+    for (int32 Level = 0; Level < ModLevels.Num(); Level++) {
+        for (const FString& ModReference : ModLevels[Level]) {
+            ModWaves.Add(ModReference, Level);
+        }
+    }
+
+    Result.Waves.SetNum(ModLevels.Num());
+    for (int32 i = 0; i < RootModules.Num(); i++) {
+        Result.Waves[ModWaves.FindChecked(ModReferences[i])].Add(RootModules[i]);
+    }
+    //Levels made only of plugins without root modules of this type are left empty
+    Result.Waves.RemoveAll([](const TArray<UModModule*>& Wave) { return Wave.Num() == 0; });
+    return Result;
+}
+
+void FLifecycleDispatchWaves::Dispatch(ELifecyclePhase Phase, const TCHAR* TimelineCategory) const {
+    const TCHAR* PhaseName = UModModule::GetLifecyclePhaseName(Phase);
+    const bool bAllowConcurrentPreparation = CVarConcurrentLifecyclePreparation.GetValueOnGameThread() != 0;
+    
+    for (const TArray<UModModule*>& Wave : Waves) {
+        TArray<UModModule*> ConcurrentModules;
+        
+        for (UModModule* RootModule : Wave) {
+            if (bAllowConcurrentPreparation && RootModule->IsLifecyclePhaseThreadSafe(Phase)) {
+                ConcurrentModules.Add(RootModule);
+                continue;
+            }
+            FPhaseTimelineScope TimelineScope(TimelineCategory, TEXT("PrepareLifecyclePhase"), RootModule->GetOwnerModReference());
+            RootModule->PrepareLifecyclePhase(Phase);
+        }
+
+        //Modules inside of the wave do not depend on each other, so their thread safe preparation can overlap
+        ParallelFor(ConcurrentModules.Num(), [&](const int32 Index) {
+            FPhaseTimelineScope TimelineScope(TimelineCategory, TEXT("PrepareLifecyclePhase"), ConcurrentModules[Index]->GetOwnerModReference());
+            ConcurrentModules[Index]->PrepareLifecyclePhase(Phase);
+        });
+
+        //Lifecycle events themselves can run blueprint code, so they are always dispatched on the game thread
+        for (UModModule* RootModule : Wave) {
+            FPhaseTimelineScope TimelineScope(TimelineCategory, PhaseName, RootModule->GetOwnerModReference());
+            RootModule->DispatchLifecycleEvent(Phase);
+        }
+    }
+}
@@ -46,3 +46,12 @@ FString UModModule::LifecyclePhaseToString(ELifecyclePhase Phase) {
     UEnum* LifecyclePhase = StaticEnum<ELifecyclePhase>();
     return LifecyclePhase->GetNameStringByValue((int64) Phase);
 }
+
+const TCHAR* UModModule::GetLifecyclePhaseName(ELifecyclePhase Phase) {
+    switch (Phase) {
+        case ELifecyclePhase::CONSTRUCTION: return TEXT("CONSTRUCTION");
+        case ELifecyclePhase::INITIALIZATION: return TEXT("INITIALIZATION");
+        case ELifecyclePhase::POST_INITIALIZATION: return TEXT("POST_INITIALIZATION");
+        default: return TEXT("UNKNOWN");
+    }
+}
@@ -10,6 +10,7 @@
 #include "Module/MenuWorldModule.h"
 #include "Registry/ModContentRegistry.h"
 #include "Subsystem/SubsystemActorManager.h"
+#include "Util/PhaseTimeline.h"
 
 UWorldModule* UWorldModuleManager::FindModule(const FName& ModReference) const {
     UWorldModule* const* WorldModule = RootModuleMap.Find(ModReference);
@@ -66,6 +67,8 @@ void UWorldModuleManager::NotifyContentRegistry() {
 }
 
 void UWorldModuleManager::ConstructModules() {
+    FPhaseTimelineScope TimelineScope(TEXT("WorldModule"), TEXT("ConstructModules"));
+    
     //Use game world module by default
     TSubclassOf<UWorldModule> ModuleTypeClass = UGameWorldModule::StaticClass();
 
@@ -75,7 +78,11 @@ void UWorldModuleManager::ConstructModules() {
     }
 
     //Discover modules of the relevant types
-    const TArray<FDiscoveredModule> DiscoveredModules = FPluginModuleLoader::FindRootModulesOfType(ModuleTypeClass);
+    TArray<FDiscoveredModule> DiscoveredModules;
+    {
+        FPhaseTimelineScope DiscoveryTimelineScope(TEXT("WorldModule"), TEXT("DiscoverRootModules"));
+        DiscoveredModules = FPluginModuleLoader::FindRootModulesOfType(ModuleTypeClass);
+    }
 
     TMap<FString, FString> AlreadyLoadedMods;
     for (const FDiscoveredModule& Module : DiscoveredModules) {
@@ -96,12 +103,15 @@ void UWorldModuleManager::ConstructModules() {
     }
     
     UE_LOG(LogSatisfactoryModLoader, Log, TEXT("Discovered %d world modules of class %s"), AlreadyLoadedMods.Num(), *ModuleTypeClass->GetName());
+    LifecycleDispatchWaves = FLifecycleDispatchWaves::Build(RootModuleList);
     
     //Dispatch construction lifecycle event
     DispatchLifecycleEvent(ELifecyclePhase::CONSTRUCTION);
 }
 
 void UWorldModuleManager::CreateRootModule(const FName& ModReference, TSubclassOf<UWorldModule> ObjectClass) {
+    FPhaseTimelineScope TimelineScope(TEXT("WorldModule"), TEXT("CreateRootModule"), ModReference);
+    
     //Allocate module object and set mod reference
     UWorldModule* RootWorldModule = NewObject<UWorldModule>(this, ObjectClass, ModReference);
     check(RootWorldModule);
@@ -117,10 +127,8 @@ void UWorldModuleManager::DispatchLifecycleEvent(ELifecyclePhase Phase) {
     UE_LOG(LogSatisfactoryModLoader, Log, TEXT("Dispatching lifecycle event %s to world %s modules"), 
         *UModModule::LifecyclePhaseToString(Phase), *GetWorld()->GetMapName());
     
-    //Iterate modules in their order of registration and dispatch lifecycle event to them
-    for (UWorldModule* RootModule : RootModuleList) {
-        RootModule->DispatchLifecycleEvent(Phase);
-    }
+    //Dispatch event to the modules wave by wave, so modules of the dependencies always receive it first
+    LifecycleDispatchWaves.Dispatch(Phase, TEXT("WorldModule"));
 }
 
 void FWaitForGameStateLatentAction::UpdateOperation(FLatentResponse& Response) {
@@ -0,0 +1,15 @@
+#include "Network/ConnectionMetadataSlot.h"
+
+/** Counter is function local so slots declared in other translation units can be registered during static initialization */
+static int32& GetSlotCounter() {
+    static int32 NumSlots = 0;
+    return NumSlots;
+}
+
+int32 FConnectionMetadataSlotRegistry::AllocateSlotIndex() {
+    return GetSlotCounter()++;
+}
+
+int32 FConnectionMetadataSlotRegistry::GetNumSlots() {
+    return GetSlotCounter();
+}
@@ -5,20 +5,102 @@
 #include "Patching/NativeHookManager.h"
 #include "Engine/Engine.h"
 #include "Engine/NetConnection.h"
+#include "Engine/Channel.h"
 #include "Util/ObjectMetadata.h"
+#include "Containers/Ticker.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Compression.h"
 
 DEFINE_LOG_CATEGORY(LogModNetworkHandler);
 DEFINE_CONTROL_CHANNEL_MESSAGE_THREEPARAM(ModMessage, 40, FString, int32, FString);
 IMPLEMENT_CONTROL_CHANNEL_MESSAGE(ModMessage);
+DEFINE_CONTROL_CHANNEL_MESSAGE_TWOPARAM(ModChannelMessage, 41, uint16, FString);
+IMPLEMENT_CONTROL_CHANNEL_MESSAGE(ModChannelMessage);
+DEFINE_CONTROL_CHANNEL_MESSAGE_FOURPARAM(ModLargeMessageBegin, 42, uint16, uint32, int32, int32);
+IMPLEMENT_CONTROL_CHANNEL_MESSAGE(ModLargeMessageBegin);
+DEFINE_CONTROL_CHANNEL_MESSAGE_TWOPARAM(ModLargeMessageChunk, 43, uint32, TArray<uint8>);
+IMPLEMENT_CONTROL_CHANNEL_MESSAGE(ModLargeMessageChunk);
+
+static TAutoConsoleVariable<int32> CVarLargeMessageChunkSize(
+    TEXT("SML.Network.LargeMessageChunkSize"),
+    8 * 1024,
+    TEXT("Size of the single chunk of the large mod message in bytes, clamped between 256 bytes and 32 KB"));
+
+static TAutoConsoleVariable<int32> CVarLargeMessageBytesPerSecond(
+    TEXT("SML.Network.LargeMessageBytesPerSecond"),
+    256 * 1024,
+    TEXT("Maximum amount of large mod message bytes sent to a single connection per second"));
+
+static TAutoConsoleVariable<int32> CVarMaxLargeMessageSize(
+    TEXT("SML.Network.MaxLargeMessageSize"),
+    64 * 1024 * 1024,
+    TEXT("Maximum uncompressed size of the large mod message accepted from the remote side, in bytes"));
+
+static TAutoConsoleVariable<float> CVarLargeMessageReceiveTimeout(
+    TEXT("SML.Network.LargeMessageReceiveTimeout"),
+    30.0f,
+    TEXT("Time in seconds after which large mod message that stopped receiving chunks is dropped"));
+
+/** Well behaved remote side only sends one large message at a time, so more concurrent transfers are never needed */
+static constexpr int32 MaxConcurrentIncomingLargeMessages = 4;
+
+static TConnectionMetadataSlot<FModChannelConnectionState> ChannelStateSlot;
+static TConnectionMetadataSlot<FLargeMessageConnectionState> LargeMessageStateSlot;
+
+static bool CanHandleMessageOnConnection(UNetConnection* Connection, const FMessageEntry& MessageEntry) {
+    const bool bIsClientSide = Connection->ClientLoginState == EClientLoginState::Invalid;
+    return (bIsClientSide && MessageEntry.bClientHandled) || (!bIsClientSide && MessageEntry.bServerHandled);
+}
+
+void UModNetworkHandler::Initialize(FSubsystemCollectionBase& Collection) {
+    Super::Initialize(Collection);
+    MessageTypeChannelTable = FMessageType{TEXT("SML"), 0};
+    
+    FMessageEntry& MessageEntry = RegisterMessageType(MessageTypeChannelTable);
+    MessageEntry.bClientHandled = true;
+    MessageEntry.bServerHandled = true;
+    MessageEntry.MessageReceived.BindUObject(this, &UModNetworkHandler::ReceiveChannelTable);
+    
+    LargeMessageTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateUObject(this, &UModNetworkHandler::TickLargeMessages));
+
+    //Same as the rest of the subsystem patches, hooks are only installed in shipping because FG code is not available in the editor
+    if (FPlatformProperties::RequiresCookedData()) {
+        InitializePatches();
+    }
+}
+
+void UModNetworkHandler::Deinitialize() {
+    FTicker::GetCoreTicker().RemoveTicker(LargeMessageTickerHandle);
+    if (FPlatformProperties::RequiresCookedData()) {
+        RemovePatches();
+    }
+    Super::Deinitialize();
+}
 
 FMessageEntry& UModNetworkHandler::RegisterMessageType(const FMessageType& MessageType) {
     UE_LOG(LogModNetworkHandler, Display, TEXT("Registering message type %s:%d"), *MessageType.ModReference, MessageType.MessageId);
-    TMap<int32, FMessageEntry>& ModEntries = MessageHandlers.FindOrAdd(MessageType.ModReference);
-    if (ModEntries.Contains(MessageType.MessageId)) {
+    TMap<int32, int32>& ModChannelIds = ChannelIdsByMessageType.FindOrAdd(MessageType.ModReference);
+    if (ModChannelIds.Contains(MessageType.MessageId)) {
         UE_LOG(LogModNetworkHandler, Fatal, TEXT("Tried to register mod message with duplicate identifier %d for mod %s"), MessageType.MessageId, *MessageType.ModReference);
         check(0);
     }
-    return ModEntries.Add(MessageType.MessageId, FMessageEntry{});
+    checkf(MessageChannels.Num() <= MAX_uint16, TEXT("Too many mod message types registered, channel ids are limited to %d"), MAX_uint16);
+    
+    const int32 ChannelId = MessageChannels.Add(new FMessageEntry{});
+    ModChannelIds.Add(MessageType.MessageId, ChannelId);
+    MessageType.CachedChannelId = ChannelId;
+    return MessageChannels[ChannelId];
+}
+
+int32 UModNetworkHandler::FindChannelId(const FMessageType& MessageType) const {
+    if (MessageType.CachedChannelId == INDEX_NONE) {
+        const TMap<int32, int32>* ModChannelIds = ChannelIdsByMessageType.Find(MessageType.ModReference);
+        const int32* ChannelId = ModChannelIds != nullptr ? ModChannelIds->Find(MessageType.MessageId) : nullptr;
+        if (ChannelId != nullptr) {
+            MessageType.CachedChannelId = *ChannelId;
+        }
+    }
+    return MessageType.CachedChannelId;
 }
 
 void UModNetworkHandler::CloseWithFailureMessage(UNetConnection* Connection, const FString& Message) {
@@ -27,25 +109,253 @@ void UModNetworkHandler::CloseWithFailureMessage(UNetConnection* Connection, con
     Connection->FlushNet(true);
 }
 
-void UModNetworkHandler::SendMessage(UNetConnection* Connection, FMessageType MessageType, FString Data) {
-    FNetControlMessage<NMT_ModMessage>::Send(Connection, MessageType.ModReference, MessageType.MessageId, Data);
+void UModNetworkHandler::SendMessage(UNetConnection* Connection, const FMessageType& MessageType, FString Data) {
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    const int32 ChannelId = NetworkHandler->FindChannelId(MessageType);
+    const FModChannelConnectionState* ChannelState = NetworkHandler->FindConnectionMetadata(Connection, ChannelStateSlot);
+    
+    if (ChannelId != INDEX_NONE && ChannelState != nullptr && ChannelState->CanSendOnChannel(ChannelId)) {
+        uint16 CompactChannelId = (uint16) ChannelId;
+        FNetControlMessage<NMT_ModChannelMessage>::Send(Connection, CompactChannelId, Data);
+    } else {
+        FString ModReference = MessageType.ModReference;
+        int32 MessageId = MessageType.MessageId;
+        FNetControlMessage<NMT_ModMessage>::Send(Connection, ModReference, MessageId, Data);
+    }
     Connection->FlushNet(true);
 }
 
 void UModNetworkHandler::ReceiveMessage(UNetConnection* Connection, const FString& ModId, int32 MessageId, const FString& Content) const {
-    const TMap<int32, FMessageEntry>* Result = MessageHandlers.Find(ModId);
-    if (Result != nullptr) {
-        const FMessageEntry* MessageEntry = Result->Find(MessageId);
-        if (MessageEntry != nullptr) {
-            const bool bIsClientSide = Connection->ClientLoginState == EClientLoginState::Invalid;
-            const bool bCanBeHandled = (bIsClientSide && MessageEntry->bClientHandled) || (!bIsClientSide && MessageEntry->bServerHandled);
-            if (bCanBeHandled) {
-                MessageEntry->MessageReceived.ExecuteIfBound(Connection, Content);
+    const TMap<int32, int32>* ModChannelIds = ChannelIdsByMessageType.Find(ModId);
+    if (ModChannelIds != nullptr) {
+        const int32* ChannelId = ModChannelIds->Find(MessageId);
+        if (ChannelId != nullptr) {
+            DispatchMessage(Connection, *ChannelId, Content);
+        }
+    }
+}
+
+void UModNetworkHandler::ReceiveChannelMessage(UNetConnection* Connection, uint16 RemoteChannelId, const FString& Content) const {
+    const FModChannelConnectionState* ChannelState = FindConnectionMetadata(Connection, ChannelStateSlot);
+    if (ChannelState != nullptr && ChannelState->RemoteToLocalChannels.IsValidIndex(RemoteChannelId)) {
+        DispatchMessage(Connection, ChannelState->RemoteToLocalChannels[RemoteChannelId], Content);
+    }
+}
+
+void UModNetworkHandler::DispatchMessage(UNetConnection* Connection, int32 ChannelId, const FString& Content) const {
+    if (ChannelId == INDEX_NONE) {
+        return; //Message type is registered on the remote side only
+    }
+    const FMessageEntry& MessageEntry = MessageChannels[ChannelId];
+    if (CanHandleMessageOnConnection(Connection, MessageEntry)) {
+        MessageEntry.MessageReceived.ExecuteIfBound(Connection, Content);
+    }
+}
+
+bool UModNetworkHandler::SendLargeMessage(UNetConnection* Connection, const FMessageType& MessageType, const TArray<uint8>& Payload) {
+    UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
+    const int32 ChannelId = NetworkHandler->FindChannelId(MessageType);
+    const FModChannelConnectionState* ChannelState = NetworkHandler->FindConnectionMetadata(Connection, ChannelStateSlot);
+    
+    if (ChannelId == INDEX_NONE || ChannelState == nullptr || !ChannelState->CanSendOnChannel(ChannelId)) {
+        UE_LOG(LogModNetworkHandler, Warning, TEXT("Cannot send large message %s:%d, channel id has not been agreed with the remote side"), *MessageType.ModReference, MessageType.MessageId);
+        return false;
+    }
+    
+    FOutgoingLargeMessage Message;
+    Message.ChannelId = (uint16) ChannelId;
+    Message.UncompressedSize = Payload.Num();
+    
+    //Compressed data is only sent when it is actually smaller, receiver tells them apart by comparing the sizes
+    int32 CompressedSize = FCompression::CompressMemoryBound(NAME_Zlib, Payload.Num());
+    Message.Data.SetNumUninitialized(CompressedSize);
+    if (Payload.Num() > 0 && FCompression::CompressMemory(NAME_Zlib, Message.Data.GetData(), CompressedSize, Payload.GetData(), Payload.Num()) && CompressedSize < Payload.Num()) {
+        Message.Data.SetNum(CompressedSize);
+    } else {
+        Message.Data = Payload;
+    }
+    
+    FLargeMessageConnectionState& LargeMessageState = NetworkHandler->GetConnectionMetadata(Connection, LargeMessageStateSlot);
+    Message.TransferId = LargeMessageState.NextTransferId++;
+    LargeMessageState.OutgoingMessages.Add(MoveTemp(Message));
+    return true;
+}
+
+bool UModNetworkHandler::TickLargeMessages(float DeltaTime) {
+    const int32 ChunkSize = FMath::Clamp(CVarLargeMessageChunkSize.GetValueOnGameThread(), 256, 32 * 1024);
+    const double BytesPerSecond = FMath::Max(CVarLargeMessageBytesPerSecond.GetValueOnGameThread(), ChunkSize);
+    const double ReceiveTimeout = CVarLargeMessageReceiveTimeout.GetValueOnGameThread();
+    const double CurrentTime = FPlatformTime::Seconds();
+    
+    for (const TPair<TWeakObjectPtr<UNetConnection>, FConnectionMetadataSlots>& Pair : ConnectionMetadataSlots) {
+        UNetConnection* Connection = Pair.Key.Get();
+        FLargeMessageConnectionState* LargeMessageStatePtr = Pair.Value.Find(LargeMessageStateSlot);
+        if (Connection == nullptr || LargeMessageStatePtr == nullptr) {
+            continue;
+        }
+        FLargeMessageConnectionState& LargeMessageState = *LargeMessageStatePtr;
+        for (auto It = LargeMessageState.IncomingMessages.CreateIterator(); It; ++It) {
+            if (CurrentTime - It.Value().LastReceiveTime > ReceiveTimeout) {
+                UE_LOG(LogModNetworkHandler, Warning, TEXT("Dropping large message from %s, no data has been received for %.0f seconds"), *Connection->LowLevelGetRemoteAddress(), ReceiveTimeout);
+                It.RemoveCurrent();
             }
         }
+        if (LargeMessageState.OutgoingMessages.Num() == 0 || Connection->State == USOCK_Closed) {
+            LargeMessageState.SendAllowance = 0.0;
+            continue;
+        }
+        //Allowance is capped at a single second worth of data, so connections waiting on the reliable buffer do not burst afterwards
+        LargeMessageState.SendAllowance = FMath::Min(LargeMessageState.SendAllowance + BytesPerSecond * DeltaTime, BytesPerSecond);
+        UChannel* ControlChannel = Connection->Channels.IsValidIndex(0) ? Connection->Channels[0] : nullptr;
+        bool bSentAnything = false;
+        
+        while (LargeMessageState.OutgoingMessages.Num() > 0 && LargeMessageState.SendAllowance > 0.0) {
+            //Overflowing reliable buffer of the control channel closes the connection, so leave enough room for the regular messages
+            if (ControlChannel == nullptr || ControlChannel->NumOutRec >= RELIABLE_BUFFER / 2) {
+                break;
+            }
+            FOutgoingLargeMessage& Message = LargeMessageState.OutgoingMessages[0];
+            if (!Message.bBeginSent) {
+                int32 DataSize = Message.Data.Num();
+                FNetControlMessage<NMT_ModLargeMessageBegin>::Send(Connection, Message.ChannelId, Message.TransferId, DataSize, Message.UncompressedSize);
+                Message.bBeginSent = true;
+            }
+            const int32 ChunkBytes = FMath::Min(ChunkSize, Message.Data.Num() - Message.BytesSent);
+            if (ChunkBytes > 0) {
+                TArray<uint8> ChunkData(Message.Data.GetData() + Message.BytesSent, ChunkBytes);
+                FNetControlMessage<NMT_ModLargeMessageChunk>::Send(Connection, Message.TransferId, ChunkData);
+                Message.BytesSent += ChunkBytes;
+                LargeMessageState.SendAllowance -= ChunkBytes;
+            }
+            if (Message.BytesSent >= Message.Data.Num()) {
+                LargeMessageState.OutgoingMessages.RemoveAt(0);
+            }
+            bSentAnything = true;
+        }
+        if (bSentAnything) {
+            Connection->FlushNet(true);
+        }
+    }
+    return true;
+}
+
+void UModNetworkHandler::ReceiveLargeMessageBegin(UNetConnection* Connection, uint16 RemoteChannelId, uint32 TransferId, int32 DataSize, int32 UncompressedSize) {
+    const int32 MaxLargeMessageSize = CVarMaxLargeMessageSize.GetValueOnGameThread();
+    if (UncompressedSize < 0 || DataSize < 0 || DataSize > UncompressedSize || UncompressedSize > MaxLargeMessageSize) {
+        UE_LOG(LogModNetworkHandler, Warning, TEXT("Rejecting large message of %d bytes from %s, maximum allowed size is %d bytes"), UncompressedSize, *Connection->LowLevelGetRemoteAddress(), MaxLargeMessageSize);
+        return;
+    }
+    FLargeMessageConnectionState& LargeMessageState = GetConnectionMetadata(Connection, LargeMessageStateSlot);
+    if (LargeMessageState.IncomingMessages.Num() >= MaxConcurrentIncomingLargeMessages) {
+        UE_LOG(LogModNetworkHandler, Warning, TEXT("Rejecting large message from %s, too many large messages are being received at once"), *Connection->LowLevelGetRemoteAddress());
+        return;
+    }
+    
+    FIncomingLargeMessage& Message = LargeMessageState.IncomingMessages.Add(TransferId);
+    Message.RemoteChannelId = RemoteChannelId;
+    Message.UncompressedSize = UncompressedSize;
+    Message.DataSize = DataSize;
+    Message.LastReceiveTime = FPlatformTime::Seconds();
+    
+    if (DataSize == 0) {
+        FIncomingLargeMessage CompletedMessage = MoveTemp(Message);
+        LargeMessageState.IncomingMessages.Remove(TransferId);
+        CompleteLargeMessage(Connection, CompletedMessage);
+    }
+}
+
+void UModNetworkHandler::ReceiveLargeMessageChunk(UNetConnection* Connection, uint32 TransferId, const TArray<uint8>& ChunkData) {
+    FLargeMessageConnectionState* LargeMessageState = FindConnectionMetadata(Connection, LargeMessageStateSlot);
+    FIncomingLargeMessage* Message = LargeMessageState != nullptr ? LargeMessageState->IncomingMessages.Find(TransferId) : nullptr;
+    if (Message == nullptr) {
+        return; //Message has been rejected when it's transfer began
+    }
+    if (Message->Data.Num() + ChunkData.Num() > Message->DataSize) {
+        UE_LOG(LogModNetworkHandler, Warning, TEXT("Dropping large message from %s, received more data than announced"), *Connection->LowLevelGetRemoteAddress());
+        LargeMessageState->IncomingMessages.Remove(TransferId);
+        return;
+    }
+    Message->Data.Append(ChunkData);
+    Message->LastReceiveTime = FPlatformTime::Seconds();
+    
+    if (Message->Data.Num() == Message->DataSize) {
+        //Handlers can send messages or close connection, so message is removed from the state before dispatching it
+        FIncomingLargeMessage CompletedMessage = MoveTemp(*Message);
+        LargeMessageState->IncomingMessages.Remove(TransferId);
+        CompleteLargeMessage(Connection, CompletedMessage);
+    }
+}
+
+void UModNetworkHandler::CompleteLargeMessage(UNetConnection* Connection, FIncomingLargeMessage& Message) {
+    const FModChannelConnectionState* ChannelState = FindConnectionMetadata(Connection, ChannelStateSlot);
+    if (ChannelState == nullptr || !ChannelState->RemoteToLocalChannels.IsValidIndex(Message.RemoteChannelId)) {
+        return;
+    }
+    const int32 ChannelId = ChannelState->RemoteToLocalChannels[Message.RemoteChannelId];
+    if (ChannelId == INDEX_NONE || !CanHandleMessageOnConnection(Connection, MessageChannels[ChannelId])) {
+        return;
+    }
+    
+    TArray<uint8> Payload;
+    if (Message.DataSize == Message.UncompressedSize) {
+        Payload = MoveTemp(Message.Data);
+    } else {
+        Payload.SetNumUninitialized(Message.UncompressedSize);
+        if (!FCompression::UncompressMemory(NAME_Zlib, Payload.GetData(), Payload.Num(), Message.Data.GetData(), Message.Data.Num())) {
+            UE_LOG(LogModNetworkHandler, Warning, TEXT("Failed to decompress large message received from %s"), *Connection->LowLevelGetRemoteAddress());
+            return;
+        }
+    }
+    MessageChannels[ChannelId].LargeMessageReceived.ExecuteIfBound(Connection, Payload);
+}
+
+void UModNetworkHandler::SendChannelTable(UNetConnection* Connection) {
+    //Table line N describes the message type of the channel N
+    TArray<FString> ChannelEntries;
+    ChannelEntries.SetNum(MessageChannels.Num());
+    for (const TPair<FString, TMap<int32, int32>>& ModPair : ChannelIdsByMessageType) {
+        for (const TPair<int32, int32>& MessagePair : ModPair.Value) {
+            ChannelEntries[MessagePair.Value] = FString::Printf(TEXT("%s:%d"), *ModPair.Key, MessagePair.Key);
+        }
+    }
+    SendMessage(Connection, MessageTypeChannelTable, FString::Join(ChannelEntries, TEXT("\n")));
+    GetConnectionMetadata(Connection, ChannelStateSlot).NumLocalChannelsSent = ChannelEntries.Num();
+}
+
+void UModNetworkHandler::ReceiveChannelTable(UNetConnection* Connection, FString Data) {
+    TArray<FString> ChannelEntries;
+    Data.ParseIntoArray(ChannelEntries, TEXT("\n"), false);
+    
+    FModChannelConnectionState& ChannelState = GetConnectionMetadata(Connection, ChannelStateSlot);
+    ChannelState.RemoteToLocalChannels.Reset(ChannelEntries.Num());
+    
+    for (const FString& ChannelEntry : ChannelEntries) {
+        FString ModReference;
+        FString MessageIdString;
+        int32 LocalChannelId = INDEX_NONE;
+        if (ChannelEntry.Split(TEXT(":"), &ModReference, &MessageIdString, ESearchCase::CaseSensitive, ESearchDir::FromEnd)) {
+            LocalChannelId = FindChannelId(FMessageType{ModReference, FCString::Atoi(*MessageIdString)});
+        }
+        ChannelState.RemoteToLocalChannels.Add(LocalChannelId);
+    }
+    
+    //Remote side sending it's table means it understands channel messages too,
+    //but we only reply with our table on the server, since client has sent it already on initial join
+    const bool bShouldSendChannelTable = ChannelState.NumLocalChannelsSent == 0;
+    ChannelState.bRemoteSupportsChannels = true;
+    if (bShouldSendChannelTable) {
+        SendChannelTable(Connection);
     }
 }
 
+FConnectionMetadataSlots& UModNetworkHandler::GetOrCreateMetadataSlots(UNetConnection* Connection) {
+    return ConnectionMetadataSlots.FindOrAdd(Connection);
+}
+
+const FConnectionMetadataSlots* UModNetworkHandler::FindMetadataSlots(UNetConnection* Connection) const {
+    return ConnectionMetadataSlots.Find(Connection);
+}
+
 UObjectMetadata* UModNetworkHandler::GetMetadataForConnection(UNetConnection* Connection) {
     const TWeakObjectPtr<UNetConnection> Pointer = Connection;
     UObjectMetadata** ObjectMetadata = Metadata.Find(Pointer);
@@ -59,47 +369,69 @@ UObjectMetadata* UModNetworkHandler::GetMetadataForConnection(UNetConnection* Co
 
 void UModNetworkHandler::InitializePatches() {
 	
+    //Handlers are bound to this subsystem, and are removed in Deinitialize together with it
     UNetConnection* NetConnectionInstance = GetMutableDefault<UNetConnection>();
-    SUBSCRIBE_METHOD_VIRTUAL_AFTER(UNetConnection::CleanUp, NetConnectionInstance, [=](UNetConnection* Connection) {
-    	//We need to check GEngine for NULL because this method will be called during final garbage purge
-    	//on engine shutdown, at this phase engine has pretty much exited and was destroyed already
-        if (GEngine != NULL) {
-        	UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
-        	NetworkHandler->Metadata.Remove(Connection);
-        }
+    CleanUpHookHandle = SUBSCRIBE_METHOD_VIRTUAL_AFTER(UNetConnection::CleanUp, NetConnectionInstance, [this](UNetConnection* Connection) {
+        Metadata.Remove(Connection);
+        ConnectionMetadataSlots.Remove(Connection);
     });
 	
     UWorld* WorldObjectInstance = GetMutableDefault<UWorld>();
-    SUBSCRIBE_METHOD_VIRTUAL_AFTER(UWorld::WelcomePlayer, WorldObjectInstance, [=](UWorld* ServerWorld, UNetConnection* Connection) {
-        UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
-        NetworkHandler->OnWelcomePlayer().Broadcast(ServerWorld, Connection);
+    WelcomePlayerHookHandle = SUBSCRIBE_METHOD_VIRTUAL_AFTER(UWorld::WelcomePlayer, WorldObjectInstance, [this](UWorld* ServerWorld, UNetConnection* Connection) {
+        OnWelcomePlayer().Broadcast(ServerWorld, Connection);
     });
 	
-    SUBSCRIBE_METHOD_AFTER(UPendingNetGame::SendInitialJoin, [=](UPendingNetGame* NetGame) {
+    SendInitialJoinHookHandle = SUBSCRIBE_METHOD_AFTER(UPendingNetGame::SendInitialJoin, [this](UPendingNetGame* NetGame) {
         if (NetGame->NetDriver != nullptr) {
             UNetConnection* ServerConnection = NetGame->NetDriver->ServerConnection;
             if (ServerConnection != nullptr) {
-                UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
-                NetworkHandler->OnClientInitialJoin().Broadcast(ServerConnection);
+                //Channel table goes first, so server can resolve channel messages as soon as it replies with it's own table
+                SendChannelTable(ServerConnection);
+                OnClientInitialJoin().Broadcast(ServerConnection);
             }
         }
     });
 	
-    auto MessageHandler = [=](auto& Call, void*, UNetConnection* Connection, uint8 MessageType, class FInBunch& Bunch) {
+    auto MessageHandler = [this](auto& Call, void*, UNetConnection* Connection, uint8 MessageType, class FInBunch& Bunch) {
         if (MessageType == NMT_ModMessage) {
             FString ModId; int32 MessageId; FString Content;
             if (FNetControlMessage<NMT_ModMessage>::Receive(Bunch, ModId, MessageId, Content)) {
-                UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
-                NetworkHandler->ReceiveMessage(Connection, ModId, MessageId, Content);
+                ReceiveMessage(Connection, ModId, MessageId, Content);
+                Call.Cancel();
+            }
+        } else if (MessageType == NMT_ModChannelMessage) {
+            uint16 ChannelId; FString Content;
+            if (FNetControlMessage<NMT_ModChannelMessage>::Receive(Bunch, ChannelId, Content)) {
+                ReceiveChannelMessage(Connection, ChannelId, Content);
+                Call.Cancel();
+            }
+        } else if (MessageType == NMT_ModLargeMessageBegin) {
+            uint16 ChannelId; uint32 TransferId; int32 DataSize; int32 UncompressedSize;
+            if (FNetControlMessage<NMT_ModLargeMessageBegin>::Receive(Bunch, ChannelId, TransferId, DataSize, UncompressedSize)) {
+                ReceiveLargeMessageBegin(Connection, ChannelId, TransferId, DataSize, UncompressedSize);
+                Call.Cancel();
+            }
+        } else if (MessageType == NMT_ModLargeMessageChunk) {
+            uint32 TransferId; TArray<uint8> ChunkData;
+            if (FNetControlMessage<NMT_ModLargeMessageChunk>::Receive(Bunch, TransferId, ChunkData)) {
+                ReceiveLargeMessageChunk(Connection, TransferId, ChunkData);
                 Call.Cancel();
             }
         }
     };
 
     void* WorldNetworkNotifyInstance = static_cast<FNetworkNotify*>(WorldObjectInstance);
-    SUBSCRIBE_METHOD_VIRTUAL(UWorld::NotifyControlMessage, WorldNetworkNotifyInstance, MessageHandler);
+    WorldControlMessageHookHandle = SUBSCRIBE_METHOD_VIRTUAL(UWorld::NotifyControlMessage, WorldNetworkNotifyInstance, MessageHandler);
 
     UPendingNetGame* PendingNetGame = (UPendingNetGame*) FindObjectChecked<UClass>(NULL, TEXT("/Script/Engine.PendingNetGame"))->GetDefaultObject();
     void* PendingGameNetworkNotifyInstance = static_cast<FNetworkNotify*>(PendingNetGame);
-    SUBSCRIBE_METHOD_VIRTUAL(UPendingNetGame::NotifyControlMessage, PendingGameNetworkNotifyInstance, MessageHandler);
+    PendingGameControlMessageHookHandle = SUBSCRIBE_METHOD_VIRTUAL(UPendingNetGame::NotifyControlMessage, PendingGameNetworkNotifyInstance, MessageHandler);
+}
+
+void UModNetworkHandler::RemovePatches() {
+    UNSUBSCRIBE_METHOD(UNetConnection::CleanUp, CleanUpHookHandle);
+    UNSUBSCRIBE_METHOD(UWorld::WelcomePlayer, WelcomePlayerHookHandle);
+    UNSUBSCRIBE_METHOD(UPendingNetGame::SendInitialJoin, SendInitialJoinHookHandle);
+    UNSUBSCRIBE_METHOD(UWorld::NotifyControlMessage, WorldControlMessageHookHandle);
+    UNSUBSCRIBE_METHOD(UPendingNetGame::NotifyControlMessage, PendingGameControlMessageHookHandle);
 }
@@ -8,6 +8,7 @@
 #include "ModLoading/ModLoadingLibrary.h"
 
 TSharedPtr<FMessageType> FSMLNetworkManager::MessageTypeModInit = NULL;
+TConnectionMetadataSlot<FSMLConnectionMetadata> FSMLNetworkManager::SMLMetadataSlot;
 
 void FSMLNetworkManager::RegisterMessageTypeAndHandlers() {
     UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
@@ -24,12 +25,17 @@ void FSMLNetworkManager::RegisterMessageTypeAndHandlers() {
 
 void FSMLNetworkManager::HandleMessageReceived(UNetConnection* Connection, FString Data) {
     UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
-    UObjectMetadata* Metadata = NetworkHandler->GetMetadataForConnection(Connection);
-    USMLConnectionMetadata* SMLMetadata = Metadata->GetOrCreateSubObject<USMLConnectionMetadata>(TEXT("SML"));
-    SMLMetadata->bIsInitialized = true;
+    FSMLConnectionMetadata& SMLMetadata = NetworkHandler->GetConnectionMetadata(Connection, SMLMetadataSlot);
+    SMLMetadata.bIsInitialized = true;
     if (!HandleModListObject(SMLMetadata, Data)) {
         Connection->Close();
     }
+    
+    //Keep deprecated metadata object in sync for mods still looking it up by name
+    UObjectMetadata* Metadata = NetworkHandler->GetMetadataForConnection(Connection);
+    USMLConnectionMetadata* LegacyMetadata = Metadata->GetOrCreateSubObject<USMLConnectionMetadata>(TEXT("SML"));
+    LegacyMetadata->bIsInitialized = SMLMetadata.bIsInitialized;
+    LegacyMetadata->InstalledClientMods = SMLMetadata.InstalledClientMods;
 }
 
 void FSMLNetworkManager::HandleInitialClientJoin(UNetConnection* Connection) {
@@ -59,9 +65,8 @@ void FSMLNetworkManager::HandleGameModePostLogin(AGameModeBase* GameMode, APlaye
         } else {
             //This is remote player, retrieve installed mods from connection
             UNetConnection* NetConnection = CastChecked<UNetConnection>(Controller->Player);
-            UObjectMetadata* Metadata = NetworkHandler->GetMetadataForConnection(NetConnection);
-            USMLConnectionMetadata* SMLMetadata = Metadata->GetOrCreateSubObject<USMLConnectionMetadata>(TEXT("SML"));
-            RemoteCallObject->ClientInstalledMods.Append(SMLMetadata->InstalledClientMods);
+            const FSMLConnectionMetadata& SMLMetadata = NetworkHandler->GetConnectionMetadata(NetConnection, SMLMetadataSlot);
+            RemoteCallObject->ClientInstalledMods.Append(SMLMetadata.InstalledClientMods);
         }
     }
 }
@@ -86,7 +91,7 @@ FString FSMLNetworkManager::SerializeLocalModList() {
     return ResultString;
 }
 
-bool FSMLNetworkManager::HandleModListObject(USMLConnectionMetadata* Metadata, const FString& ModListString) {
+bool FSMLNetworkManager::HandleModListObject(FSMLConnectionMetadata& Metadata, const FString& ModListString) {
     const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(ModListString);
     TSharedPtr<FJsonObject> MetadataObject;
     
@@ -105,7 +110,7 @@ bool FSMLNetworkManager::HandleModListObject(USMLConnectionMetadata* Metadata, c
         FString ErrorMessage;
         const bool bParseSuccess = ModVersion.ParseVersion(Pair.Value->AsString(), ErrorMessage);
         if (bParseSuccess) {
-            Metadata->InstalledClientMods.Add(Pair.Key, ModVersion);
+            Metadata.InstalledClientMods.Add(Pair.Key, ModVersion);
         } else {
             return false;
         }
@@ -116,11 +121,10 @@ bool FSMLNetworkManager::HandleModListObject(USMLConnectionMetadata* Metadata, c
 
 void FSMLNetworkManager::ValidateSMLConnectionData(UNetConnection* Connection) {
     UModNetworkHandler* NetworkHandler = GEngine->GetEngineSubsystem<UModNetworkHandler>();
-    UObjectMetadata* Metadata = NetworkHandler->GetMetadataForConnection(Connection);
-    USMLConnectionMetadata* SMLMetadata = Metadata->GetOrCreateSubObject<USMLConnectionMetadata>(TEXT("SML"));
+    const FSMLConnectionMetadata& SMLMetadata = NetworkHandler->GetConnectionMetadata(Connection, SMLMetadataSlot);
     TArray<FString> ClientMissingMods;
     
-    if (!SMLMetadata->bIsInitialized) {
+    if (!SMLMetadata.bIsInitialized) {
         UModNetworkHandler::CloseWithFailureMessage(Connection, TEXT("This server is running Satisfactory Mod Loader, and your client doesn't have it installed."));
         return;
     }
@@ -132,7 +136,7 @@ void FSMLNetworkManager::ValidateSMLConnectionData(UNetConnection* Connection) {
         if (ModInfo.bAcceptsAnyRemoteVersion) {
             continue; //Server-side only mod
         }
-        FVersion* ClientVersion = SMLMetadata->InstalledClientMods.Find(ModInfo.Name);
+        const FVersion* ClientVersion = SMLMetadata.InstalledClientMods.Find(ModInfo.Name);
         const FString ModName = FString::Printf(TEXT("%s (%s)"), *ModInfo.FriendlyName, *ModInfo.Name);
         if (ClientVersion == nullptr) {
             ClientMissingMods.Add(ModName);
@@ -152,7 +156,7 @@ void FSMLNetworkManager::ValidateSMLConnectionData(UNetConnection* Connection) {
     }
 }
 
-bool HandleModInitData(USMLConnectionMetadata* Metadata, const FString& Data) {
+bool HandleModInitData(FSMLConnectionMetadata& Metadata, const FString& Data) {
     const TSharedRef<TJsonReader<>> Reader = TJsonReaderFactory<>::Create(Data);
     FJsonSerializer Serializer;
     TSharedPtr<FJsonObject> MetadataObject;
@@ -165,7 +169,7 @@ bool HandleModInitData(USMLConnectionMetadata* Metadata, const FString& Data) {
         FString ErrorMessage;
         const bool bParseSuccess = ModVersion.ParseVersion(Pair.Value->AsString(), ErrorMessage);
         if (bParseSuccess) {
-            Metadata->InstalledClientMods.Add(Pair.Key, ModVersion);
+            Metadata.InstalledClientMods.Add(Pair.Key, ModVersion);
         }
     }
     return true;
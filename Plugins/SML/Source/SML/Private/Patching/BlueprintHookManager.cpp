@@ -135,9 +135,10 @@ int32 UBlueprintHookManager::PreProcessHookOffset(UFunction* Function, int32 Hoo
 
 void FFunctionHookInfo::InvokeBlueprintHook(FFrame& Frame, int32 HookOffset) {
 	FBlueprintHookHelper HookHelper{Frame, ReturnStatementOffset};
-	const TArray<TFunction<HookFunctionSignature>>& Hooks = this->CodeOffsetByHookList.FindChecked(HookOffset);
-	for (const TFunction<HookFunctionSignature>& Hook : Hooks) {
-		Hook(HookHelper);
+	const FBlueprintHookList& HookList = this->CodeOffsetByHookList.FindChecked(HookOffset);
+	FHookProfilerDispatchScope ProfilerScope(HookList.ProfilerHookId);
+	for (const FBlueprintHookEntry& Entry : HookList.Hooks) {
+		ProfilerScope.Invoke(Entry.ProfilerCounterId, [&]() { Entry.Hook(HookHelper); });
 	}
 }
 
@@ -148,7 +149,7 @@ void FFunctionHookInfo::RecalculateReturnStatementOffset(UFunction* Function) {
 	this->ReturnStatementOffset = ReturnInstructionOffset;
 }
 
-void UBlueprintHookManager::HookBlueprintFunction(UFunction* Function, const TFunction<HookFunctionSignature>& Hook, int32 HookOffset) {
+void UBlueprintHookManager::HookBlueprintFunction(UFunction* Function, const TFunction<HookFunctionSignature>& Hook, int32 HookOffset, const FString& OwnerName) {
 #if !WITH_EDITOR
 	checkf(Function->Script.Num(), TEXT("HookBPFunction: Function provided is not implemented in BP"));
 	
@@ -170,15 +171,19 @@ void UBlueprintHookManager::HookBlueprintFunction(UFunction* Function, const TFu
 #endif
 
 	FFunctionHookInfo& FunctionHookInfo = HookedFunctions.FindOrAdd(Function);
-	TArray<TFunction<HookFunctionSignature>>& InstalledHooks = FunctionHookInfo.CodeOffsetByHookList.FindOrAdd(HookOffset);
+	FBlueprintHookList& InstalledHooks = FunctionHookInfo.CodeOffsetByHookList.FindOrAdd(HookOffset);
 
-	if (InstalledHooks.Num() == 0) {
+	if (InstalledHooks.Hooks.Num() == 0) {
 		//First time function is hooked at this offset, call InstallBlueprintHook
 		InstallBlueprintHook(Function, HookOffset);
 		//Update cached return instruction offset
 		FunctionHookInfo.RecalculateReturnStatementOffset(Function);
+
+		const FString HookName = FString::Printf(TEXT("%s@%d"), *Function->GetPathName(), HookOffset);
+		InstalledHooks.ProfilerHookId = FHookProfiler::RegisterHook(HookName, EHookProfilerHookType::Blueprint);
 	}
 	//Add provided hook into the array
-	InstalledHooks.Add(Hook);
+	const int32 ProfilerCounterId = FHookProfiler::RegisterHandler(InstalledHooks.ProfilerHookId, OwnerName, EHookProfilerCounterType::HandlerBefore);
+	InstalledHooks.Hooks.Add(FBlueprintHookEntry{Hook, ProfilerCounterId});
 #endif
 }
@@ -0,0 +1,399 @@
+#include "Patching/HookProfiler.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/ScopeLock.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY(LogHookProfiler);
+
+std::atomic<bool> FHookProfiler::bEnabled{false};
+
+static int32 GHookProfilerSampleInterval = 16;
+static FAutoConsoleVariableRef CVarHookProfilerSampleInterval(
+	TEXT("SML.HookProfiler.SampleInterval"),
+	GHookProfilerSampleInterval,
+	TEXT("Timing is sampled for every N-th hook dispatch on each thread. 1 means every dispatch is timed"));
+
+namespace HookProfilerPrivate {
+	constexpr int32 CountersPerChunk = 1024;
+	constexpr int32 MaxCounterChunks = 64;
+	constexpr int32 MaxCounters = CountersPerChunk * MaxCounterChunks;
+
+	/** Single counter slot, only ever written by the owning thread */
+	struct FThreadCounter {
+		std::atomic<uint64> CallCount{0};
+		std::atomic<uint64> SampleCount{0};
+		std::atomic<uint64> SampledCycles{0};
+	};
+
+	struct FThreadCounterChunk {
+		FThreadCounter Counters[CountersPerChunk];
+	};
+
+	/**
+	 * Counters belonging to a single thread
+	 * Since there is only one writer, increments do not need to be atomic read-modify-write operations,
+	 * atomics are only used to make reads from the dumping thread well-defined
+	 */
+	struct FThreadCounterBlock {
+		std::atomic<FThreadCounterChunk*> Chunks[MaxCounterChunks];
+		uint32 DispatchCounter = 0;
+
+		FThreadCounterBlock() {
+			for (std::atomic<FThreadCounterChunk*>& Chunk : Chunks) {
+				Chunk.store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		FThreadCounter& GetCounter(int32 CounterId) {
+			std::atomic<FThreadCounterChunk*>& ChunkSlot = Chunks[CounterId / CountersPerChunk];
+			FThreadCounterChunk* Chunk = ChunkSlot.load(std::memory_order_relaxed);
+			if (Chunk == nullptr) {
+				Chunk = new FThreadCounterChunk();
+				ChunkSlot.store(Chunk, std::memory_order_release);
+			}
+			return Chunk->Counters[CounterId % CountersPerChunk];
+		}
+	};
+
+	FORCEINLINE void IncrementOwned(std::atomic<uint64>& Value, uint64 Delta) {
+		Value.store(Value.load(std::memory_order_relaxed) + Delta, std::memory_order_relaxed);
+	}
+
+	struct FCounterInfo {
+		FString HookName;
+		FString OwnerName;
+		EHookProfilerHookType HookType;
+		EHookProfilerCounterType CounterType;
+		int32 HookCounterId;
+		int32 OriginalCounterId;
+		int32 HandlerIndex;
+		int32 NumHandlersBefore;
+		int32 NumHandlersAfter;
+		/** False once the handler owning the counter has been removed, such counters are skipped by exports */
+		bool bRegistered;
+	};
+
+	FCriticalSection ProfilerLock;
+
+	/** Metadata of every registered counter, indexed by counter id */
+	TArray<FCounterInfo> RegisteredCounters;
+
+	/** Counter blocks of all threads that ever recorded anything. Never freed so counts survive thread exit */
+	TArray<FThreadCounterBlock*> ThreadCounterBlocks;
+
+	/** Values recorded at the moment of the last reset, subtracted from the totals */
+	TArray<FHookProfilerCounterValue> ResetBaseline;
+
+	/** Ids of the counters belonging to the removed handlers, reused before allocating new ones */
+	TArray<int32> FreeCounterIds;
+
+	thread_local FThreadCounterBlock* CurrentThreadBlock = nullptr;
+
+	FThreadCounterBlock& GetThreadBlock() {
+		if (CurrentThreadBlock == nullptr) {
+			CurrentThreadBlock = new FThreadCounterBlock();
+			FScopeLock ScopeLock(&ProfilerLock);
+			ThreadCounterBlocks.Add(CurrentThreadBlock);
+		}
+		return *CurrentThreadBlock;
+	}
+
+	/** Sums values of a single counter across all threads, ignoring the reset baseline. Should be called with the profiler lock held */
+	FHookProfilerCounterValue GatherRawCounterValue(int32 CounterId) {
+		FHookProfilerCounterValue Value;
+		for (FThreadCounterBlock* Block : ThreadCounterBlocks) {
+			const FThreadCounterChunk* Chunk = Block->Chunks[CounterId / CountersPerChunk].load(std::memory_order_acquire);
+			if (Chunk != nullptr) {
+				const FThreadCounter& Counter = Chunk->Counters[CounterId % CountersPerChunk];
+				Value.CallCount += Counter.CallCount.load(std::memory_order_relaxed);
+				Value.SampleCount += Counter.SampleCount.load(std::memory_order_relaxed);
+				Value.SampledCycles += Counter.SampledCycles.load(std::memory_order_relaxed);
+			}
+		}
+		return Value;
+	}
+
+	/** Should be called with the profiler lock held */
+	int32 AddCounter(const FCounterInfo& CounterInfo) {
+		if (FreeCounterIds.Num() > 0) {
+			const int32 CounterId = FreeCounterIds.Pop(false);
+			RegisteredCounters[CounterId] = CounterInfo;
+			//Thread counters cannot be zeroed from here, so values left by the previous handler become the baseline of the new one
+			if (ResetBaseline.Num() <= CounterId) {
+				ResetBaseline.SetNum(CounterId + 1);
+			}
+			ResetBaseline[CounterId] = GatherRawCounterValue(CounterId);
+			return CounterId;
+		}
+		if (RegisteredCounters.Num() >= MaxCounters) {
+			UE_LOG(LogHookProfiler, Warning, TEXT("Hook profiler counter limit reached, hook %s will not be profiled"), *CounterInfo.HookName);
+			return INDEX_NONE;
+		}
+		return RegisteredCounters.Add(CounterInfo);
+	}
+
+	/** Sums values of all counters across all threads. Should be called with the profiler lock held */
+	TArray<FHookProfilerCounterValue> GatherCounterValues() {
+		TArray<FHookProfilerCounterValue> Values;
+		Values.SetNum(RegisteredCounters.Num());
+
+		for (FThreadCounterBlock* Block : ThreadCounterBlocks) {
+			for (int32 ChunkIndex = 0; ChunkIndex < MaxCounterChunks; ChunkIndex++) {
+				const FThreadCounterChunk* Chunk = Block->Chunks[ChunkIndex].load(std::memory_order_acquire);
+				if (Chunk == nullptr) {
+					continue;
+				}
+				const int32 FirstCounterId = ChunkIndex * CountersPerChunk;
+				const int32 LastCounterId = FMath::Min(FirstCounterId + CountersPerChunk, Values.Num());
+				for (int32 CounterId = FirstCounterId; CounterId < LastCounterId; CounterId++) {
+					const FThreadCounter& Counter = Chunk->Counters[CounterId - FirstCounterId];
+					FHookProfilerCounterValue& Value = Values[CounterId];
+					Value.CallCount += Counter.CallCount.load(std::memory_order_relaxed);
+					Value.SampleCount += Counter.SampleCount.load(std::memory_order_relaxed);
+					Value.SampledCycles += Counter.SampledCycles.load(std::memory_order_relaxed);
+				}
+			}
+		}
+
+		for (int32 CounterId = 0; CounterId < FMath::Min(Values.Num(), ResetBaseline.Num()); CounterId++) {
+			const FHookProfilerCounterValue& Baseline = ResetBaseline[CounterId];
+			FHookProfilerCounterValue& Value = Values[CounterId];
+			Value.CallCount -= FMath::Min(Value.CallCount, Baseline.CallCount);
+			Value.SampleCount -= FMath::Min(Value.SampleCount, Baseline.SampleCount);
+			Value.SampledCycles -= FMath::Min(Value.SampledCycles, Baseline.SampledCycles);
+		}
+		return Values;
+	}
+
+	const TCHAR* GetHookTypeName(EHookProfilerHookType HookType) {
+		return HookType == EHookProfilerHookType::Native ? TEXT("native") : TEXT("blueprint");
+	}
+
+	const TCHAR* GetCounterTypeName(EHookProfilerCounterType CounterType) {
+		switch (CounterType) {
+			case EHookProfilerCounterType::Hook: return TEXT("hook");
+			case EHookProfilerCounterType::OriginalFunction: return TEXT("original");
+			case EHookProfilerCounterType::HandlerBefore: return TEXT("before");
+			case EHookProfilerCounterType::HandlerAfter: return TEXT("after");
+			default: return TEXT("unknown");
+		}
+	}
+
+	TSharedRef<FJsonObject> SerializeCounterValue(const FHookProfilerCounterValue& Value) {
+		const TSharedRef<FJsonObject> JsonObject = MakeShareable(new FJsonObject());
+		JsonObject->SetNumberField(TEXT("calls"), Value.CallCount);
+		JsonObject->SetNumberField(TEXT("sampledCalls"), Value.SampleCount);
+		JsonObject->SetNumberField(TEXT("averageMicroseconds"), Value.GetAverageMicroseconds());
+		JsonObject->SetNumberField(TEXT("estimatedTotalMilliseconds"), Value.GetEstimatedTotalMilliseconds());
+		return JsonObject;
+	}
+
+	bool IsHandlerCounter(const FCounterInfo& CounterInfo) {
+		return CounterInfo.CounterType == EHookProfilerCounterType::HandlerBefore ||
+			CounterInfo.CounterType == EHookProfilerCounterType::HandlerAfter;
+	}
+}
+
+using namespace HookProfilerPrivate;
+
+FProfilingToolConsole FHookProfiler::Console(
+	TEXT("Hook profiler"), TEXT("SML.HookProfiler"), FHookProfiler::bEnabled,
+	TEXT("Whenever to gather call counts and sampled timing for native and blueprint hooks"),
+	TEXT("Dumps hook profiler statistics. Usage: SML.HookProfiler.Dump [json|csv] [FilePath]"),
+	[](const TArray<FString>& Args, FString& OutFilePath) {
+		const FString Format = Args.Num() >= 1 ? Args[0] : TEXT("json");
+		const FString FilePath = Args.Num() >= 2 ? Args[1] : TEXT("");
+		return FHookProfiler::DumpToFile(Format, FilePath, OutFilePath);
+	},
+	&FHookProfiler::ResetCounters);
+
+double FHookProfilerCounterValue::GetAverageMicroseconds() const {
+	if (SampleCount == 0) {
+		return 0.0;
+	}
+	return FPlatformTime::ToMilliseconds64(SampledCycles) * 1000.0 / SampleCount;
+}
+
+double FHookProfilerCounterValue::GetEstimatedTotalMilliseconds() const {
+	return GetAverageMicroseconds() * CallCount / 1000.0;
+}
+
+int32 FHookProfiler::RegisterHook(const FString& HookName, EHookProfilerHookType HookType) {
+	FScopeLock ScopeLock(&ProfilerLock);
+	FCounterInfo HookInfo{HookName, TEXT(""), HookType, EHookProfilerCounterType::Hook, INDEX_NONE, INDEX_NONE, 0, 0, 0, true};
+	const int32 HookCounterId = AddCounter(HookInfo);
+	if (HookCounterId == INDEX_NONE) {
+		return INDEX_NONE;
+	}
+	FCounterInfo OriginalInfo{HookName, TEXT(""), HookType, EHookProfilerCounterType::OriginalFunction, HookCounterId, INDEX_NONE, 0, 0, 0, true};
+	const int32 OriginalCounterId = AddCounter(OriginalInfo);
+
+	RegisteredCounters[HookCounterId].HookCounterId = HookCounterId;
+	RegisteredCounters[HookCounterId].OriginalCounterId = OriginalCounterId;
+	return HookCounterId;
+}
+
+int32 FHookProfiler::GetOriginalFunctionCounter(int32 HookCounterId) {
+	if (HookCounterId == INDEX_NONE) {
+		return INDEX_NONE;
+	}
+	FScopeLock ScopeLock(&ProfilerLock);
+	return RegisteredCounters[HookCounterId].OriginalCounterId;
+}
+
+int32 FHookProfiler::RegisterHandler(int32 HookCounterId, const FString& OwnerName, EHookProfilerCounterType HandlerType) {
+	if (HookCounterId == INDEX_NONE) {
+		return INDEX_NONE;
+	}
+	FScopeLock ScopeLock(&ProfilerLock);
+	FCounterInfo& HookInfo = RegisteredCounters[HookCounterId];
+	const bool bIsHandlerBefore = HandlerType == EHookProfilerCounterType::HandlerBefore;
+	const int32 HandlerIndex = bIsHandlerBefore ? HookInfo.NumHandlersBefore++ : HookInfo.NumHandlersAfter++;
+
+	FCounterInfo HandlerInfo{HookInfo.HookName, OwnerName, HookInfo.HookType, HandlerType, HookCounterId, INDEX_NONE, HandlerIndex, 0, 0, true};
+	return AddCounter(HandlerInfo);
+}
+
+void FHookProfiler::UnregisterHandler(int32 CounterId) {
+	if (CounterId == INDEX_NONE) {
+		return;
+	}
+	FScopeLock ScopeLock(&ProfilerLock);
+	FCounterInfo& CounterInfo = RegisteredCounters[CounterId];
+	checkf(IsHandlerCounter(CounterInfo) && CounterInfo.bRegistered, TEXT("Counter %d does not belong to a registered hook handler"), CounterId);
+	//Dispatches that picked up the handler before it's removal can still record into the counter, which only skews the baseline of the next owner
+	CounterInfo.bRegistered = false;
+	FreeCounterIds.Add(CounterId);
+}
+
+void FHookProfiler::SetEnabled(bool bNewEnabled) {
+	Console.SetEnabled(bNewEnabled);
+}
+
+bool FHookProfiler::BeginDispatch(int32 HookCounterId) {
+	FThreadCounterBlock& Block = GetThreadBlock();
+	IncrementOwned(Block.GetCounter(HookCounterId).CallCount, 1);
+	const uint32 SampleInterval = (uint32) FMath::Max(GHookProfilerSampleInterval, 1);
+	return (++Block.DispatchCounter % SampleInterval) == 0;
+}
+
+void FHookProfiler::RecordCall(int32 CounterId) {
+	IncrementOwned(GetThreadBlock().GetCounter(CounterId).CallCount, 1);
+}
+
+void FHookProfiler::RecordSample(int32 CounterId, uint64 Cycles) {
+	FThreadCounter& Counter = GetThreadBlock().GetCounter(CounterId);
+	IncrementOwned(Counter.SampleCount, 1);
+	IncrementOwned(Counter.SampledCycles, Cycles);
+}
+
+void FHookProfiler::ResetCounters() {
+	FScopeLock ScopeLock(&ProfilerLock);
+	//Counters are owned by their threads, so instead of zeroing them we remember current values and subtract them later
+	ResetBaseline.Empty();
+	ResetBaseline = GatherCounterValues();
+	UE_LOG(LogHookProfiler, Display, TEXT("Hook profiler counters have been reset"));
+}
+
+FString FHookProfiler::ExportJson() {
+	FScopeLock ScopeLock(&ProfilerLock);
+	const TArray<FHookProfilerCounterValue> Values = GatherCounterValues();
+
+	TMap<int32, TSharedPtr<FJsonObject>> HookObjects;
+	TMap<int32, TArray<TSharedPtr<FJsonValue>>> HookHandlers;
+	TArray<int32> HookCounterIds;
+
+	for (int32 CounterId = 0; CounterId < Values.Num(); CounterId++) {
+		const FCounterInfo& CounterInfo = RegisteredCounters[CounterId];
+		if (!CounterInfo.bRegistered) {
+			continue;
+		}
+		if (CounterInfo.CounterType == EHookProfilerCounterType::Hook) {
+			const TSharedRef<FJsonObject> HookObject = SerializeCounterValue(Values[CounterId]);
+			HookObject->SetStringField(TEXT("hook"), CounterInfo.HookName);
+			HookObject->SetStringField(TEXT("type"), GetHookTypeName(CounterInfo.HookType));
+			HookObjects.Add(CounterId, HookObject);
+			HookCounterIds.Add(CounterId);
+
+		} else if (CounterInfo.CounterType == EHookProfilerCounterType::OriginalFunction) {
+			HookObjects.FindChecked(CounterInfo.HookCounterId)->SetObjectField(TEXT("originalFunction"), SerializeCounterValue(Values[CounterId]));
+		} else {
+			const TSharedRef<FJsonObject> HandlerObject = SerializeCounterValue(Values[CounterId]);
+			HandlerObject->SetStringField(TEXT("owner"), CounterInfo.OwnerName);
+			HandlerObject->SetStringField(TEXT("kind"), GetCounterTypeName(CounterInfo.CounterType));
+			HandlerObject->SetNumberField(TEXT("index"), CounterInfo.HandlerIndex);
+			HookHandlers.FindOrAdd(CounterInfo.HookCounterId).Add(MakeShareable(new FJsonValueObject(HandlerObject)));
+		}
+	}
+
+	//Most expensive hooks go first
+	HookCounterIds.Sort([&](int32 A, int32 B) {
+		return Values[A].GetEstimatedTotalMilliseconds() > Values[B].GetEstimatedTotalMilliseconds();
+	});
+
+	TArray<TSharedPtr<FJsonValue>> HookArray;
+	for (const int32 HookCounterId : HookCounterIds) {
+		const TSharedPtr<FJsonObject>& HookObject = HookObjects.FindChecked(HookCounterId);
+		HookObject->SetArrayField(TEXT("handlers"), HookHandlers.FindRef(HookCounterId));
+		HookArray.Add(MakeShareable(new FJsonValueObject(HookObject)));
+	}
+
+	const TSharedRef<FJsonObject> RootObject = MakeShareable(new FJsonObject());
+	RootObject->SetNumberField(TEXT("sampleInterval"), GHookProfilerSampleInterval);
+	RootObject->SetArrayField(TEXT("hooks"), HookArray);
+
+	FString OutJsonString;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutJsonString);
+	FJsonSerializer::Serialize(RootObject, Writer);
+	return OutJsonString;
+}
+
+FString FHookProfiler::ExportCsv() {
+	FScopeLock ScopeLock(&ProfilerLock);
+	const TArray<FHookProfilerCounterValue> Values = GatherCounterValues();
+
+	FString OutCsvString = TEXT("Hook,HookType,Kind,Owner,HandlerIndex,Calls,SampledCalls,AverageMicroseconds,EstimatedTotalMilliseconds\n");
+	for (int32 CounterId = 0; CounterId < Values.Num(); CounterId++) {
+		const FCounterInfo& CounterInfo = RegisteredCounters[CounterId];
+		if (!CounterInfo.bRegistered) {
+			continue;
+		}
+		const FHookProfilerCounterValue& Value = Values[CounterId];
+		OutCsvString.Appendf(TEXT("\"%s\",%s,%s,\"%s\",%d,%llu,%llu,%.3f,%.3f\n"),
+			*CounterInfo.HookName.Replace(TEXT("\""), TEXT("\"\"")),
+			GetHookTypeName(CounterInfo.HookType), GetCounterTypeName(CounterInfo.CounterType),
+			*CounterInfo.OwnerName, CounterInfo.HandlerIndex,
+			Value.CallCount, Value.SampleCount,
+			Value.GetAverageMicroseconds(), Value.GetEstimatedTotalMilliseconds());
+	}
+	return OutCsvString;
+}
+
+bool FHookProfiler::DumpToFile(const FString& Format, const FString& FilePath, FString& OutFilePath) {
+	const bool bIsCsv = Format.Equals(TEXT("csv"), ESearchCase::IgnoreCase);
+	if (!bIsCsv && !Format.Equals(TEXT("json"), ESearchCase::IgnoreCase)) {
+		UE_LOG(LogHookProfiler, Error, TEXT("Unknown hook profiler dump format '%s', expected json or csv"), *Format);
+		return false;
+	}
+
+	OutFilePath = FProfilingToolConsole::MakeDumpFilePath(FilePath, TEXT("HookProfile"), bIsCsv ? TEXT("csv") : TEXT("json"));
+	if (!FProfilingToolConsole::WriteDumpFile(bIsCsv ? ExportCsv() : ExportJson(), OutFilePath)) {
+		return false;
+	}
+
+	TMap<FString, double> TimeByOwner;
+	{
+		FScopeLock ScopeLock(&ProfilerLock);
+		const TArray<FHookProfilerCounterValue> Values = GatherCounterValues();
+		for (int32 CounterId = 0; CounterId < Values.Num(); CounterId++) {
+			const FCounterInfo& CounterInfo = RegisteredCounters[CounterId];
+			if (CounterInfo.bRegistered && IsHandlerCounter(CounterInfo)) {
+				TimeByOwner.FindOrAdd(CounterInfo.OwnerName) += Values[CounterId].GetEstimatedTotalMilliseconds();
+			}
+		}
+	}
+	FProfilingToolConsole::LogTopEntries(TEXT("Time spent in hook handlers by owner"), MoveTemp(TimeByOwner));
+	return true;
+}
@@ -2,6 +2,8 @@
 #include "CoreMinimal.h"
 #include "funchook.h"
 #include "AssemblyAnalyzer.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
 
 DEFINE_LOG_CATEGORY(LogNativeHookManager);
 
@@ -10,18 +12,106 @@ DEFINE_LOG_CATEGORY(LogNativeHookManager);
 //to keep single hook instance for each method
 static TMap<void*, void*> RegisteredListenerMap;
 
-//Map of the function implementation pointer to the trampoline function pointer. Used to ensure one hook per function installed
-static TMap<void*, void*> InstalledHookMap;
+struct FInstalledHook {
+	void* TrampolineFunction;
+	funchook* FunchookInstance;
+};
+
+//Map of the function implementation pointer to the installed hook. Used to ensure one hook per function installed
+static TMap<void*, FInstalledHook> InstalledHookMap;
+
+//Both maps above and the handler list snapshots are only modified with the registration lock held
+FCriticalSection* FNativeHookManagerInternal::GetHookRegistrationLock() {
+	static FCriticalSection HookRegistrationLock;
+	return &HookRegistrationLock;
+}
+
+//Handler list reclamation is epoch based: every thread announces the global epoch it observed when entering
+//the outermost hook dispatch, and a retired handler list is freed once all of the threads currently
+//inside of the dispatch have entered it after the list has been replaced
+struct FHookDispatchThreadState {
+	std::atomic<uint64> ActiveEpoch{0};
+	int32 DispatchDepth = 0;
+};
+
+struct FRetiredHandlerList {
+	void* HandlerList;
+	void(*Deleter)(void*);
+	uint64 RetireEpoch;
+};
+
+static std::atomic<uint64> GlobalDispatchEpoch{1};
+
+//Thread states are never freed, threads that exited just stay quiescent forever
+static FCriticalSection ThreadStatesLock;
+static TArray<FHookDispatchThreadState*> DispatchThreadStates;
+static thread_local FHookDispatchThreadState* CurrentThreadDispatchState = nullptr;
+
+//Guarded by the registration lock
+static TArray<FRetiredHandlerList> RetiredHandlerLists;
 
 void* FNativeHookManagerInternal::GetHandlerListInternal(void* RealFunctionAddress) {
+	FScopeLock ScopeLock(GetHookRegistrationLock());
 	void** ExistingMapEntry = RegisteredListenerMap.Find(RealFunctionAddress);
 	return ExistingMapEntry ? *ExistingMapEntry : nullptr;
 }
 
 void FNativeHookManagerInternal::SetHandlerListInstanceInternal(void* RealFunctionAddress, void* HandlerList) {
+	FScopeLock ScopeLock(GetHookRegistrationLock());
 	RegisteredListenerMap.Add(RealFunctionAddress, HandlerList);
 }
 
+void* FNativeHookManagerInternal::EnterDispatch() {
+	FHookDispatchThreadState* ThreadState = CurrentThreadDispatchState;
+	if (ThreadState == nullptr) {
+		ThreadState = new FHookDispatchThreadState();
+		CurrentThreadDispatchState = ThreadState;
+		FScopeLock ScopeLock(&ThreadStatesLock);
+		DispatchThreadStates.Add(ThreadState);
+	}
+	//Nested dispatches (hooked function calling another hooked function) keep the outermost epoch
+	if (ThreadState->DispatchDepth++ == 0) {
+		ThreadState->ActiveEpoch.store(GlobalDispatchEpoch.load(std::memory_order_seq_cst), std::memory_order_seq_cst);
+	}
+	return ThreadState;
+}
+
+void FNativeHookManagerInternal::ExitDispatch(void* ThreadStateToken) {
+	FHookDispatchThreadState* ThreadState = static_cast<FHookDispatchThreadState*>(ThreadStateToken);
+	if (--ThreadState->DispatchDepth == 0) {
+		ThreadState->ActiveEpoch.store(0, std::memory_order_release);
+	}
+}
+
+static void ReclaimRetiredHandlerLists() {
+	uint64 MinActiveEpoch = MAX_uint64;
+	{
+		FScopeLock ScopeLock(&ThreadStatesLock);
+		for (const FHookDispatchThreadState* ThreadState : DispatchThreadStates) {
+			const uint64 ActiveEpoch = ThreadState->ActiveEpoch.load(std::memory_order_seq_cst);
+			if (ActiveEpoch != 0) {
+				MinActiveEpoch = FMath::Min(MinActiveEpoch, ActiveEpoch);
+			}
+		}
+	}
+	
+	for (int32 i = RetiredHandlerLists.Num() - 1; i >= 0; i--) {
+		const FRetiredHandlerList& RetiredList = RetiredHandlerLists[i];
+		//Threads that entered dispatch at or after retirement epoch could only have loaded the new list
+		if (RetiredList.RetireEpoch <= MinActiveEpoch) {
+			RetiredList.Deleter(RetiredList.HandlerList);
+			RetiredHandlerLists.RemoveAtSwap(i);
+		}
+	}
+}
+
+void FNativeHookManagerInternal::RetireHandlerList(void* HandlerList, void(*Deleter)(void*)) {
+	FScopeLock ScopeLock(GetHookRegistrationLock());
+	const uint64 RetireEpoch = GlobalDispatchEpoch.fetch_add(1, std::memory_order_seq_cst) + 1;
+	RetiredHandlerLists.Add(FRetiredHandlerList{HandlerList, Deleter, RetireEpoch});
+	ReclaimRetiredHandlerLists();
+}
+
 #define CHECK_FUNCHOOK_ERR(arg) \
 	if (arg != FUNCHOOK_ERROR_SUCCESS) UE_LOG(LogNativeHookManager, Fatal, TEXT("Hooking function %s failed: funchook failed: %hs"), *DebugSymbolName, funchook_error_message(funchook));
 
@@ -29,10 +119,13 @@ void LogDebugAssemblyAnalyzer(const ANSICHAR* Message) {
 	UE_LOG(LogNativeHookManager, Display, TEXT("AssemblyAnalyzer Debug: %hs"), Message);
 }
 
-bool HookStandardFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* HookFunctionPointer, void** OutTrampolineFunction) {
-	if (InstalledHookMap.Contains(OriginalFunctionPointer)) {
+//Trampoline is published through the callback once funchook has prepared it, and before the function code is patched,
+//so the hook entered right after the installation already observes the trampoline and never the raw function address
+bool HookStandardFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* HookFunctionPointer, TFunctionRef<void(void*)> PublishTrampoline) {
+	FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
+	if (const FInstalledHook* InstalledHook = InstalledHookMap.Find(OriginalFunctionPointer)) {
 		//Hook already installed, set trampoline function and return
-		*OutTrampolineFunction = InstalledHookMap.FindChecked(OriginalFunctionPointer);
+		PublishTrampoline(InstalledHook->TrampolineFunction);
 		return false;
 	}
 	funchook* funchook = funchook_create();
@@ -40,14 +133,29 @@ bool HookStandardFunction(const FString& DebugSymbolName, void* OriginalFunction
 		UE_LOG(LogNativeHookManager, Fatal, TEXT("Hooking function %s failed: funchook_create() returned NULL"), *DebugSymbolName);
 		return false;
 	}
-	*OutTrampolineFunction = OriginalFunctionPointer;
-	CHECK_FUNCHOOK_ERR(funchook_prepare(funchook, OutTrampolineFunction, HookFunctionPointer));
+	//funchook_prepare replaces the function address with the trampoline, so it is only ever written to the local variable
+	void* TrampolineFunction = OriginalFunctionPointer;
+	CHECK_FUNCHOOK_ERR(funchook_prepare(funchook, &TrampolineFunction, HookFunctionPointer));
+	PublishTrampoline(TrampolineFunction);
 	CHECK_FUNCHOOK_ERR(funchook_install(funchook, 0));
-	InstalledHookMap.Add(OriginalFunctionPointer, *OutTrampolineFunction);
+	InstalledHookMap.Add(OriginalFunctionPointer, FInstalledHook{TrampolineFunction, funchook});
 	return true;
 }
 
+static void DestroyUninstalledFunchook(void* FunchookInstance) {
+	funchook_destroy(static_cast<funchook*>(FunchookInstance));
+}
+
 SML_API void* FNativeHookManagerInternal::RegisterHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment, void* HookFunctionPointer, void** OutTrampolineFunction) {
+	void* ResolvedHookingFunctionPointer = ResolveHookFunction(DebugSymbolName, OriginalFunctionPointer, SampleObjectInstance, ThisAdjustment);
+	HookStandardFunction(DebugSymbolName, ResolvedHookingFunctionPointer, HookFunctionPointer, [&](void* TrampolineFunction) {
+		*OutTrampolineFunction = TrampolineFunction;
+	});
+	UE_LOG(LogNativeHookManager, Display, TEXT("Successfully hooked function %s at %p"), *DebugSymbolName, ResolvedHookingFunctionPointer);
+	return ResolvedHookingFunctionPointer;
+}
+
+void* FNativeHookManagerInternal::ResolveHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment) {
 	SetDebugLoggingHook(&LogDebugAssemblyAnalyzer);
 	FunctionInfo FunctionInfo = DiscoverFunction((uint8*) OriginalFunctionPointer);
 	checkf(FunctionInfo.bIsValid, TEXT("Attempt to hook invalid function %s: Provided code pointer %p is not valid"), *DebugSymbolName, OriginalFunctionPointer);
@@ -74,9 +182,28 @@ SML_API void* FNativeHookManagerInternal::RegisterHookFunction(const FString& De
 	//Log debugging information just in case
 	void* ResolvedHookingFunctionPointer = FunctionInfo.RealFunctionAddress;
 	UE_LOG(LogNativeHookManager, Display, TEXT("Hooking function %s: Provided address: %p, resolved address: %p"), *DebugSymbolName, OriginalFunctionPointer, ResolvedHookingFunctionPointer);
-	
-	HookStandardFunction(DebugSymbolName, ResolvedHookingFunctionPointer, HookFunctionPointer, OutTrampolineFunction);
-	UE_LOG(LogNativeHookManager, Display, TEXT("Successfully hooked function %s at %p"), *DebugSymbolName, ResolvedHookingFunctionPointer);
 	return ResolvedHookingFunctionPointer;
 }
 
+void FNativeHookManagerInternal::InstallHookFunction(const FString& DebugSymbolName, void* ResolvedFunctionPointer, void* HookFunctionPointer, std::atomic<void*>& OutTrampolineFunction) {
+	HookStandardFunction(DebugSymbolName, ResolvedFunctionPointer, HookFunctionPointer, [&](void* TrampolineFunction) {
+		OutTrampolineFunction.store(TrampolineFunction, std::memory_order_seq_cst);
+	});
+	UE_LOG(LogNativeHookManager, Display, TEXT("Successfully hooked function %s at %p"), *DebugSymbolName, ResolvedFunctionPointer);
+}
+
+void FNativeHookManagerInternal::UninstallHookFunction(const FString& DebugSymbolName, void* ResolvedFunctionPointer, std::atomic<void*>& OutTrampolineFunction) {
+	FScopeLock ScopeLock(GetHookRegistrationLock());
+	FInstalledHook InstalledHook;
+	if (!InstalledHookMap.RemoveAndCopyValue(ResolvedFunctionPointer, InstalledHook)) {
+		return;
+	}
+	funchook* funchook = InstalledHook.FunchookInstance;
+	CHECK_FUNCHOOK_ERR(funchook_uninstall(funchook, 0));
+	//Function code is restored now, so calls that are already inside of the hook but have not entered the dispatch yet
+	//can safely call the function directly. Trampoline is only swapped out before retirement, so dispatches that have
+	//loaded it are covered by the retirement epoch
+	OutTrampolineFunction.store(ResolvedFunctionPointer, std::memory_order_seq_cst);
+	RetireHandlerList(funchook, &DestroyUninstalledFunchook);
+	UE_LOG(LogNativeHookManager, Display, TEXT("Successfully unhooked function %s at %p"), *DebugSymbolName, ResolvedFunctionPointer);
+}
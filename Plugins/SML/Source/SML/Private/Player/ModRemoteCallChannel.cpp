@@ -0,0 +1,168 @@
+#include "Player/ModRemoteCallChannel.h"
+#include "FGPlayerController.h"
+#include "Net/UnrealNetwork.h"
+#include "Registry/RemoteCallObjectRegistry.h"
+#include "Serialization/MemoryReader.h"
+#include "Serialization/MemoryWriter.h"
+
+/** Unreliable batches are kept small enough to fit into a single packet, since losing any part of it drops the whole batch */
+static constexpr int32 MaxUnreliableBatchSize = 1024;
+/** Reliable batches are kept below the maximum size of the partial bunch the remote side is willing to reassemble */
+static constexpr int32 MaxReliableBatchSize = 32 * 1024;
+
+TArray<TWeakObjectPtr<UModRemoteCallChannel>> UModRemoteCallChannel::ChannelsPendingFlush;
+
+UModRemoteCallChannel* UModRemoteCallChannel::Get(AFGPlayerController* PlayerController) {
+    return Cast<UModRemoteCallChannel>(PlayerController->GetRemoteCallObjectOfClass(UModRemoteCallChannel::StaticClass()));
+}
+
+void UModRemoteCallChannel::QueueCall(uint32 CallId, const TArray<uint8>& Payload) {
+    URemoteCallObjectRegistry* Registry = GetWorld()->GetGameInstance()->GetSubsystem<URemoteCallObjectRegistry>();
+    const FModRemoteCall* RemoteCall = Registry->FindModRemoteCall(CallId);
+    checkf(RemoteCall, TEXT("Tried to queue unregistered mod remote call %u"), CallId);
+
+    //Listen server host sends calls to itself, so it can queue calls of either direction
+    const AFGPlayerController* PlayerController = GetOuterFGPlayerController();
+    if (!PlayerController->IsLocalController() || !PlayerController->HasAuthority()) {
+        const EModRemoteCallDirection SendDirection = PlayerController->HasAuthority() ? EModRemoteCallDirection::ServerToClient : EModRemoteCallDirection::ClientToServer;
+        checkf(RemoteCall->Direction == SendDirection, TEXT("Tried to queue mod remote call %s in the direction it has not been registered for"), *RemoteCall->Name);
+    }
+
+    if (RemoteCall->Mode == EModRemoteCallMode::Unreliable) {
+        UnreliableCalls.Add(FQueuedCall{CallId, Payload});
+    } else if (RemoteCall->Mode == EModRemoteCallMode::ReliableLatestOnly) {
+        //Only the latest payload is sent, in the place of the first call queued in this net update
+        const int32* ExistingCallIndex = CoalescedCallIndices.Find(CallId);
+        if (ExistingCallIndex != NULL) {
+            ReliableCalls[*ExistingCallIndex].Payload = Payload;
+        } else {
+            CoalescedCallIndices.Add(CallId, ReliableCalls.Add(FQueuedCall{CallId, Payload}));
+        }
+    } else {
+        ReliableCalls.Add(FQueuedCall{CallId, Payload});
+    }
+
+    if (!bFlushScheduled) {
+        bFlushScheduled = true;
+        ChannelsPendingFlush.Add(this);
+    }
+}
+
+void UModRemoteCallChannel::FlushCalls() {
+    SendBatches(ReliableCalls, MaxReliableBatchSize, true);
+    SendBatches(UnreliableCalls, MaxUnreliableBatchSize, false);
+    CoalescedCallIndices.Reset();
+    bFlushScheduled = false;
+}
+
+void UModRemoteCallChannel::SendBatches(TArray<FQueuedCall>& Calls, int32 MaxBatchSize, bool bReliable) {
+    TArray<uint8> Batch;
+    FMemoryWriter BatchWriter(Batch);
+
+    for (FQueuedCall& Call : Calls) {
+        //Every call is prefixed by it's id and packed payload size
+        const int32 CallSizeEstimate = Call.Payload.Num() + 2 * sizeof(uint32);
+        if (Batch.Num() > 0 && Batch.Num() + CallSizeEstimate > MaxBatchSize) {
+            SendBatch(Batch, bReliable);
+            Batch.Reset();
+            BatchWriter.Seek(0);
+        }
+        uint32 PayloadSize = Call.Payload.Num();
+        BatchWriter << Call.CallId;
+        BatchWriter.SerializeIntPacked(PayloadSize);
+        BatchWriter.Serialize(Call.Payload.GetData(), PayloadSize);
+    }
+    if (Batch.Num() > 0) {
+        SendBatch(Batch, bReliable);
+    }
+    Calls.Reset();
+}
+
+void UModRemoteCallChannel::SendBatch(const TArray<uint8>& Batch, bool bReliable) {
+    AFGPlayerController* PlayerController = GetOuterFGPlayerController();
+    if (PlayerController->HasAuthority() && PlayerController->IsLocalController()) {
+        //Listen server host is both the sender and the receiver, so there is nothing to send over the network
+        ReceiveBatch(Batch, TOptional<EModRemoteCallDirection>());
+    } else if (!PlayerController->HasAuthority()) {
+        if (bReliable) {
+            Server_ReceiveReliableBatch(Batch);
+        } else {
+            Server_ReceiveUnreliableBatch(Batch);
+        }
+    } else {
+        if (bReliable) {
+            Client_ReceiveReliableBatch(Batch);
+        } else {
+            Client_ReceiveUnreliableBatch(Batch);
+        }
+    }
+}
+
+void UModRemoteCallChannel::ReceiveBatch(const TArray<uint8>& Batch, TOptional<EModRemoteCallDirection> Direction) {
+    URemoteCallObjectRegistry* Registry = GetWorld()->GetGameInstance()->GetSubsystem<URemoteCallObjectRegistry>();
+    AFGPlayerController* PlayerController = GetOuterFGPlayerController();
+    FMemoryReader BatchReader(Batch);
+    TArray<uint8> Payload;
+
+    while (!BatchReader.AtEnd()) {
+        uint32 CallId = 0;
+        uint32 PayloadSize = 0;
+        BatchReader << CallId;
+        BatchReader.SerializeIntPacked(PayloadSize);
+        if (BatchReader.IsError() || PayloadSize > (uint32) (BatchReader.TotalSize() - BatchReader.Tell())) {
+            UE_LOG(LogRemoteCallObjectRegistry, Warning, TEXT("Received malformed mod remote call batch from %s"), *PlayerController->GetName());
+            return;
+        }
+        Payload.SetNumUninitialized(PayloadSize, false);
+        BatchReader.Serialize(Payload.GetData(), PayloadSize);
+
+        const FModRemoteCall* RemoteCall = Registry->FindModRemoteCall(CallId);
+        if (RemoteCall == NULL) {
+            UE_LOG(LogRemoteCallObjectRegistry, Verbose, TEXT("Skipping unregistered mod remote call %u"), CallId);
+        } else if (Direction.IsSet() && RemoteCall->Direction != Direction.GetValue()) {
+            UE_LOG(LogRemoteCallObjectRegistry, Warning, TEXT("Dropping mod remote call %s received from %s in the wrong direction"), *RemoteCall->Name, *PlayerController->GetName());
+        } else {
+            RemoteCall->OnReceived.ExecuteIfBound(PlayerController, Payload);
+        }
+    }
+}
+
+void UModRemoteCallChannel::FlushChannelsOfWorld(UWorld* World, ELevelTick TickType, float DeltaSeconds) {
+    for (int32 i = ChannelsPendingFlush.Num() - 1; i >= 0; i--) {
+        UModRemoteCallChannel* Channel = ChannelsPendingFlush[i].Get();
+        if (Channel == NULL) {
+            ChannelsPendingFlush.RemoveAtSwap(i);
+        } else if (Channel->GetWorld() == World) {
+            ChannelsPendingFlush.RemoveAtSwap(i);
+            Channel->FlushCalls();
+        }
+    }
+}
+
+void UModRemoteCallChannel::Server_ReceiveReliableBatch_Implementation(const TArray<uint8>& Batch) {
+    ReceiveBatch(Batch, EModRemoteCallDirection::ClientToServer);
+}
+
+bool UModRemoteCallChannel::Server_ReceiveReliableBatch_Validate(const TArray<uint8>& Batch) {
+    return true;
+}
+
+void UModRemoteCallChannel::Server_ReceiveUnreliableBatch_Implementation(const TArray<uint8>& Batch) {
+    ReceiveBatch(Batch, EModRemoteCallDirection::ClientToServer);
+}
+
+bool UModRemoteCallChannel::Server_ReceiveUnreliableBatch_Validate(const TArray<uint8>& Batch) {
+    return true;
+}
+
+void UModRemoteCallChannel::Client_ReceiveReliableBatch_Implementation(const TArray<uint8>& Batch) {
+    ReceiveBatch(Batch, EModRemoteCallDirection::ServerToClient);
+}
+
+void UModRemoteCallChannel::Client_ReceiveUnreliableBatch_Implementation(const TArray<uint8>& Batch) {
+    ReceiveBatch(Batch, EModRemoteCallDirection::ServerToClient);
+}
+
+void UModRemoteCallChannel::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const {
+    DOREPLIFETIME(UModRemoteCallChannel, DummyReplicatedField);
+}
@@ -10,12 +10,19 @@
 #include "FGSchematicManager.h"
 #include "FGTutorialIntroManager.h"
 #include "Unlocks/FGUnlockRecipe.h"
+#include "Unlocks/FGUnlockSchematic.h"
+#include "AvailabilityDependencies/FGSchematicPurchasedDependency.h"
 #include "FGCustomizationRecipe.h"
 #include "IPlatformFilePak.h"
 #include "Patching/NativeHookManager.h"
 #include "Reflection/ReflectionHelper.h"
 #include "Engine/AssetManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Async/ParallelFor.h"
+#include "Util/TopologicalSort/TopologicalSort.h"
+#include "Util/PhaseTimeline.h"
 #include "ModLoading/ModLoadingLibrary.h"
+#include "SatisfactoryModLoader.h"
 #include "Subsystem/SubsystemActorManager.h"
 #include "Util/BlueprintAssetHelperLibrary.h"
 
@@ -140,38 +147,96 @@ void AModContentRegistry::NotifyModuleRegistrationFinished() {
 	FreezeRegistryState();
 }
 
-void AModContentRegistry::FlushStateToSchematicManager(AFGSchematicManager* SchematicManager) const {
-    const TArray<TSharedPtr<FSchematicRegistrationInfo>> RegisteredSchematics = SchematicRegistryState.GetAllObjects();
+static TAutoConsoleVariable<float> CVarRegistryFlushBudgetMs(
+    TEXT("SML.ContentRegistry.FlushBudgetMs"),
+    2.0f,
+    TEXT("Maximum time in milliseconds spent per frame on flushing late content registrations into the game managers. 0 means no limit"),
+    ECVF_Default);
 
-    //Empty lists while maintaining enough capacity to re-populate it later
-    SchematicManager->mAllSchematics.Empty(RegisteredSchematics.Num());
-    SchematicManager->mAvailableSchematics.Empty(RegisteredSchematics.Num());
+static FORCEINLINE bool IsFlushDeadlineReached(const double FlushDeadline) {
+    return FlushDeadline > 0.0 && FPlatformTime::Seconds() >= FlushDeadline;
+}
+
+/** Only these schematic types are listed as available by the schematic manager, the rest are given through other means */
+static bool IsSchematicTypeListedAsAvailable(TSubclassOf<UFGSchematic> Schematic) {
+    const ESchematicType SchematicType = UFGSchematic::GetType(Schematic);
+    return SchematicType == ESchematicType::EST_Milestone ||
+        SchematicType == ESchematicType::EST_Tutorial ||
+        SchematicType == ESchematicType::EST_ResourceSink;
+}
+
+bool AModContentRegistry::FlushStateToSchematicManager(AFGSchematicManager* SchematicManager, const double FlushDeadline) {
+    const TArray<TSharedPtr<FSchematicRegistrationInfo>>& RegisteredSchematics = SchematicRegistryState.GetAllObjects();
 
-    for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : RegisteredSchematics) {
-        TSubclassOf<UFGSchematic> Schematic = RegistrationInfo->RegisteredObject;
+    //First flush replaces lists populated by the schematic manager, later flushes only append newly registered schematics
+    if (SchematicManagerFlushedCount == INDEX_NONE) {
+        //Empty lists while maintaining enough capacity to re-populate it later
+        SchematicManager->mAllSchematics.Empty(RegisteredSchematics.Num());
+        SchematicManager->mAvailableSchematics.Empty(RegisteredSchematics.Num());
+        SchematicManagerFlushedCount = 0;
+    } else {
+        SchematicManager->mAllSchematics.Reserve(RegisteredSchematics.Num());
+        bPendingSchematicAvailabilityUpdate = true;
+    }
+
+    while (SchematicManagerFlushedCount < RegisteredSchematics.Num()) {
+        TSubclassOf<UFGSchematic> Schematic = RegisteredSchematics[SchematicManagerFlushedCount++]->RegisteredObject;
         SchematicManager->mAllSchematics.Add(Schematic);
 
-        if ((UFGSchematic::GetType(Schematic) == ESchematicType::EST_Milestone ||
-            UFGSchematic::GetType(Schematic) == ESchematicType::EST_Tutorial ||
-            UFGSchematic::GetType(Schematic) == ESchematicType::EST_ResourceSink) &&
-            SchematicManager->CanGiveAccessToSchematic(Schematic)) {
+        if (IsSchematicTypeListedAsAvailable(Schematic) && SchematicManager->CanGiveAccessToSchematic(Schematic)) {
             SchematicManager->mAvailableSchematics.Add(Schematic);
         }
+        if (IsFlushDeadlineReached(FlushDeadline)) {
+            break;
+        }
     }
+
+    //Late content can satisfy availability dependencies of the schematics flushed before it, so re-check the ones that were not available,
+    //same as the full rebuild of the available schematics list would. It is done once the whole batch is flushed, so it only runs once per batch
+    const bool bIsFullyFlushed = SchematicManagerFlushedCount == RegisteredSchematics.Num();
+    if (bIsFullyFlushed && bPendingSchematicAvailabilityUpdate) {
+        TSet<TSubclassOf<UFGSchematic>> AvailableSchematics(SchematicManager->mAvailableSchematics);
+        for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : RegisteredSchematics) {
+            TSubclassOf<UFGSchematic> Schematic = RegistrationInfo->RegisteredObject;
+            if (!AvailableSchematics.Contains(Schematic) && IsSchematicTypeListedAsAvailable(Schematic) &&
+                SchematicManager->CanGiveAccessToSchematic(Schematic)) {
+                SchematicManager->mAvailableSchematics.Add(Schematic);
+            }
+        }
+        bPendingSchematicAvailabilityUpdate = false;
+    }
+    return bIsFullyFlushed;
 }
 
-void AModContentRegistry::FlushStateToResearchManager(AFGResearchManager* ResearchManager) const {
-    const TArray<TSharedPtr<FResearchTreeRegistrationInfo>> RegisteredResearchTrees = ResearchTreeRegistryState.GetAllObjects();
+bool AModContentRegistry::FlushStateToResearchManager(AFGResearchManager* ResearchManager, const double FlushDeadline) {
+    const TArray<TSharedPtr<FResearchTreeRegistrationInfo>>& RegisteredResearchTrees = ResearchTreeRegistryState.GetAllObjects();
 
-    //Empty lists while maintaining enough capacity to re-populate it later
-    ResearchManager->mAvailableResearchTrees.Empty(RegisteredResearchTrees.Num());
+    if (ResearchManagerFlushedCount == INDEX_NONE) {
+        //Empty lists while maintaining enough capacity to re-populate it later
+        ResearchManager->mAvailableResearchTrees.Empty(RegisteredResearchTrees.Num());
+        ResearchManagerFlushedCount = 0;
+        bPendingResearchTreeUpdate = true;
+    } else {
+        ResearchManager->mAvailableResearchTrees.Reserve(RegisteredResearchTrees.Num());
+    }
 
-    for (const TSharedPtr<FResearchTreeRegistrationInfo>& RegistrationInfo : RegisteredResearchTrees) {
-        TSubclassOf<UFGResearchTree> ResearchTree = RegistrationInfo->RegisteredObject;
+    while (ResearchManagerFlushedCount < RegisteredResearchTrees.Num()) {
+        TSubclassOf<UFGResearchTree> ResearchTree = RegisteredResearchTrees[ResearchManagerFlushedCount++]->RegisteredObject;
         ResearchManager->mAvailableResearchTrees.Add(ResearchTree);
+        bPendingResearchTreeUpdate = true;
+
+        if (IsFlushDeadlineReached(FlushDeadline)) {
+            break;
+        }
     }
-    //Update unlocked research trees
-    ResearchManager->UpdateUnlockedResearchTrees();
+
+    //Update unlocked research trees once the whole batch is flushed, it goes through all of the trees anyway
+    const bool bIsFullyFlushed = ResearchManagerFlushedCount == RegisteredResearchTrees.Num();
+    if (bIsFullyFlushed && bPendingResearchTreeUpdate) {
+        ResearchManager->UpdateUnlockedResearchTrees();
+        bPendingResearchTreeUpdate = false;
+    }
+    return bIsFullyFlushed;
 }
 
 void AModContentRegistry::SubscribeToSchematicManager(AFGSchematicManager* SchematicManager) {
@@ -181,12 +246,18 @@ void AModContentRegistry::SubscribeToSchematicManager(AFGSchematicManager* Schem
 }
 
 void AModContentRegistry::Init() {
+    FPhaseTimelineScope TimelineScope(TEXT("ContentRegistry"), TEXT("RegisterVanillaContent"));
     //Register vanilla content in the registry
     const FName FactoryGame = FACTORYGAME_MOD_NAME;
 
     UE_LOG(LogContentRegistry, Display, TEXT("Initializing mod content registry"));
-    const TArray<TSubclassOf<UFGSchematic>> AllSchematics = DiscoverVanillaContentOfType<UFGSchematic>();
-    const TArray<TSubclassOf<UFGResearchTree>> AllResearchTrees = DiscoverVanillaContentOfType<UFGResearchTree>();
+    TArray<TSubclassOf<UFGSchematic>> AllSchematics;
+    TArray<TSubclassOf<UFGResearchTree>> AllResearchTrees;
+    {
+        FPhaseTimelineScope DiscoveryTimelineScope(TEXT("ContentRegistry"), TEXT("DiscoverVanillaContent"));
+        AllSchematics = DiscoverVanillaContentOfType<UFGSchematic>();
+        AllResearchTrees = DiscoverVanillaContentOfType<UFGResearchTree>();
+    }
 
     //Start registering vanilla content now
     GIsRegisteringVanillaContent = true;
@@ -203,11 +274,182 @@ void AModContentRegistry::Init() {
     GIsRegisteringVanillaContent = false;
 }
 
+static TAutoConsoleVariable<int32> CVarValidateRegistryOnFreeze(
+    TEXT("SML.ContentRegistry.ValidateOnFreeze"),
+    0,
+    TEXT("When non-zero, all registered content is validated for broken data and references once registry is frozen. Always enabled in development mode"),
+    ECVF_Default);
+
+/** Collects schematics required to be purchased by the availability dependencies, reporting the ones that are not registered */
+static void ValidateSchematicDependencies(const AModContentRegistry* Registry, const TArray<UFGAvailabilityDependency*>& Dependencies,
+                                          TArray<FString>& OutIssues, TArray<UClass*>& OutRequiredSchematics) {
+    for (UFGAvailabilityDependency* Dependency : Dependencies) {
+        const UFGSchematicPurchasedDependency* PurchasedDependency = Cast<UFGSchematicPurchasedDependency>(Dependency);
+        if (PurchasedDependency == NULL) {
+            continue;
+        }
+        TArray<TSubclassOf<UFGSchematic>> RequiredSchematics;
+        PurchasedDependency->GetSchematics(RequiredSchematics);
+
+        for (const TSubclassOf<UFGSchematic>& RequiredSchematic : RequiredSchematics) {
+            if (RequiredSchematic == NULL) {
+                OutIssues.Add(TEXT("Dependency references NULL schematic"));
+            } else if (!Registry->IsSchematicRegistered(RequiredSchematic)) {
+                OutIssues.Add(FString::Printf(TEXT("Dependency references unregistered schematic %s"), *RequiredSchematic->GetPathName()));
+            } else {
+                OutRequiredSchematics.Add(RequiredSchematic);
+            }
+        }
+    }
+}
+
+static void ValidateRecipe(TSubclassOf<UFGRecipe> Recipe, TArray<FString>& OutIssues) {
+    const TArray<FItemAmount> Products = UFGRecipe::GetProducts(Recipe);
+    for (int32 i = 0; i < Products.Num(); i++) {
+        if (Products[i].ItemClass == NULL) {
+            OutIssues.Add(FString::Printf(TEXT("Product #%d has NULL item descriptor"), i));
+        } else if (Products[i].Amount <= 0) {
+            OutIssues.Add(FString::Printf(TEXT("Product %s has non-positive amount %d"), *Products[i].ItemClass->GetName(), Products[i].Amount));
+        }
+    }
+    const TArray<FItemAmount> Ingredients = UFGRecipe::GetIngredients(Recipe);
+    for (int32 i = 0; i < Ingredients.Num(); i++) {
+        if (Ingredients[i].ItemClass == NULL) {
+            OutIssues.Add(FString::Printf(TEXT("Ingredient #%d has NULL item descriptor"), i));
+        } else if (Ingredients[i].Amount <= 0) {
+            OutIssues.Add(FString::Printf(TEXT("Ingredient %s has non-positive amount %d"), *Ingredients[i].ItemClass->GetName(), Ingredients[i].Amount));
+        }
+    }
+}
+
+static void ValidateSchematic(const AModContentRegistry* Registry, TSubclassOf<UFGSchematic> Schematic, TArray<FString>& OutIssues, TArray<UClass*>& OutRequiredSchematics) {
+    for (UFGUnlock* Unlock : UFGSchematic::GetUnlocks(Schematic)) {
+        if (Unlock == NULL) {
+            OutIssues.Add(TEXT("Unlocks array contains NULL unlock"));
+        } else if (const UFGUnlockRecipe* UnlockRecipe = Cast<UFGUnlockRecipe>(Unlock)) {
+            for (const TSubclassOf<UFGRecipe>& Recipe : UnlockRecipe->GetRecipesToUnlock()) {
+                if (Recipe == NULL) {
+                    OutIssues.Add(FString::Printf(TEXT("Unlock %s references NULL recipe"), *Unlock->GetName()));
+                }
+            }
+        } else if (const UFGUnlockSchematic* UnlockSchematic = Cast<UFGUnlockSchematic>(Unlock)) {
+            for (const TSubclassOf<UFGSchematic>& UnlockedSchematic : UnlockSchematic->GetSchematicsToUnlock()) {
+                if (UnlockedSchematic == NULL) {
+                    OutIssues.Add(FString::Printf(TEXT("Unlock %s references NULL schematic"), *Unlock->GetName()));
+                } else if (!Registry->IsSchematicRegistered(UnlockedSchematic)) {
+                    OutIssues.Add(FString::Printf(TEXT("Unlock %s references unregistered schematic %s"), *Unlock->GetName(), *UnlockedSchematic->GetPathName()));
+                }
+            }
+        }
+    }
+    TArray<UFGAvailabilityDependency*> Dependencies;
+    UFGSchematic::GetSchematicDependencies(Schematic, Dependencies);
+    ValidateSchematicDependencies(Registry, Dependencies, OutIssues, OutRequiredSchematics);
+}
+
+static void ValidateResearchTree(const AModContentRegistry* Registry, TSubclassOf<UFGResearchTree> ResearchTree, TArray<FString>& OutIssues) {
+    if (Registry->GetSchematicsInResearchTree(ResearchTree).Num() == 0) {
+        OutIssues.Add(TEXT("Research tree does not contain any schematics"));
+    }
+    TArray<UClass*> RequiredSchematics;
+    ValidateSchematicDependencies(Registry, UFGResearchTree::GetUnlockDependencies(ResearchTree), OutIssues, RequiredSchematics);
+}
+
+int32 AModContentRegistry::ValidateRegistryState() const {
+    FPhaseTimelineScope TimelineScope(TEXT("ContentRegistry"), TEXT("Validate"));
+    const double StartTime = FPlatformTime::Seconds();
+    const TArray<TSharedPtr<FRecipeRegistrationInfo>>& Recipes = RecipeRegistryState.GetAllObjects();
+    const TArray<TSharedPtr<FSchematicRegistrationInfo>>& Schematics = SchematicRegistryState.GetAllObjects();
+    const TArray<TSharedPtr<FResearchTreeRegistrationInfo>>& ResearchTrees = ResearchTreeRegistryState.GetAllObjects();
+    const int32 SchematicsStart = Recipes.Num();
+    const int32 ResearchTreesStart = SchematicsStart + Schematics.Num();
+
+    //Every object gets its own result slot, so worker threads never write into shared state
+    TArray<TArray<FString>> IssuesPerObject;
+    IssuesPerObject.SetNum(ResearchTreesStart + ResearchTrees.Num());
+    TArray<TArray<UClass*>> RequiredSchematicsPerSchematic;
+    RequiredSchematicsPerSchematic.SetNum(Schematics.Num());
+
+    ParallelFor(IssuesPerObject.Num(), [&](const int32 Index) {
+        if (Index < SchematicsStart) {
+            ValidateRecipe(Recipes[Index]->RegisteredObject, IssuesPerObject[Index]);
+        } else if (Index < ResearchTreesStart) {
+            const int32 SchematicIndex = Index - SchematicsStart;
+            ValidateSchematic(this, Schematics[SchematicIndex]->RegisteredObject, IssuesPerObject[Index], RequiredSchematicsPerSchematic[SchematicIndex]);
+        } else {
+            ValidateResearchTree(this, ResearchTrees[Index - ResearchTreesStart]->RegisteredObject, IssuesPerObject[Index]);
+        }
+    });
+
+    const auto GetRegistrationInfo = [&](const int32 Index) -> const FBasicRegistrationInfo& {
+        if (Index < SchematicsStart) {
+            return *Recipes[Index];
+        }
+        if (Index < ResearchTreesStart) {
+            return *Schematics[Index - SchematicsStart];
+        }
+        return *ResearchTrees[Index - ResearchTreesStart];
+    };
+
+    //Group issues by the mod owning the broken content
+    TMap<FName, TArray<FString>> IssuesByMod;
+    int32 TotalIssueCount = 0;
+    for (int32 i = 0; i < IssuesPerObject.Num(); i++) {
+        const FBasicRegistrationInfo& RegistrationInfo = GetRegistrationInfo(i);
+        for (const FString& Issue : IssuesPerObject[i]) {
+            IssuesByMod.FindOrAdd(RegistrationInfo.OwnedByModReference).Add(FString::Printf(TEXT("%s: %s"), *RegistrationInfo.RegisteredObject->GetPathName(), *Issue));
+            TotalIssueCount++;
+        }
+    }
+
+    //Schematics requiring each other to be purchased can never become available, look for cycles in the dependency graph
+    TDirectedGraph<UClass*> SchematicDependencyGraph;
+    for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : Schematics) {
+        SchematicDependencyGraph.AddNode(RegistrationInfo->RegisteredObject);
+    }
+    for (int32 i = 0; i < Schematics.Num(); i++) {
+        for (UClass* RequiredSchematic : RequiredSchematicsPerSchematic[i]) {
+            SchematicDependencyGraph.AddEdge(RequiredSchematic, Schematics[i]->RegisteredObject);
+        }
+    }
+    TArray<UClass*> SortedSchematics;
+    TSet<UClass*> CycleSchematics;
+    if (!FTopologicalSort::TopologicalSort(SchematicDependencyGraph, SortedSchematics, &CycleSchematics)) {
+        for (UClass* Schematic : CycleSchematics) {
+            const TSharedPtr<FSchematicRegistrationInfo> RegistrationInfo = SchematicRegistryState.FindObject(Schematic);
+            IssuesByMod.FindOrAdd(RegistrationInfo->OwnedByModReference).Add(FString::Printf(TEXT("%s: Part of schematic dependency cycle"), *Schematic->GetPathName()));
+            TotalIssueCount++;
+        }
+    }
+
+    const double ElapsedMs = (FPlatformTime::Seconds() - StartTime) * 1000.0;
+    if (TotalIssueCount == 0) {
+        UE_LOG(LogContentRegistry, Display, TEXT("Validated %d registered objects in %.2fms, no issues found"), IssuesPerObject.Num(), ElapsedMs);
+        return 0;
+    }
+
+    UE_LOG(LogContentRegistry, Error, TEXT("---------------------------------------------"));
+    UE_LOG(LogContentRegistry, Error, TEXT("Found %d issues in registered content (validated %d objects in %.2fms):"), TotalIssueCount, IssuesPerObject.Num(), ElapsedMs);
+    for (const TPair<FName, TArray<FString>>& Pair : IssuesByMod) {
+        UE_LOG(LogContentRegistry, Error, TEXT("%s (%d issues):"), *Pair.Key.ToString(), Pair.Value.Num());
+        for (const FString& Issue : Pair.Value) {
+            UE_LOG(LogContentRegistry, Error, TEXT("  %s"), *Issue);
+        }
+    }
+    UE_LOG(LogContentRegistry, Error, TEXT("---------------------------------------------"));
+    return TotalIssueCount;
+}
+
 void AModContentRegistry::FreezeRegistryState() {
     checkf(!bIsRegistryFrozen, TEXT("Attempt to re-freeze already frozen registry"));
+    FPhaseTimelineScope TimelineScope(TEXT("ContentRegistry"), TEXT("Freeze"));
 
     UE_LOG(LogContentRegistry, Display, TEXT("Freezing content registry"));
     this->bIsRegistryFrozen = true;
+
+    if (CVarValidateRegistryOnFreeze.GetValueOnGameThread() != 0 || FSatisfactoryModLoader::GetSMLConfiguration().bDevelopmentMode) {
+        ValidateRegistryState();
+    }
 }
 
 void AModContentRegistry::EnsureRegistryUnfrozen() const {
@@ -219,28 +461,28 @@ void AModContentRegistry::EnsureRegistryUnfrozen() const {
 
 void AModContentRegistry::CheckSavedDataForMissingObjects() {
 	checkf(bIsRegistryFrozen, TEXT("CheckSavedDataForMissingObjects called before registry is frozen"));
+    FPhaseTimelineScope TimelineScope(TEXT("ContentRegistry"), TEXT("CheckSavedData"));
 
     AFGRecipeManager* RecipeManager = AFGRecipeManager::Get(this);
     AFGSchematicManager* SchematicManager = AFGSchematicManager::Get(this);
     AFGResearchManager* ResearchManager = AFGResearchManager::Get(this);
 
-    TArray<FMissingObjectStruct> MissingObjects;
-    TArray<FMissingObjectStruct> UnregisteredVanillaObjects;
+    MissingContentReport = FMissingContentReport{};
     if (ResearchManager != NULL) {
-        FindMissingResearchTrees(ResearchManager, MissingObjects, UnregisteredVanillaObjects);
+        FindMissingResearchTrees(ResearchManager, MissingContentReport);
     }
     if (SchematicManager != NULL) {
-        FindMissingSchematics(SchematicManager, MissingObjects, UnregisteredVanillaObjects);
+        FindMissingSchematics(SchematicManager, MissingContentReport);
     }
     if (RecipeManager != NULL) {
-        FindMissingRecipes(RecipeManager, MissingObjects, UnregisteredVanillaObjects);
+        FindMissingRecipes(RecipeManager, MissingContentReport);
     }
 
-    if (MissingObjects.Num() > 0) {
-        WarnAboutMissingObjects(MissingObjects);
+    if (MissingContentReport.MissingObjectsByMod.Num() > 0) {
+        WarnAboutMissingObjects(MissingContentReport);
     }
-    if (UnregisteredVanillaObjects.Num() > 0) {
-        WarnAboutUnregisteredVanillaObjects(UnregisteredVanillaObjects);
+    if (MissingContentReport.UnregisteredVanillaObjects.Num() > 0) {
+        WarnAboutUnregisteredVanillaObjects(MissingContentReport.UnregisteredVanillaObjects);
     }
 }
 
@@ -274,23 +516,41 @@ void AModContentRegistry::OnSchematicPurchased(TSubclassOf<UFGSchematic> Schemat
 }
 
 void AModContentRegistry::MarkItemDescriptorsFromRecipe(const TSubclassOf<UFGRecipe>& Recipe, const FName ModReference) {
-	TArray<FItemAmount> AllReferencedItems;
-	AllReferencedItems.Append(UFGRecipe::GetIngredients(Recipe));
-	AllReferencedItems.Append(UFGRecipe::GetProducts(Recipe));
+	MarkItemDescriptorsFromItemAmounts(Recipe, UFGRecipe::GetIngredients(Recipe), RecipeIngredientIndex, ModReference);
+	MarkItemDescriptorsFromItemAmounts(Recipe, UFGRecipe::GetProducts(Recipe), RecipeProductIndex, ModReference);
 
-	for (const FItemAmount& ItemAmount : AllReferencedItems) {
+	//Associate item registration info with this recipe. Recipes are only marked once, so we just need to skip
+	//items that are both ingredients and products of this recipe, no need to look through existing ReferencedBy entries
+	const TSet<UClass*>* IngredientItems = RecipeIngredientIndex.FindReferenced(Recipe);
+	const TSet<UClass*>* ProductItems = RecipeProductIndex.FindReferenced(Recipe);
+
+	if (IngredientItems != NULL) {
+		for (UClass* ItemDescriptor : *IngredientItems) {
+			ItemRegistryState.FindObject(ItemDescriptor)->ReferencedBy.Add(Recipe);
+		}
+	}
+	if (ProductItems != NULL) {
+		for (UClass* ItemDescriptor : *ProductItems) {
+			if (IngredientItems == NULL || !IngredientItems->Contains(ItemDescriptor)) {
+				ItemRegistryState.FindObject(ItemDescriptor)->ReferencedBy.Add(Recipe);
+			}
+		}
+	}
+}
+
+void AModContentRegistry::MarkItemDescriptorsFromItemAmounts(const TSubclassOf<UFGRecipe>& Recipe, const TArray<FItemAmount>& ItemAmounts,
+		TRegistryDependencyIndex<UFGRecipe, UFGItemDescriptor>& DependencyIndex, const FName ModReference) {
+	for (const FItemAmount& ItemAmount : ItemAmounts) {
 		const TSubclassOf<UFGItemDescriptor>& ItemDescriptor = ItemAmount.ItemClass;
 
 		CHECK_PROVIDED_OBJECT_VALID(ItemDescriptor, TEXT("Recipe '%s' registered by %s contains invalid NULL ItemDescriptor in it's Ingredients or Results"),
 				*Recipe->GetPathName(), *ModReference.ToString());
 
-		TSharedPtr<FItemRegistrationInfo> ItemRegistrationInfo = ItemRegistryState.FindObject(ItemDescriptor);
-		if (!ItemRegistrationInfo.IsValid()) {
+		if (!ItemRegistryState.ContainsObject(ItemDescriptor)) {
 			const FName OwnerModReference = FindContentOwnerFast(ItemDescriptor);
-			ItemRegistrationInfo = RegisterItemDescriptor(OwnerModReference, ModReference, ItemDescriptor);
+			RegisterItemDescriptor(OwnerModReference, ModReference, ItemDescriptor);
 		}
-		//Associate item registration info with this recipe
-		ItemRegistrationInfo->ReferencedBy.AddUnique(Recipe);
+		DependencyIndex.AddEdge(Recipe, ItemDescriptor);
 	}
 }
 
@@ -307,44 +567,51 @@ TSharedPtr<FItemRegistrationInfo> AModContentRegistry::RegisterItemDescriptor(co
 	return ItemRegistryState.RegisterObject(MakeRegistrationInfo<FItemRegistrationInfo>(ItemDescriptor, OwnerModReference, RegistrarModReference));
 }
 
-void AModContentRegistry::FindMissingSchematics(AFGSchematicManager* SchematicManager,
-                                                TArray<FMissingObjectStruct>& MissingObjects,
-                                                TArray<FMissingObjectStruct>& UnregisteredVanillaObjects) const {
-    //Clear references to unlocked schematics if they are not registered
-    TArray<TSubclassOf<UFGSchematic>> PurchasedSchematics = SchematicManager->mPurchasedSchematics;
-    for (const TSubclassOf<UFGSchematic> Schematic : PurchasedSchematics) {
-        if (!IsSchematicRegistered(Schematic)) {
-            if (!IsSchematicVanilla(Schematic)) {
-                MissingObjects.Add(FMissingObjectStruct{ TEXT("schematic"), Schematic->GetPathName() });
-                SchematicManager->mPurchasedSchematics.Remove(Schematic);
-            }
-            else {
-                UnregisteredVanillaObjects.Add(FMissingObjectStruct{ TEXT("schematic"), Schematic->GetPathName() });
-            }
+int32 FMissingContentReport::GetMissingObjectCount() const {
+    int32 MissingObjectCount = 0;
+    for (const TPair<FName, TArray<FMissingObjectStruct>>& Pair : MissingObjectsByMod) {
+        MissingObjectCount += Pair.Value.Num();
+    }
+    return MissingObjectCount;
+}
+
+bool AModContentRegistry::ReportUnregisteredObject(FMissingContentReport& Report, TSet<UClass*>& ReportedObjects, const TCHAR* ObjectType, UClass* Object, const bool bIsVanilla) {
+    //Savegame lists can reference the same object multiple times, but we only want to report it once
+    bool bIsAlreadyReported = false;
+    ReportedObjects.Add(Object, &bIsAlreadyReported);
+
+    if (!bIsAlreadyReported) {
+        if (bIsVanilla) {
+            Report.UnregisteredVanillaObjects.Add(FMissingObjectStruct{ObjectType, Object->GetPathName(), FACTORYGAME_MOD_NAME});
+        } else {
+            //Classes of removed mods cannot be loaded at all, so there is no owner we could figure out for them
+            const FName OwnerModReference = Object != NULL ? FName(*UBlueprintAssetHelperLibrary::FindPluginNameByObjectPath(Object->GetOuterUPackage()->GetName())) : NAME_None;
+            Report.MissingObjectsByMod.FindOrAdd(OwnerModReference).Add(FMissingObjectStruct{ObjectType, Object->GetPathName(), OwnerModReference});
         }
     }
+    return !bIsVanilla;
+}
+
+void AModContentRegistry::FindMissingSchematics(AFGSchematicManager* SchematicManager, FMissingContentReport& Report) const {
+    //Clear references to unlocked schematics if they are not registered
+    TSet<UClass*> ReportedSchematics;
+    SchematicManager->mPurchasedSchematics.RemoveAll([&](const TSubclassOf<UFGSchematic>& Schematic) {
+        return !IsSchematicRegistered(Schematic) &&
+            ReportUnregisteredObject(Report, ReportedSchematics, TEXT("schematic"), Schematic, IsSchematicVanilla(Schematic));
+    });
     //Do same thing for incomplete schematic progress
     SchematicManager->mPaidOffSchematic.RemoveAll([&](const FSchematicCost& SchematicCost) {
         return !IsSchematicRegistered(SchematicCost.Schematic) && !IsSchematicVanilla(SchematicCost.Schematic);
     });
 }
 
-void AModContentRegistry::FindMissingResearchTrees(AFGResearchManager* ResearchManager,
-                                                   TArray<FMissingObjectStruct>& MissingObjects,
-                                                   TArray<FMissingObjectStruct>& UnregisteredVanillaObjects) const {
+void AModContentRegistry::FindMissingResearchTrees(AFGResearchManager* ResearchManager, FMissingContentReport& Report) const {
     //Clear unlocked research trees
-    TArray<TSubclassOf<UFGResearchTree>> UnlockedResearchTrees = ResearchManager->mUnlockedResearchTrees;
-    for (const TSubclassOf<UFGResearchTree>& ResearchTree : UnlockedResearchTrees) {
-        if (!IsResearchTreeRegistered(ResearchTree)) {
-            if (!IsResearchTreeVanilla(ResearchTree)) {
-                ResearchManager->mUnlockedResearchTrees.Remove(ResearchTree);
-                MissingObjects.Add(FMissingObjectStruct{ TEXT("research_tree"), ResearchTree->GetPathName() });
-            }
-            else {
-                UnregisteredVanillaObjects.Add(FMissingObjectStruct{ TEXT("research_tree"), ResearchTree->GetPathName() });
-            }
-        }
-    }
+    TSet<UClass*> ReportedResearchTrees;
+    ResearchManager->mUnlockedResearchTrees.RemoveAll([&](const TSubclassOf<UFGResearchTree>& ResearchTree) {
+        return !IsResearchTreeRegistered(ResearchTree) &&
+            ReportUnregisteredObject(Report, ReportedResearchTrees, TEXT("research_tree"), ResearchTree, IsResearchTreeVanilla(ResearchTree));
+    });
 
     //Clear completed, but unclaimed researches
     ResearchManager->mCompletedResearch.RemoveAll([&](const FResearchData& ResearchData) {
@@ -359,29 +626,24 @@ void AModContentRegistry::FindMissingResearchTrees(AFGResearchManager* ResearchM
     });
 }
 
-void AModContentRegistry::FindMissingRecipes(AFGRecipeManager* RecipeManager,
-                                                   TArray<FMissingObjectStruct>& MissingObjects,
-                                                   TArray<FMissingObjectStruct>& UnregisteredVanillaObjects) const {
+void AModContentRegistry::FindMissingRecipes(AFGRecipeManager* RecipeManager, FMissingContentReport& Report) const {
     //Clear unlocked recipes
-    TArray<TSubclassOf<UFGRecipe>> UnlockedRecipes = RecipeManager->mAvailableRecipes;
-    for (const TSubclassOf<UFGRecipe>& Recipe : UnlockedRecipes) {
-        if (!IsRecipeRegistered(Recipe)) {
-            if (!IsRecipeVanilla(Recipe)) {
-                RecipeManager->mAvailableRecipes.Remove(Recipe);
-                MissingObjects.Add(FMissingObjectStruct{ TEXT("recipe"), Recipe->GetPathName() });
-            }
-            else {
-                UnregisteredVanillaObjects.Add(FMissingObjectStruct{ TEXT("recipe"), Recipe->GetPathName() });
-            }
-        }
-    }
+    TSet<UClass*> ReportedRecipes;
+    RecipeManager->mAvailableRecipes.RemoveAll([&](const TSubclassOf<UFGRecipe>& Recipe) {
+        return !IsRecipeRegistered(Recipe) &&
+            ReportUnregisteredObject(Report, ReportedRecipes, TEXT("recipe"), Recipe, IsRecipeVanilla(Recipe));
+    });
 }
 
-void AModContentRegistry::WarnAboutMissingObjects(const TArray<FMissingObjectStruct>& MissingObjects) {
+void AModContentRegistry::WarnAboutMissingObjects(const FMissingContentReport& Report) {
     UE_LOG(LogContentRegistry, Error, TEXT("---------------------------------------------"));
-    UE_LOG(LogContentRegistry, Error, TEXT("Found unregistered objects referenced in savegame:"));
-    for (const FMissingObjectStruct& ObjectStruct : MissingObjects) {
-        UE_LOG(LogContentRegistry, Error, TEXT("%s: %s"), *ObjectStruct.ObjectType, *ObjectStruct.ObjectPath);
+    UE_LOG(LogContentRegistry, Error, TEXT("Found %d unregistered objects referenced in savegame:"), Report.GetMissingObjectCount());
+    for (const TPair<FName, TArray<FMissingObjectStruct>>& Pair : Report.MissingObjectsByMod) {
+        const FString OwnerName = Pair.Key == NAME_None ? TEXT("Unknown (mod not loaded)") : Pair.Key.ToString();
+        UE_LOG(LogContentRegistry, Error, TEXT("%s (%d objects):"), *OwnerName, Pair.Value.Num());
+        for (const FMissingObjectStruct& ObjectStruct : Pair.Value) {
+            UE_LOG(LogContentRegistry, Error, TEXT("  %s: %s"), *ObjectStruct.ObjectType, *ObjectStruct.ObjectPath);
+        }
     }
     UE_LOG(LogContentRegistry, Error, TEXT("They will be cleared out"));
     UE_LOG(LogContentRegistry, Error, TEXT("---------------------------------------------"));
@@ -408,6 +670,7 @@ void AModContentRegistry::AddReferencedObjects(UObject* InThis, FReferenceCollec
 
 void AModContentRegistry::RegisterSchematic(const FName ModReference, const TSubclassOf<UFGSchematic> Schematic) {
 	CHECK_PROVIDED_OBJECT_VALID(Schematic, TEXT("Attempt to register NULL Schematic. Mod Reference: %s"), *ModReference.ToString());
+    FPhaseTimelineScope TimelineScope(TEXT("ContentRegistry"), TEXT("RegisterSchematic"), ModReference);
 
     if (!SchematicRegistryState.ContainsObject(Schematic)) {
         EnsureRegistryUnfrozen();
@@ -426,8 +689,11 @@ void AModContentRegistry::RegisterSchematic(const FName ModReference, const TSub
     			*Schematic->GetPathName(), *ModReference.ToString());
 
             RegisterRecipe(ModReference, Recipe);
-            const TSharedPtr<FRecipeRegistrationInfo> RecipeRegistrationInfo = RecipeRegistryState.FindObject(Recipe);
-            RecipeRegistrationInfo->ReferencedBy.Add(Schematic);
+            //Schematic can list the same recipe multiple times, only associate it once
+            if (SchematicRecipeIndex.AddEdge(Schematic, Recipe)) {
+                const TSharedPtr<FRecipeRegistrationInfo> RecipeRegistrationInfo = RecipeRegistryState.FindObject(Recipe);
+                RecipeRegistrationInfo->ReferencedBy.Add(Schematic);
+            }
         }
 
         //Process registration callback delegate
@@ -437,6 +703,7 @@ void AModContentRegistry::RegisterSchematic(const FName ModReference, const TSub
 
 void AModContentRegistry::RegisterResearchTree(const FName ModReference, const TSubclassOf<UFGResearchTree> ResearchTree) {
 	CHECK_PROVIDED_OBJECT_VALID(ResearchTree, TEXT("Attempt to register NULL ResearchTree. Mod Reference: %s"), *ModReference.ToString());
+    FPhaseTimelineScope TimelineScope(TEXT("ContentRegistry"), TEXT("RegisterResearchTree"), ModReference);
 
     if (!ResearchTreeRegistryState.ContainsObject(ResearchTree)) {
         EnsureRegistryUnfrozen();
@@ -455,8 +722,10 @@ void AModContentRegistry::RegisterResearchTree(const FName ModReference, const T
         		*ResearchTree->GetPathName(), *ModReference.ToString());
 
             RegisterSchematic(ModReference, Schematic);
-            const TSharedPtr<FSchematicRegistrationInfo> SchematicRegistrationInfo = SchematicRegistryState.FindObject(Schematic);
-            SchematicRegistrationInfo->ReferencedBy.Add(ResearchTree);
+            if (ResearchTreeSchematicIndex.AddEdge(ResearchTree, Schematic)) {
+                const TSharedPtr<FSchematicRegistrationInfo> SchematicRegistrationInfo = SchematicRegistryState.FindObject(Schematic);
+                SchematicRegistrationInfo->ReferencedBy.Add(ResearchTree);
+            }
         }
 
         //Process registration callback
@@ -466,6 +735,7 @@ void AModContentRegistry::RegisterResearchTree(const FName ModReference, const T
 
 void AModContentRegistry::RegisterRecipe(const FName ModReference, const TSubclassOf<UFGRecipe> Recipe) {
 	CHECK_PROVIDED_OBJECT_VALID(Recipe, TEXT("Attempt to register NULL Recipe. Mod Reference: %s"), *ModReference.ToString());
+    FPhaseTimelineScope TimelineScope(TEXT("ContentRegistry"), TEXT("RegisterRecipe"), ModReference);
 
     if (!RecipeRegistryState.ContainsObject(Recipe)) {
         EnsureRegistryUnfrozen();
@@ -525,6 +795,26 @@ TArray<FItemRegistrationInfo> AModContentRegistry::GetObtainableItemDescriptors(
     return OutRegistrationInfo;
 }
 
+int32 AModContentRegistry::GetRegisteredRecipesPage(int32 Offset, int32 Count, TArray<FRecipeRegistrationInfo>& OutRecipes) const {
+    RecipeRegistryState.GetObjectsPage(Offset, Count, OutRecipes);
+    return RecipeRegistryState.GetAllObjects().Num();
+}
+
+int32 AModContentRegistry::GetRegisteredSchematicsPage(int32 Offset, int32 Count, TArray<FSchematicRegistrationInfo>& OutSchematics) const {
+    SchematicRegistryState.GetObjectsPage(Offset, Count, OutSchematics);
+    return SchematicRegistryState.GetAllObjects().Num();
+}
+
+int32 AModContentRegistry::GetRegisteredResearchTreesPage(int32 Offset, int32 Count, TArray<FResearchTreeRegistrationInfo>& OutResearchTrees) const {
+    ResearchTreeRegistryState.GetObjectsPage(Offset, Count, OutResearchTrees);
+    return ResearchTreeRegistryState.GetAllObjects().Num();
+}
+
+int32 AModContentRegistry::GetItemDescriptorsPage(int32 Offset, int32 Count, TArray<FItemRegistrationInfo>& OutItemDescriptors) const {
+    ItemRegistryState.GetObjectsPage(Offset, Count, OutItemDescriptors);
+    return ItemRegistryState.GetAllObjects().Num();
+}
+
 FItemRegistrationInfo AModContentRegistry::GetItemDescriptorInfo(const TSubclassOf<UFGItemDescriptor> ItemDescriptor) {
 	//Remove blank registration info if provided item descriptor is not valid
 	if (!IsValid(ItemDescriptor)) {
@@ -544,8 +834,10 @@ FItemRegistrationInfo AModContentRegistry::GetItemDescriptorInfo(const TSubclass
 
 AModContentRegistry::AModContentRegistry() {
     bIsRegistryFrozen = false;
-    SchematicManagerInternalState = -1;
-    ResearchManagerInternalState = -1;
+    SchematicManagerFlushedCount = INDEX_NONE;
+    ResearchManagerFlushedCount = INDEX_NONE;
+    bPendingResearchTreeUpdate = false;
+    bPendingSchematicAvailabilityUpdate = false;
     bSubscribedToSchematicManager = false;
     PrimaryActorTick.bCanEverTick = true;
 	ActiveScriptFramePtr = NULL;
@@ -588,12 +880,14 @@ void AModContentRegistry::Tick(float DeltaSeconds) {
     AFGSchematicManager* SchematicManager = AFGSchematicManager::Get(this);
     AFGResearchManager* ResearchManager = AFGResearchManager::Get(this);
 
-    if (SchematicManager != NULL) {
-        const int64 SchematicRegistryCounter = SchematicRegistryState.GetRegistrationCounter();
+    //Late registrations are flushed within the frame time budget, the initial flush is always done at once
+    //so managers are never observed with only part of the content registered
+    const float FlushBudgetMs = CVarRegistryFlushBudgetMs.GetValueOnGameThread();
+    const double FlushDeadline = FlushBudgetMs > 0.0f ? FPlatformTime::Seconds() + FlushBudgetMs / 1000.0 : 0.0;
 
-        if (SchematicRegistryCounter > SchematicManagerInternalState) {
-            FlushStateToSchematicManager(SchematicManager);
-            SchematicManagerInternalState = SchematicRegistryCounter;
+    if (SchematicManager != NULL) {
+        if (SchematicManagerFlushedCount != SchematicRegistryState.GetAllObjects().Num()) {
+            FlushStateToSchematicManager(SchematicManager, SchematicManagerFlushedCount == INDEX_NONE ? 0.0 : FlushDeadline);
         }
 
         if (!bSubscribedToSchematicManager) {
@@ -603,35 +897,36 @@ void AModContentRegistry::Tick(float DeltaSeconds) {
     }
 
     if (ResearchManager != NULL) {
-        const int64 ResearchTreeRegistryCounter = ResearchTreeRegistryState.GetRegistrationCounter();
-
-        if (ResearchTreeRegistryCounter > ResearchManagerInternalState) {
-            FlushStateToResearchManager(ResearchManager);
-            ResearchManagerInternalState = ResearchTreeRegistryCounter;
+        if (ResearchManagerFlushedCount != ResearchTreeRegistryState.GetAllObjects().Num() &&
+            (ResearchManagerFlushedCount == INDEX_NONE || !IsFlushDeadlineReached(FlushDeadline))) {
+            FlushStateToResearchManager(ResearchManager, ResearchManagerFlushedCount == INDEX_NONE ? 0.0 : FlushDeadline);
         }
     }
 
-	if (PendingItemSinkPointsRegistrations.Num()) {
-		FlushPendingResourceSinkRegistrations();
+	if (PendingItemSinkPointsRegistrations.Num() && !IsFlushDeadlineReached(FlushDeadline)) {
+		FlushPendingResourceSinkRegistrations(FlushDeadline);
 	}
 }
 
-void AModContentRegistry::FlushPendingResourceSinkRegistrations() {
+void AModContentRegistry::FlushPendingResourceSinkRegistrations(const double FlushDeadline) {
 	AFGResourceSinkSubsystem* ResourceSinkSubsystem = AFGResourceSinkSubsystem::Get(this);
 
 	if (ResourceSinkSubsystem != NULL) {
-		for (const TPair<UDataTable*, FName>& Pair : PendingItemSinkPointsRegistrations) {
-			UE_LOG(LogContentRegistry, Log, TEXT("Registering Resource Sink Points Table '%s' from Mod %s"), *Pair.Key->GetPathName(), *Pair.Value.ToString());;
-
-			TArray<FResourceSinkPointsData*> OutModPointsData;
-			Pair.Key->GetAllRows(TEXT("ResourceSinkPointsData"), OutModPointsData);
-			for (FResourceSinkPointsData* ModItemRow : OutModPointsData) {
-				int32 Points = FMath::Max(ModItemRow->Points, ModItemRow->OverriddenResourceSinkPoints);
-				ResourceSinkSubsystem->mResourceSinkPoints.Add(ModItemRow->ItemClass, Points);
+		//Tables are flushed one by one, so the remaining ones are picked up on the next frame when we run out of time
+		for (TMap<UDataTable*, FName>::TIterator It = PendingItemSinkPointsRegistrations.CreateIterator(); It; ++It) {
+			UE_LOG(LogContentRegistry, Log, TEXT("Registering Resource Sink Points Table '%s' from Mod %s"), *It.Key()->GetPathName(), *It.Value().ToString());
+
+			//Iterate rows in place instead of collecting them into an intermediate array first
+			It.Key()->ForeachRow<FResourceSinkPointsData>(TEXT("ResourceSinkPointsData"), [&](const FName& RowName, const FResourceSinkPointsData& ModItemRow) {
+				const int32 Points = FMath::Max(ModItemRow.Points, ModItemRow.OverriddenResourceSinkPoints);
+				ResourceSinkSubsystem->mResourceSinkPoints.Add(ModItemRow.ItemClass, Points);
+			});
+			It.RemoveCurrent();
+
+			if (IsFlushDeadlineReached(FlushDeadline)) {
+				break;
 			}
 		}
-
-		PendingItemSinkPointsRegistrations.Empty();
 	}
 }
 
@@ -4,9 +4,60 @@
 #include "FGOptionsSettings.h"
 #include "GameFramework/InputSettings.h"
 
-void UModKeyBindRegistry::RegisterModKeyBind(const FString& ModReference, FInputActionKeyMapping KeyMapping, const FText& DisplayName) {
-    UInputSettings* InputSettings = UInputSettings::GetInputSettings();
-    UFGOptionsSettings* OptionsSettings = GetMutableDefault<UFGOptionsSettings>();
+/**
+ * Hashed view of the user changed and already registered key mappings, built once per registration batch
+ * so every registered binding is a few map lookups instead of the scan over all of the mappings
+ * Mappings are added without rebuilding keymaps, and keymaps are rebuilt once the batch is finished
+ */
+class FModKeyBindRegistrationBatch {
+public:
+    FModKeyBindRegistrationBatch() {
+        InputSettings = UInputSettings::GetInputSettings();
+        OptionsSettings = GetMutableDefault<UFGOptionsSettings>();
+
+        //User settings return a copy of the mappings array, so only retrieve it once
+        UFGGameUserSettings* UserSettings = UFGGameUserSettings::GetFGGameUserSettings();
+        for (const FFGKeyMapping& KeyMap : UserSettings->GetKeyMappings()) {
+            if (KeyMap.IsAxisMapping) {
+                if (KeyMap.AxisKeyMapping.Scale > 0) UserPositiveAxisMappings.Add(KeyMap.AxisKeyMapping.AxisName, KeyMap.AxisKeyMapping);
+                if (KeyMap.AxisKeyMapping.Scale < 0) UserNegativeAxisMappings.Add(KeyMap.AxisKeyMapping.AxisName, KeyMap.AxisKeyMapping);
+            } else if (!UserActionMappings.Contains(KeyMap.ActionKeyMapping.ActionName)) {
+                UserActionMappings.Add(KeyMap.ActionKeyMapping.ActionName, KeyMap.ActionKeyMapping);
+            }
+        }
+        for (const FInputActionKeyMapping& Mapping : InputSettings->GetActionMappings()) {
+            RegisteredActionMappings.FindOrAdd(Mapping.ActionName).Add(Mapping);
+        }
+        for (const FInputAxisKeyMapping& Mapping : InputSettings->GetAxisMappings()) {
+            RegisteredAxisMappings.FindOrAdd(Mapping.AxisName).Add(Mapping);
+        }
+    }
+
+    void RegisterKeyBind(const FString& ModReference, FInputActionKeyMapping KeyMapping, const FText& DisplayName);
+    void RegisterAxisBind(const FString& ModReference, FInputAxisKeyMapping PositiveAxisMapping, FInputAxisKeyMapping NegativeAxisMapping, const FText& PositiveDisplayName, const FText& NegativeDisplayName);
+
+    /** Rebuilds keymaps of all active PlayerInput objects if any mappings have been added */
+    void Finish() {
+        if (bMappingsChanged) {
+            InputSettings->ForceRebuildKeymaps();
+            bMappingsChanged = false;
+        }
+    }
+private:
+    UInputSettings* InputSettings;
+    UFGOptionsSettings* OptionsSettings;
+
+    TMap<FName, FInputActionKeyMapping> UserActionMappings;
+    TMap<FName, FInputAxisKeyMapping> UserPositiveAxisMappings;
+    TMap<FName, FInputAxisKeyMapping> UserNegativeAxisMappings;
+
+    //There are at most 2 mappings with the same name, one keyboard and one gamepad
+    TMap<FName, TArray<FInputActionKeyMapping, TInlineAllocator<2>>> RegisteredActionMappings;
+    TMap<FName, TArray<FInputAxisKeyMapping, TInlineAllocator<2>>> RegisteredAxisMappings;
+    bool bMappingsChanged = false;
+};
+
+void FModKeyBindRegistrationBatch::RegisterKeyBind(const FString& ModReference, FInputActionKeyMapping KeyMapping, const FText& DisplayName) {
     const FString ModPrefix = FString::Printf(TEXT("%s."), *ModReference);
 
     //Ensure that we are prefixed by ModReference to allow unique identification
@@ -14,22 +65,16 @@ void UModKeyBindRegistry::RegisterModKeyBind(const FString& ModReference, FInput
     checkf(ActionName.StartsWith(ModPrefix), TEXT("RegisterModKeyBind called with ActionName not being prefixed by ModReference"));
 
     //Try to find changed user settings for the key bind
-    UFGGameUserSettings* UserSettings = UFGGameUserSettings::GetFGGameUserSettings();
-    for (const FFGKeyMapping& KeyMap : UserSettings->GetKeyMappings()) {
-        if (KeyMap.IsAxisMapping) continue;
-        if (KeyMap.ActionKeyMapping.ActionName == KeyMapping.ActionName) {
-            KeyMapping = KeyMap.ActionKeyMapping;
-            break;
-        }
+    if (const FInputActionKeyMapping* UserKeyMapping = UserActionMappings.Find(KeyMapping.ActionName)) {
+        KeyMapping = *UserKeyMapping;
     }
-    
+
     //Check for uniqueness. We want mapping registered only one time
-    TArray<FInputActionKeyMapping> MappingsAlreadyRegistered;
-    InputSettings->GetActionMappingByName(KeyMapping.ActionName, MappingsAlreadyRegistered);
+    TArray<FInputActionKeyMapping, TInlineAllocator<2>>& MappingsAlreadyRegistered = RegisteredActionMappings.FindOrAdd(KeyMapping.ActionName);
     if (MappingsAlreadyRegistered.Contains(KeyMapping)) {
         return;
     }
-    
+
     //If we already have non-gamepad/gamepad mapping registered, don't register this one
     //This is because FactoryGame currently can only differentiate 2 mappings with same action name currently:
     //One should be bound to gamepad (and be not editable in controls), and other should be not-gamepad,
@@ -40,11 +85,13 @@ void UModKeyBindRegistry::RegisterModKeyBind(const FString& ModReference, FInput
         if (bIsGamePadKey == bIsOtherGamePadKey)
             return; //Disallow registering 2 mappings with same type
     }
-    
+
     //Either we don't have registered mapping, or it is of different type at this point
-    //We can add it now, and calling AddActionMapping will also update all active PlayerInput objects
-    InputSettings->AddActionMapping(KeyMapping);
-    
+    //Keymaps of active PlayerInput objects are rebuilt once the whole batch is registered
+    InputSettings->AddActionMapping(KeyMapping, false);
+    MappingsAlreadyRegistered.Add(KeyMapping);
+    bMappingsChanged = true;
+
     //Only register display name for non-gamepad mappings, because
     //FactoryGame option slider currently only supports 1 key per 1 action, and it
     //should be non-gamepad action key mapping
@@ -65,9 +112,7 @@ void PerformChecksForModAxisBindings(const FInputAxisKeyMapping& PositiveAxisMap
     checkf(PositiveAxisMapping.Key.IsGamepadKey() == NegativeAxisMapping.Key.IsGamepadKey(), TEXT("Negative and Positive mappings should be same type"));
 }
 
-void UModKeyBindRegistry::RegisterModAxisBind(const FString& ModReference, FInputAxisKeyMapping PositiveAxisMapping, FInputAxisKeyMapping NegativeAxisMapping, const FText& PositiveDisplayName, const FText& NegativeDisplayName) {
-    UInputSettings* InputSettings = UInputSettings::GetInputSettings();
-    UFGOptionsSettings* OptionsSettings = GetMutableDefault<UFGOptionsSettings>();
+void FModKeyBindRegistrationBatch::RegisterAxisBind(const FString& ModReference, FInputAxisKeyMapping PositiveAxisMapping, FInputAxisKeyMapping NegativeAxisMapping, const FText& PositiveDisplayName, const FText& NegativeDisplayName) {
     const FString ModPrefix = FString::Printf(TEXT("%s."), *ModReference);
 
     //Just like with action mapping, check that both axis names start with mod prefix
@@ -76,18 +121,15 @@ void UModKeyBindRegistry::RegisterModAxisBind(const FString& ModReference, FInpu
     PerformChecksForModAxisBindings(PositiveAxisMapping, NegativeAxisMapping);
 
     //Try to find changed user settings for the key bind
-    UFGGameUserSettings* UserSettings = UFGGameUserSettings::GetFGGameUserSettings();
-    for (const FFGKeyMapping& KeyMap : UserSettings->GetKeyMappings()) {
-        if (!KeyMap.IsAxisMapping) continue;
-        if (KeyMap.AxisKeyMapping.AxisName == PositiveAxisMapping.AxisName) {
-            if (KeyMap.AxisKeyMapping.Scale > 0) PositiveAxisMapping = KeyMap.AxisKeyMapping;
-            if (KeyMap.AxisKeyMapping.Scale < 0) NegativeAxisMapping = KeyMap.AxisKeyMapping;
-        }
+    if (const FInputAxisKeyMapping* UserPositiveAxisMapping = UserPositiveAxisMappings.Find(PositiveAxisMapping.AxisName)) {
+        PositiveAxisMapping = *UserPositiveAxisMapping;
+    }
+    if (const FInputAxisKeyMapping* UserNegativeAxisMapping = UserNegativeAxisMappings.Find(PositiveAxisMapping.AxisName)) {
+        NegativeAxisMapping = *UserNegativeAxisMapping;
     }
 
     //Ensure we don't have duplicate axis mappings already registered
-    TArray<FInputAxisKeyMapping> MappingsAlreadyRegistered;
-    InputSettings->GetAxisMappingByName(PositiveAxisMapping.AxisName, MappingsAlreadyRegistered);
+    TArray<FInputAxisKeyMapping, TInlineAllocator<2>>& MappingsAlreadyRegistered = RegisteredAxisMappings.FindOrAdd(PositiveAxisMapping.AxisName);
     if (MappingsAlreadyRegistered.Contains(PositiveAxisMapping) ||
         MappingsAlreadyRegistered.Contains(NegativeAxisMapping)) {
         return;
@@ -102,8 +144,11 @@ void UModKeyBindRegistry::RegisterModAxisBind(const FString& ModReference, FInpu
     }
 
     //Register both axis bindings
-    InputSettings->AddAxisMapping(PositiveAxisMapping);
-    InputSettings->AddAxisMapping(NegativeAxisMapping);
+    InputSettings->AddAxisMapping(PositiveAxisMapping, false);
+    InputSettings->AddAxisMapping(NegativeAxisMapping, false);
+    MappingsAlreadyRegistered.Add(PositiveAxisMapping);
+    MappingsAlreadyRegistered.Add(NegativeAxisMapping);
+    bMappingsChanged = true;
 
     //Only register display name for non-gamepad mappings, same reason as for keys
     if (!bIsGamePadKey) {
@@ -115,3 +160,43 @@ void UModKeyBindRegistry::RegisterModAxisBind(const FString& ModReference, FInpu
     }
 }
 
+FModKeyBindRegistrationBatch* UModKeyBindRegistry::ActiveBatch = NULL;
+
+FScopedModKeyBindBatch::FScopedModKeyBindBatch() : bOwnsBatch(false) {
+    check(IsInGameThread());
+    //Nested scopes join the outermost batch, so keymaps are only rebuilt once the outermost scope ends
+    if (UModKeyBindRegistry::ActiveBatch == NULL) {
+        UModKeyBindRegistry::ActiveBatch = new FModKeyBindRegistrationBatch();
+        bOwnsBatch = true;
+    }
+}
+
+FScopedModKeyBindBatch::~FScopedModKeyBindBatch() {
+    if (bOwnsBatch) {
+        FModKeyBindRegistrationBatch* RegistrationBatch = UModKeyBindRegistry::ActiveBatch;
+        UModKeyBindRegistry::ActiveBatch = NULL;
+        RegistrationBatch->Finish();
+        delete RegistrationBatch;
+    }
+}
+
+//Single registrations are batches of one binding, so registration rules only live in FModKeyBindRegistrationBatch
+void UModKeyBindRegistry::RegisterModKeyBind(const FString& ModReference, FInputActionKeyMapping KeyMapping, const FText& DisplayName) {
+    FScopedModKeyBindBatch BatchScope;
+    ActiveBatch->RegisterKeyBind(ModReference, KeyMapping, DisplayName);
+}
+
+void UModKeyBindRegistry::RegisterModAxisBind(const FString& ModReference, FInputAxisKeyMapping PositiveAxisMapping, FInputAxisKeyMapping NegativeAxisMapping, const FText& PositiveDisplayName, const FText& NegativeDisplayName) {
+    FScopedModKeyBindBatch BatchScope;
+    ActiveBatch->RegisterAxisBind(ModReference, PositiveAxisMapping, NegativeAxisMapping, PositiveDisplayName, NegativeDisplayName);
+}
+
+void UModKeyBindRegistry::RegisterModKeyBinds(const FString& ModReference, const TArray<FModKeyBindRegistration>& KeyBinds, const TArray<FModAxisBindRegistration>& AxisBinds) {
+    FScopedModKeyBindBatch BatchScope;
+    for (const FModKeyBindRegistration& KeyBind : KeyBinds) {
+        ActiveBatch->RegisterKeyBind(ModReference, KeyBind.KeyMapping, KeyBind.DisplayName);
+    }
+    for (const FModAxisBindRegistration& AxisBind : AxisBinds) {
+        ActiveBatch->RegisterAxisBind(ModReference, AxisBind.PositiveAxisMapping, AxisBind.NegativeAxisMapping, AxisBind.PositiveDisplayName, AxisBind.NegativeDisplayName);
+    }
+}
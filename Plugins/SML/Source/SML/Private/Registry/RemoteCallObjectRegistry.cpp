@@ -1,15 +1,39 @@
 #include "Registry/RemoteCallObjectRegistry.h"
 #include "FGGameMode.h"
 #include "Player/SMLRemoteCallObject.h"
+#include "Player/ModRemoteCallChannel.h"
+#include "Misc/Crc.h"
 #include "GameFramework/GameModeBase.h"
 
+DEFINE_LOG_CATEGORY(LogRemoteCallObjectRegistry);
+
 void URemoteCallObjectRegistry::RegisterRemoteCallObject(TSubclassOf<UFGRemoteCallObject> RemoteCallObject) {
     check(RemoteCallObject);
     RegisteredRCOs.AddUnique(RemoteCallObject);
 }
 
+uint32 URemoteCallObjectRegistry::RegisterModRemoteCall(const FString& ModReference, const FString& CallName, EModRemoteCallMode Mode, EModRemoteCallDirection Direction, const FOnModRemoteCallReceived& OnReceived) {
+    const FString QualifiedCallName = FString::Printf(TEXT("%s:%s"), *ModReference, *CallName);
+    const uint32 CallId = FCrc::StrCrc32(*QualifiedCallName);
+    if (CallId == InvalidModRemoteCallId) {
+        UE_LOG(LogRemoteCallObjectRegistry, Error, TEXT("Mod remote call %s hashes to the reserved id, it should be renamed"), *QualifiedCallName);
+        return InvalidModRemoteCallId;
+    }
+
+    //Colliding calls can belong to unrelated mods, so only the call registered later is rejected instead of crashing the game
+    const FModRemoteCall* ExistingCall = ModRemoteCalls.Find(CallId);
+    if (ExistingCall != NULL) {
+        UE_LOG(LogRemoteCallObjectRegistry, Error, TEXT("Rejected mod remote call %s, its id %u is already taken by %s"), *QualifiedCallName, CallId, *ExistingCall->Name);
+        return InvalidModRemoteCallId;
+    }
+    ModRemoteCalls.Add(CallId, FModRemoteCall{QualifiedCallName, Mode, Direction, OnReceived});
+    UE_LOG(LogRemoteCallObjectRegistry, Display, TEXT("Registered mod remote call %s"), *QualifiedCallName);
+    return CallId;
+}
+
 void URemoteCallObjectRegistry::Initialize(FSubsystemCollectionBase& Collection) {
     RegisterRemoteCallObject(USMLRemoteCallObject::StaticClass());
+    RegisterRemoteCallObject(UModRemoteCallChannel::StaticClass());
 }
 
 void URemoteCallObjectRegistry::RegisterRCOsOnGameMode(AGameModeBase* GameMode) {
@@ -25,4 +49,7 @@ void URemoteCallObjectRegistry::RegisterRCOsOnGameMode(AGameModeBase* GameMode)
 
 void URemoteCallObjectRegistry::InitializePatches() {
     FGameModeEvents::GameModeInitializedEvent.AddStatic(URemoteCallObjectRegistry::RegisterRCOsOnGameMode);
+    
+    //Mod remote calls are batched until the net update, which happens right after the actors have been ticked
+    FWorldDelegates::OnWorldPostActorTick.AddStatic(UModRemoteCallChannel::FlushChannelsOfWorld);
 }
@@ -110,9 +110,6 @@ void FSatisfactoryModLoader::RegisterSubsystemPatches() {
     //Register SML chat commands subsystem patch (should actually be in CommandSubsystem i guess)
     USMLRemoteCallObject::RegisterChatCommandPatch();
 
-    //Initialize network manager handling mod packets
-    UModNetworkHandler::InitializePatches();
-
     //Initialize tooltip handler
     UItemTooltipSubsystem::InitializePatches();
 
@@ -5,6 +5,24 @@
 #include "ModLoading/ModLoadingLibrary.h"
 
 void UBlueprintAssetHelperLibrary::FindBlueprintAssetsByTag(UClass* BaseClass, const FName TagName, const TArray<FString>& TagValues, TArray<UClass*>& FoundAssets) {
+	TArray<FSoftClassPath> ClassPaths;
+	FindBlueprintAssetClassPathsByTag(TagName, TagValues, ClassPaths);
+
+	for (const FSoftClassPath& ClassPath : ClassPaths) {
+		//Load UBlueprintGeneratedClass for provided object and make sure it has been loaded
+		UClass* ClassObject = LoadObject<UClass>(NULL, *ClassPath.ToString());
+		if (ClassObject == NULL) {
+			continue;
+		}
+
+		//Verify that generated class is actually a child of the base class, and then add it to the list
+		if (ClassObject->IsChildOf(BaseClass)) {
+			FoundAssets.Add(ClassObject);
+		}
+	}
+}
+
+void UBlueprintAssetHelperLibrary::FindBlueprintAssetClassPathsByTag(const FName TagName, const TArray<FString>& TagValues, TArray<FSoftClassPath>& OutClassPaths) {
 	
 	//Collect asset tag values into the multi map
 	TMultiMap<FName, FString> RequiredTagsMap;
@@ -36,17 +54,7 @@ void UBlueprintAssetHelperLibrary::FindBlueprintAssetsByTag(UClass* BaseClass, c
 		if (!FPackageName::ParseExportTextPath(GeneratedClassExportedPath, NULL, &GeneratedClassPath)) {
 			continue;
 		}
-
-		//Load UBlueprintGeneratedClass for provided object and make sure it has been loaded
-		UClass* ClassObject = LoadObject<UClass>(NULL, *GeneratedClassPath);
-		if (ClassObject == NULL) {
-			continue;
-		}
-
-		//Verify that generated class is actually a child of the base class, and then add it to the list
-		if (ClassObject->IsChildOf(BaseClass)) {
-			FoundAssets.Add(ClassObject);
-		}
+		OutClassPaths.Add(FSoftClassPath(GeneratedClassPath));
 	}
 }
 
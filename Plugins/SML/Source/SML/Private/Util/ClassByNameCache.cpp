@@ -0,0 +1,103 @@
+#include "Util/ClassByNameCache.h"
+#include "Misc/ScopeLock.h"
+#include "UObject/ObjectRedirector.h"
+
+FClassByNameCache::FClassByNameCache() : bListenersRegistered(true) {
+	GUObjectArray.AddUObjectCreateListener(this);
+}
+
+FClassByNameCache& FClassByNameCache::Get() {
+	static FClassByNameCache ClassByNameCache;
+	return ClassByNameCache;
+}
+
+UClass* FClassByNameCache::FindClassByName(const FString& ClassName) {
+	if (ClassName.Len() == 0) {
+		return nullptr;
+	}
+	//Name that is not in the name table cannot belong to any object, so we can bail out without touching the object hash
+	const FName ClassFName(*ClassName, FNAME_Find);
+	if (ClassFName.IsNone()) {
+		return nullptr;
+	}
+	{
+		FScopeLock ScopeLock(&CacheLock);
+		if (UClass* CachedClass = FindCachedClassLocked(ClassFName)) {
+			return CachedClass;
+		}
+	}
+
+	//Object hash lookup is done without holding the lock, so redirectors created meanwhile on other threads are not blocked by it
+	bool bResolvedThroughRedirector = false;
+	UClass* Result = ResolveClassByName(ClassName, bResolvedThroughRedirector);
+	if (Result != nullptr) {
+		FScopeLock ScopeLock(&CacheLock);
+		CachedClasses.Add(ClassFName, FCachedClass{Result, bResolvedThroughRedirector});
+	}
+	return Result;
+}
+
+void FClassByNameCache::FindClassesByName(const TArray<FString>& ClassNames, TArray<UClass*>& OutClasses) {
+	OutClasses.Reset(ClassNames.Num());
+	TArray<int32> UnresolvedIndices;
+	{
+		//Cached names are resolved under a single lock, and only the misses are looked up afterwards
+		FScopeLock ScopeLock(&CacheLock);
+		for (const FString& ClassName : ClassNames) {
+			const FName ClassFName = ClassName.Len() ? FName(*ClassName, FNAME_Find) : NAME_None;
+			UClass* CachedClass = ClassFName.IsNone() ? nullptr : FindCachedClassLocked(ClassFName);
+			if (CachedClass == nullptr && !ClassFName.IsNone()) {
+				UnresolvedIndices.Add(OutClasses.Num());
+			}
+			OutClasses.Add(CachedClass);
+		}
+	}
+	for (const int32 Index : UnresolvedIndices) {
+		OutClasses[Index] = FindClassByName(ClassNames[Index]);
+	}
+}
+
+void FClassByNameCache::Reset() {
+	FScopeLock ScopeLock(&CacheLock);
+	CachedClasses.Empty();
+}
+
+UClass* FClassByNameCache::FindCachedClassLocked(FName ClassName) {
+	if (const FCachedClass* CachedClass = CachedClasses.Find(ClassName)) {
+		UClass* Class = CachedClass->Class.Get();
+		//Class could have been renamed without leaving a redirector behind, so verify it's name for direct matches
+		if (Class != nullptr && (CachedClass->bResolvedThroughRedirector || Class->GetFName() == ClassName)) {
+			return Class;
+		}
+		CachedClasses.Remove(ClassName);
+	}
+	return nullptr;
+}
+
+UClass* FClassByNameCache::ResolveClassByName(const FString& ClassName, bool& bOutResolvedThroughRedirector) {
+	if (UClass* Result = FindObject<UClass>(ANY_PACKAGE, *ClassName, false)) {
+		bOutResolvedThroughRedirector = false;
+		return Result;
+	}
+	if (UObjectRedirector* RenamedClassRedirector = FindObject<UObjectRedirector>(ANY_PACKAGE, *ClassName, true)) {
+		bOutResolvedThroughRedirector = true;
+		return CastChecked<UClass>(RenamedClassRedirector->DestinationObject);
+	}
+	return nullptr;
+}
+
+void FClassByNameCache::NotifyUObjectCreated(const UObjectBase* Object, int32 Index) {
+	//Class lookup prefers direct matches over redirectors, but redirector created for the renamed class takes over it's old name
+	if (Object->GetClass() == UObjectRedirector::StaticClass()) {
+		FScopeLock ScopeLock(&CacheLock);
+		CachedClasses.Remove(Object->GetFName());
+	}
+}
+
+void FClassByNameCache::OnUObjectArrayShutdown() {
+	if (bListenersRegistered) {
+		GUObjectArray.RemoveUObjectCreateListener(this);
+		bListenersRegistered = false;
+	}
+	Reset();
+}
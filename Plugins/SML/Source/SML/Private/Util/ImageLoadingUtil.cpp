@@ -5,50 +5,87 @@
 #include "IImageWrapperModule.h"
 #include "Modules/ModuleManager.h"
 
-UTexture2D* FImageLoadingUtil::LoadImageFromByteArray(const TArray<uint8>& InByteArray, FString& OutErrorMessage) {
-	IImageWrapperModule& ImageWrapperModule = FModuleManager::LoadModuleChecked<IImageWrapperModule>(FName("ImageWrapper"));
+static const FName ImageWrapperModuleName = TEXT("ImageWrapper");
+
+void FImageLoadingUtil::EnsureImageWrapperModuleLoaded() {
+	FModuleManager::LoadModuleChecked<IImageWrapperModule>(ImageWrapperModuleName);
+}
+
+bool FImageLoadingUtil::DecodeImageFromByteArray(const TArray<uint8>& InByteArray, FDecodedImage& OutImage, FString& OutErrorMessage) {
+	//Module has to be loaded on the game thread already, so we only retrieve it here
+	IImageWrapperModule& ImageWrapperModule = FModuleManager::GetModuleChecked<IImageWrapperModule>(ImageWrapperModuleName);
 	const EImageFormat ImageFormat = ImageWrapperModule.DetectImageFormat(InByteArray.GetData(), InByteArray.Num());
 
 	//Malformed image file - unknown image format
 	if (ImageFormat == EImageFormat::Invalid) {
 		OutErrorMessage = TEXT("Unknown or invalid image format");
-		return NULL;
+		return false;
 	}
 	
 	const TSharedPtr<IImageWrapper> ImageWrapper = ImageWrapperModule.CreateImageWrapper(ImageFormat);
 	//Malformed image file - unexpected data format
 	if (!ImageWrapper.IsValid() || !ImageWrapper->SetCompressed(InByteArray.GetData(), InByteArray.Num())) {
 		OutErrorMessage = TEXT("Malformed image data (invalid compressed data)");
-		return NULL;
+		return false;
 	}
 
 	//Data equal to EPixelFormat::PF_B8G8R8A8 used below - BGRA, 8 bits depth
 	//Malformed image file - decompression failed
-	TArray<uint8> UncompressedBGRA;
-	if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, UncompressedBGRA)) {
+	if (!ImageWrapper->GetRaw(ERGBFormat::BGRA, 8, OutImage.BGRAData)) {
 		OutErrorMessage = TEXT("Malformed image data (decompression failed)");
-		return NULL;
+		return false;
+	}
+	OutImage.Width = ImageWrapper->GetWidth();
+	OutImage.Height = ImageWrapper->GetHeight();
+	return true;
+}
+
+bool FImageLoadingUtil::DecodeImageFromFile(const FString& FilePath, FDecodedImage& OutImage, FString& OutErrorMessage) {
+	TArray<uint8> RawFileContents;
+	//Failed to load image from the file
+	if (!FFileHelper::LoadFileToArray(RawFileContents, *FilePath)) {
+		OutErrorMessage = TEXT("Failed to open image file");
+		return false;
 	}
+	return DecodeImageFromByteArray(RawFileContents, OutImage, OutErrorMessage);
+}
+
+UTexture2D* FImageLoadingUtil::CreateTextureFromDecodedImage(const FDecodedImage& Image, FString& OutErrorMessage) {
+	check(IsInGameThread());
 	
-	//Create transient texture with size known from image wrapper
-	UTexture2D* TextureObject = UTexture2D::CreateTransient(ImageWrapper->GetWidth(), ImageWrapper->GetHeight(), EPixelFormat::PF_B8G8R8A8);
+	//Create transient texture with size known from decoded image
+	UTexture2D* TextureObject = UTexture2D::CreateTransient(Image.Width, Image.Height, EPixelFormat::PF_B8G8R8A8);
 	if (!TextureObject) {
 		OutErrorMessage = TEXT("Texture2D object allocation failure");
 		return NULL;
 	}
 	
-	//Add texture to root set so it is not garbage collected
-	TextureObject->AddToRoot();
 	//Lock initial mip map, copy texture data, and then unlock it
 	FTexture2DMipMap& PrimaryMipMap = TextureObject->PlatformData->Mips[0];
 	void* TextureDataPtr = PrimaryMipMap.BulkData.Lock(LOCK_READ_WRITE);
-	FMemory::Memcpy(TextureDataPtr, UncompressedBGRA.GetData(), UncompressedBGRA.Num());
+	FMemory::Memcpy(TextureDataPtr, Image.BGRAData.GetData(), Image.BGRAData.Num());
 	PrimaryMipMap.BulkData.Unlock();
 	//Update resources to see our changes
 	TextureObject->UpdateResource(); 
 	return TextureObject;
 }
 
+UTexture2D* FImageLoadingUtil::LoadImageFromByteArray(const TArray<uint8>& InByteArray, FString& OutErrorMessage) {
+	EnsureImageWrapperModuleLoaded();
+	
+	FDecodedImage DecodedImage;
+	if (!DecodeImageFromByteArray(InByteArray, DecodedImage, OutErrorMessage)) {
+		return NULL;
+	}
+	UTexture2D* TextureObject = CreateTextureFromDecodedImage(DecodedImage, OutErrorMessage);
+	
+	//Add texture to root set so it is not garbage collected
+	if (TextureObject) {
+		TextureObject->AddToRoot();
+	}
+	return TextureObject;
+}
+
 UTexture2D* FImageLoadingUtil::LoadImageFromFile(const FString& FilePath, FString& OutErrorMessage) {
 	TArray<uint8> RawFileContents;
 	//Failed to load image from the file
@@ -0,0 +1,145 @@
+#include "Util/PhaseTimeline.h"
+#include "HAL/PlatformProcess.h"
+#include "HAL/PlatformTLS.h"
+#include "Misc/ScopeLock.h"
+#include "Dom/JsonObject.h"
+#include "Serialization/JsonSerializer.h"
+#include "Serialization/JsonWriter.h"
+
+DEFINE_LOG_CATEGORY(LogPhaseTimeline);
+
+std::atomic<bool> FPhaseTimeline::bEnabled{false};
+
+namespace PhaseTimelinePrivate {
+	FCriticalSection TimelineLock;
+	TArray<FPhaseTimelineSpan> RecordedSpans;
+
+	double CyclesToMicroseconds(uint64 Cycles) {
+		return FPlatformTime::ToMilliseconds64(Cycles) * 1000.0;
+	}
+
+	/** Calculates time spent in every mod excluding nested spans, so nested registry calls are not counted twice */
+	TMap<FString, double> CalculateSelfTimeByMod(TArray<FPhaseTimelineSpan> Spans) {
+		Spans.Sort([](const FPhaseTimelineSpan& A, const FPhaseTimelineSpan& B) {
+			if (A.ThreadId != B.ThreadId) {
+				return A.ThreadId < B.ThreadId;
+			}
+			//Outer spans start earlier, or at the same time but end later
+			return A.StartCycles != B.StartCycles ? A.StartCycles < B.StartCycles : A.EndCycles > B.EndCycles;
+		});
+
+		TArray<double> SelfTimes;
+		SelfTimes.SetNumUninitialized(Spans.Num());
+		TArray<int32> OpenSpans;
+
+		for (int32 i = 0; i < Spans.Num(); i++) {
+			const FPhaseTimelineSpan& Span = Spans[i];
+			while (OpenSpans.Num() && (Spans[OpenSpans.Last()].ThreadId != Span.ThreadId || Spans[OpenSpans.Last()].EndCycles <= Span.StartCycles)) {
+				OpenSpans.Pop(false);
+			}
+			SelfTimes[i] = CyclesToMicroseconds(Span.EndCycles - Span.StartCycles) / 1000.0;
+			if (OpenSpans.Num()) {
+				SelfTimes[OpenSpans.Last()] -= SelfTimes[i];
+			}
+			OpenSpans.Push(i);
+		}
+
+		TMap<FString, double> TimeByMod;
+		for (int32 i = 0; i < Spans.Num(); i++) {
+			const FName ModReference = Spans[i].ModReference;
+			TimeByMod.FindOrAdd(ModReference.IsNone() ? TEXT("<not attributed>") : ModReference.ToString()) += SelfTimes[i];
+		}
+		return TimeByMod;
+	}
+}
+
+using namespace PhaseTimelinePrivate;
+
+//Startup phases run before any console command can be executed, so recording can also be enabled from the command line
+FProfilingToolConsole FPhaseTimeline::Console(
+	TEXT("Phase timeline"), TEXT("SML.Timeline"), FPhaseTimeline::bEnabled,
+	TEXT("Whenever to record startup and world load phases attributed to mods. Can be enabled from the process start using -SMLTimeline"),
+	TEXT("Writes recorded phase timeline as Chrome trace JSON. Usage: SML.Timeline.Dump [FilePath]"),
+	[](const TArray<FString>& Args, FString& OutFilePath) {
+		const FString FilePath = Args.Num() >= 1 ? Args[0] : TEXT("");
+		return FPhaseTimeline::DumpToFile(FilePath, OutFilePath);
+	},
+	&FPhaseTimeline::Reset,
+	TEXT("SMLTimeline"));
+
+void FPhaseTimeline::SetEnabled(bool bNewEnabled) {
+	Console.SetEnabled(bNewEnabled);
+}
+
+void FPhaseTimeline::RecordSpan(const TCHAR* Category, const TCHAR* Phase, FName ModReference, uint64 StartCycles, uint64 EndCycles) {
+	const uint32 ThreadId = FPlatformTLS::GetCurrentThreadId();
+	FScopeLock ScopeLock(&TimelineLock);
+	RecordedSpans.Add(FPhaseTimelineSpan{Category, Phase, ModReference, StartCycles, EndCycles, ThreadId});
+}
+
+void FPhaseTimeline::Reset() {
+	FScopeLock ScopeLock(&TimelineLock);
+	RecordedSpans.Empty();
+	UE_LOG(LogPhaseTimeline, Display, TEXT("Phase timeline has been reset"));
+}
+
+FString FPhaseTimeline::ExportChromeTrace() {
+	FScopeLock ScopeLock(&TimelineLock);
+	const uint32 ProcessId = FPlatformProcess::GetCurrentProcessId();
+
+	//Timestamps are relative to the first recorded span, so the trace starts at zero
+	uint64 BaseCycles = MAX_uint64;
+	for (const FPhaseTimelineSpan& Span : RecordedSpans) {
+		BaseCycles = FMath::Min(BaseCycles, Span.StartCycles);
+	}
+
+	TArray<TSharedPtr<FJsonValue>> TraceEvents;
+	TraceEvents.Reserve(RecordedSpans.Num());
+
+	for (const FPhaseTimelineSpan& Span : RecordedSpans) {
+		const TSharedRef<FJsonObject> EventObject = MakeShareable(new FJsonObject());
+		const FString EventName = Span.ModReference.IsNone() ?
+			FString::Printf(TEXT("%s %s"), Span.Category, Span.Phase) :
+			FString::Printf(TEXT("%s %s (%s)"), Span.Category, Span.Phase, *Span.ModReference.ToString());
+
+		EventObject->SetStringField(TEXT("name"), EventName);
+		EventObject->SetStringField(TEXT("cat"), Span.Category);
+		EventObject->SetStringField(TEXT("ph"), TEXT("X"));
+		EventObject->SetNumberField(TEXT("ts"), CyclesToMicroseconds(Span.StartCycles - BaseCycles));
+		EventObject->SetNumberField(TEXT("dur"), CyclesToMicroseconds(Span.EndCycles - Span.StartCycles));
+		EventObject->SetNumberField(TEXT("pid"), ProcessId);
+		EventObject->SetNumberField(TEXT("tid"), Span.ThreadId);
+
+		const TSharedRef<FJsonObject> ArgsObject = MakeShareable(new FJsonObject());
+		ArgsObject->SetStringField(TEXT("phase"), Span.Phase);
+		if (!Span.ModReference.IsNone()) {
+			ArgsObject->SetStringField(TEXT("mod"), Span.ModReference.ToString());
+		}
+		EventObject->SetObjectField(TEXT("args"), ArgsObject);
+		TraceEvents.Add(MakeShareable(new FJsonValueObject(EventObject)));
+	}
+
+	const TSharedRef<FJsonObject> RootObject = MakeShareable(new FJsonObject());
+	RootObject->SetArrayField(TEXT("traceEvents"), TraceEvents);
+	RootObject->SetStringField(TEXT("displayTimeUnit"), TEXT("ms"));
+
+	FString OutJsonString;
+	const TSharedRef<TJsonWriter<>> Writer = TJsonWriterFactory<>::Create(&OutJsonString);
+	FJsonSerializer::Serialize(RootObject, Writer);
+	return OutJsonString;
+}
+
+bool FPhaseTimeline::DumpToFile(const FString& FilePath, FString& OutFilePath) {
+	OutFilePath = FProfilingToolConsole::MakeDumpFilePath(FilePath, TEXT("PhaseTimeline"), TEXT("json"));
+	if (!FProfilingToolConsole::WriteDumpFile(ExportChromeTrace(), OutFilePath)) {
+		return false;
+	}
+
+	TArray<FPhaseTimelineSpan> Spans;
+	{
+		FScopeLock ScopeLock(&TimelineLock);
+		Spans = RecordedSpans;
+	}
+	FProfilingToolConsole::LogTopEntries(TEXT("Mods that took the most time, excluding nested phases"), CalculateSelfTimeByMod(MoveTemp(Spans)));
+	return true;
+}
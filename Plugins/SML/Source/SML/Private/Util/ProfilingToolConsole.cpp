@@ -0,0 +1,83 @@
+#include "Util/ProfilingToolConsole.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/CommandLine.h"
+#include "Misc/DateTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+DEFINE_LOG_CATEGORY(LogProfilingTool);
+
+FProfilingToolConsole::FProfilingToolConsole(const TCHAR* InToolName, const TCHAR* ConsolePrefix, std::atomic<bool>& InEnabledFlag,
+		const TCHAR* EnabledHelp, const TCHAR* DumpHelp, FDumpFunction InDumpFunction, TFunction<void()> InResetFunction,
+		const TCHAR* CommandLineSwitch) :
+		ToolName(InToolName), EnabledFlag(InEnabledFlag), DumpFunction(MoveTemp(InDumpFunction)), ResetFunction(MoveTemp(InResetFunction)) {
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+	const FString Prefix = ConsolePrefix;
+
+	EnabledVariable = ConsoleManager.RegisterConsoleVariable(*(Prefix + TEXT(".Enabled")), false, EnabledHelp, ECVF_Default);
+	EnabledVariable->SetOnChangedCallback(FConsoleVariableDelegate::CreateRaw(this, &FProfilingToolConsole::HandleEnabledChanged));
+
+	DumpCommand = ConsoleManager.RegisterConsoleCommand(*(Prefix + TEXT(".Dump")), DumpHelp,
+		FConsoleCommandWithArgsDelegate::CreateRaw(this, &FProfilingToolConsole::HandleDumpCommand), ECVF_Default);
+
+	const FString ResetHelp = FString::Printf(TEXT("Drops all of the data gathered by the %s"), InToolName);
+	ResetCommand = ConsoleManager.RegisterConsoleCommand(*(Prefix + TEXT(".Reset")), *ResetHelp,
+		FConsoleCommandDelegate::CreateLambda([this]() { ResetFunction(); }), ECVF_Default);
+
+	if (CommandLineSwitch != NULL && FParse::Param(FCommandLine::Get(), CommandLineSwitch)) {
+		EnabledVariable->Set(true);
+	}
+}
+
+FProfilingToolConsole::~FProfilingToolConsole() {
+	IConsoleManager& ConsoleManager = IConsoleManager::Get();
+	ConsoleManager.UnregisterConsoleObject(EnabledVariable);
+	ConsoleManager.UnregisterConsoleObject(DumpCommand);
+	ConsoleManager.UnregisterConsoleObject(ResetCommand);
+}
+
+void FProfilingToolConsole::SetEnabled(bool bNewEnabled) {
+	if (EnabledFlag.exchange(bNewEnabled, std::memory_order_relaxed) != bNewEnabled) {
+		UE_LOG(LogProfilingTool, Display, TEXT("%s %s"), *ToolName, bNewEnabled ? TEXT("enabled") : TEXT("disabled"));
+	}
+}
+
+void FProfilingToolConsole::HandleEnabledChanged(IConsoleVariable* Variable) {
+	SetEnabled(Variable->GetBool());
+}
+
+void FProfilingToolConsole::HandleDumpCommand(const TArray<FString>& Args) {
+	FString OutFilePath;
+	if (DumpFunction(Args, OutFilePath)) {
+		UE_LOG(LogProfilingTool, Display, TEXT("%s data written to %s"), *ToolName, *OutFilePath);
+	}
+}
+
+FString FProfilingToolConsole::MakeDumpFilePath(const FString& FilePath, const TCHAR* FileNamePrefix, const TCHAR* Extension) {
+	if (!FilePath.IsEmpty()) {
+		return FilePath;
+	}
+	const FString FileName = FString::Printf(TEXT("%s-%s.%s"), FileNamePrefix, *FDateTime::Now().ToString(), Extension);
+	return FPaths::Combine(FPaths::ProfilingDir(), TEXT("SML"), FileName);
+}
+
+bool FProfilingToolConsole::WriteDumpFile(const FString& Contents, const FString& FilePath) {
+	if (!FFileHelper::SaveStringToFile(Contents, *FilePath)) {
+		UE_LOG(LogProfilingTool, Error, TEXT("Failed to write profiling data to %s"), *FilePath);
+		return false;
+	}
+	return true;
+}
+
+void FProfilingToolConsole::LogTopEntries(const FString& Title, TMap<FString, double> TimeByEntry, int32 MaxEntries) {
+	TimeByEntry.ValueSort([](double A, double B) { return A > B; });
+	UE_LOG(LogProfilingTool, Display, TEXT("%s:"), *Title);
+
+	int32 EntriesLogged = 0;
+	for (const TPair<FString, double>& Pair : TimeByEntry) {
+		if (EntriesLogged++ >= MaxEntries) {
+			break;
+		}
+		UE_LOG(LogProfilingTool, Display, TEXT("  %s: %.3f ms"), *Pair.Key, Pair.Value);
+	}
+}
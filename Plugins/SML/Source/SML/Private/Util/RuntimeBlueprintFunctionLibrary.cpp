@@ -5,6 +5,7 @@
 
 #include "Patching/BlueprintHookHelper.h"
 #include "Patching/BlueprintHookManager.h"
+#include "Util/ClassByNameCache.h"
 
 
 UClass* URuntimeBlueprintFunctionLibrary::FindClassByName(FString ClassNameInput) {
@@ -12,16 +13,14 @@ UClass* URuntimeBlueprintFunctionLibrary::FindClassByName(FString ClassNameInput
 	if (ClassNameInput.Len() == 0)
 		return nullptr;
 
-	const TCHAR* ClassName = *ClassNameInput;
-	UObject* ClassPackage = ANY_PACKAGE;
-
-	if (UClass* Result = FindObject<UClass>(ANY_PACKAGE, ClassName, false))
-		return Result;
-
-	if (UObjectRedirector* RenamedClassRedirector = FindObject<UObjectRedirector>(ANY_PACKAGE, ClassName, true))
-		return CastChecked<UClass>(RenamedClassRedirector->DestinationObject);
+	// classes are looked up in all packages, so resolved ones are cached until they are unloaded or redirected
+	return FClassByNameCache::Get().FindClassByName(ClassNameInput);
+}
 
-	return nullptr;
+TArray<UClass*> URuntimeBlueprintFunctionLibrary::FindClassesByName(const TArray<FString>& ClassNames) {
+	TArray<UClass*> Out;
+	FClassByNameCache::Get().FindClassesByName(ClassNames, Out);
+	return Out;
 }
 
 bool URuntimeBlueprintFunctionLibrary::IsEditor() {
@@ -363,8 +362,18 @@ void URuntimeBlueprintFunctionLibrary::BindOnBPFunction(const TSubclassOf<UObjec
 			return;
 		}
 		EPredefinedHookOffset Offset = HookOffsetStart ? EPredefinedHookOffset::Start : EPredefinedHookOffset::Return;
+		//Attribute the hook to the mod owning the bound object, e.g /ModReference/Path/To/Asset
+		FString OwnerName = TEXT("Unknown");
+		if (const UObject* BoundObject = Binding.GetUObject()) {
+			TArray<FString> PathSegments;
+			BoundObject->GetOutermost()->GetName().ParseIntoArray(PathSegments, TEXT("/"));
+			if (PathSegments.Num() > 0) {
+				OwnerName = PathSegments[0];
+			}
+		}
+
 		UBlueprintHookManager* HookManager = GEngine->GetEngineSubsystem<UBlueprintHookManager>();
 		HookManager->HookBlueprintFunction(Function, [Binding](FBlueprintHookHelper& HookHelper) {
             Binding.ExecuteIfBound(HookHelper.GetContext());
-        }, Offset);
+        }, Offset, OwnerName);
 }
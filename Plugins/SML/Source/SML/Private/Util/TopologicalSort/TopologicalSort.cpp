@@ -0,0 +1,110 @@
+#include "Util/TopologicalSort/TopologicalSort.h"
+
+/** Finds cycles among the nodes that are left unsorted, walking backwards through their unsorted predecessors */
+static void FindCycles(const FCompressedDirectedGraph& Graph, const TArray<int32>& RemainingInDegree, TArray<TArray<int32>>& OutCycles) {
+	const int32 NodeCount = Graph.Num();
+
+	//Build reverse edges of the unsorted nodes only, since cycles cannot go through the sorted ones
+	TArray<int32> ReverseOffsets;
+	ReverseOffsets.SetNumZeroed(NodeCount + 1);
+	for (int32 From = 0; From < NodeCount; From++) {
+		if (RemainingInDegree[From] == 0) {
+			continue;
+		}
+		for (int32 i = Graph.EdgeOffsets[From]; i < Graph.EdgeOffsets[From + 1]; i++) {
+			ReverseOffsets[Graph.EdgeTargets[i] + 1]++;
+		}
+	}
+	for (int32 i = 0; i < NodeCount; i++) {
+		ReverseOffsets[i + 1] += ReverseOffsets[i];
+	}
+	TArray<int32> ReverseSources;
+	ReverseSources.SetNumUninitialized(ReverseOffsets[NodeCount]);
+	TArray<int32> InsertPositions(ReverseOffsets);
+	for (int32 From = 0; From < NodeCount; From++) {
+		if (RemainingInDegree[From] == 0) {
+			continue;
+		}
+		for (int32 i = Graph.EdgeOffsets[From]; i < Graph.EdgeOffsets[From + 1]; i++) {
+			ReverseSources[InsertPositions[Graph.EdgeTargets[i]]++] = From;
+		}
+	}
+
+	//Every unsorted node has at least one unsorted predecessor, so walking backwards always ends up in a cycle
+	//Nodes are marked as finished once walk is done, so every node is walked through only once
+	enum class EWalkState : uint8 { NotVisited, OnCurrentWalk, Finished };
+	TArray<EWalkState> WalkStates;
+	WalkStates.Init(EWalkState::NotVisited, NodeCount);
+	TArray<int32> WalkPath;
+
+	for (int32 StartNode = 0; StartNode < NodeCount; StartNode++) {
+		if (RemainingInDegree[StartNode] == 0 || WalkStates[StartNode] != EWalkState::NotVisited) {
+			continue;
+		}
+		WalkPath.Reset();
+		int32 CurrentNode = StartNode;
+
+		while (WalkStates[CurrentNode] == EWalkState::NotVisited) {
+			WalkStates[CurrentNode] = EWalkState::OnCurrentWalk;
+			WalkPath.Add(CurrentNode);
+			CurrentNode = ReverseSources[ReverseOffsets[CurrentNode]];
+		}
+		//Walk has reached itself, so it's a new cycle. Otherwise it reached an already reported cycle
+		if (WalkStates[CurrentNode] == EWalkState::OnCurrentWalk) {
+			const int32 CycleStart = WalkPath.Find(CurrentNode);
+			TArray<int32>& Cycle = OutCycles.AddDefaulted_GetRef();
+			//Walk went against the edges, so reverse it to make every node point to the next one
+			for (int32 i = WalkPath.Num() - 1; i >= CycleStart; i--) {
+				Cycle.Add(WalkPath[i]);
+			}
+		}
+		for (const int32 WalkNode : WalkPath) {
+			WalkStates[WalkNode] = EWalkState::Finished;
+		}
+	}
+}
+
+bool FTopologicalSort::SortIndices(const FCompressedDirectedGraph& Graph, FTopologicalSortIndexResult& OutResult) {
+	const int32 NodeCount = Graph.Num();
+	OutResult.SortedNodes.Reset(NodeCount);
+	OutResult.LevelOffsets.Reset();
+	OutResult.Cycles.Reset();
+
+	TArray<int32> InDegree;
+	InDegree.SetNumZeroed(NodeCount);
+	for (const int32 Target : Graph.EdgeTargets) {
+		InDegree[Target]++;
+	}
+
+	//First level consists of all of the nodes without incoming edges, in the order of their insertion
+	for (int32 Node = 0; Node < NodeCount; Node++) {
+		if (InDegree[Node] == 0) {
+			OutResult.SortedNodes.Add(Node);
+		}
+	}
+
+	//Sorted nodes array is used as the queue, every level is processed as a whole to produce the next one
+	int32 LevelStart = 0;
+	while (LevelStart < OutResult.SortedNodes.Num()) {
+		const int32 LevelEnd = OutResult.SortedNodes.Num();
+		OutResult.LevelOffsets.Add(LevelStart);
+
+		for (int32 i = LevelStart; i < LevelEnd; i++) {
+			const int32 Node = OutResult.SortedNodes[i];
+			for (int32 Edge = Graph.EdgeOffsets[Node]; Edge < Graph.EdgeOffsets[Node + 1]; Edge++) {
+				const int32 Target = Graph.EdgeTargets[Edge];
+				if (--InDegree[Target] == 0) {
+					OutResult.SortedNodes.Add(Target);
+				}
+			}
+		}
+		LevelStart = LevelEnd;
+	}
+	OutResult.LevelOffsets.Add(OutResult.SortedNodes.Num());
+
+	if (OutResult.SortedNodes.Num() == NodeCount) {
+		return true;
+	}
+	FindCycles(Graph, InDegree, OutResult.Cycles);
+	return false;
+}
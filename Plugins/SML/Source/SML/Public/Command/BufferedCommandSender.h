@@ -0,0 +1,31 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Command/CommandSender.h"
+#include "BufferedCommandSender.generated.h"
+
+/**
+ * Command sender buffering chat messages sent to it, so output of multiple commands
+ * can be delivered to the wrapped sender as a single message
+ * Everything besides the chat messages is forwarded to the wrapped sender
+ */
+UCLASS()
+class SML_API UBufferedCommandSender : public UCommandSender {
+    GENERATED_BODY()
+private:
+    UPROPERTY()
+    UCommandSender* WrappedSender;
+
+    TArray<FString> BufferedMessages;
+    bool bHasErrorMessages;
+public:
+    /** Sets sender receiving buffered messages on flush */
+    void Initialize(UCommandSender* InWrappedSender);
+
+    /** Sends all of the buffered messages followed by the summary line as a single message, red if any of them was an error */
+    void Flush(const FString& SummaryLine);
+
+    FString GetSenderName() const override;
+    bool IsPlayerSender() const override;
+    AFGPlayerController* GetPlayer() const override;
+    void SendChatMessage(const FString& Message, const FLinearColor PrefixColor) override;
+};
@@ -27,6 +27,9 @@ private:
 	//Replicated in case of command actor wanting to replicate
 	UPROPERTY(Replicated)
     FName ModReference;
+
+	/** Whenever command has been disabled for players in SML configuration, resolved once on registration */
+	uint8 bDisabledForPlayers: 1;
 public:
 	/**
     * ModId of the mod registering the command
@@ -41,6 +44,13 @@ public:
 	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
 	uint8 bOnlyUsableByPlayer: 1;
 
+	/**
+	 * Whenever this command can only be used from the server console
+	 * Trying to run it as a player, including the host of the listen server, will fail with insufficient permissions
+	 */
+	UPROPERTY(EditDefaultsOnly, BlueprintReadOnly)
+	uint8 bOnlyUsableByConsole: 1;
+
 	/**
 	 * Minimum number of arguments to enforce before
 	 * actually giving execution control to the command
@@ -1,6 +1,8 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "command/ChatCommandInstance.h"
+#include "Command/ChatCommandNameTrie.h"
+#include "Command/PlayerNameIndex.h"
 #include "Subsystem/ModSubsystem.h"
 #include "ChatCommandLibrary.generated.h"
 
@@ -13,9 +15,29 @@ private:
 	//Array of registered command actors
 	UPROPERTY()
 	TArray<AChatCommandInstance*> RegisteredCommands;
-	//Map to lookup command instances fast
-	UPROPERTY()
-	TMap<FString, AChatCommandInstance*> CommandByNameMap;
+	//Case insensitive tree of command names and aliases, mapped to the indices of registered commands
+	FChatCommandNameTrie CommandNameTrie;
+
+	/** Returns command registered under the given name or alias, ignoring case */
+	AChatCommandInstance* FindCommandByNameInternal(FStringView Name) const;
+
+	//Names of the players in this world, updated on login, logout and rename
+	FPlayerNameIndex PlayerNameIndex;
+	FDelegateHandle PostLoginDelegateHandle;
+	FDelegateHandle LogoutDelegateHandle;
+	FDelegateHandle SetPlayerNameHookHandle;
+
+	void HandlePlayerPostLogin(class AGameModeBase* GameMode, APlayerController* Controller);
+	void HandlePlayerLogout(class AGameModeBase* GameMode, AController* Controller);
+
+	//Depth of the command batches currently being executed, used to stop batches running themselves recursively
+	int32 BatchDepth;
+
+	/** Parses command line and executes command, without logging the execution */
+	EExecutionStatus ExecuteCommandLine(const FString& CommandLine, UCommandSender* Sender);
+
+	/** Resolves players matching the name, which can also be one of the target selectors. Nicknames are matched loosely if bFuzzyMatch is set */
+	void ResolvePlayerName(UCommandSender* Caller, FStringView Name, bool bFuzzyMatch, TArray<class AFGPlayerController*>& OutPlayers) const;
 public:
 	AChatCommandSubsystem();
 	
@@ -35,6 +57,13 @@ public:
 	UFUNCTION(BlueprintPure, Category = "Utilities|ChatCommand")
 	AChatCommandInstance* FindCommandByName(const FString& Name);
 
+	/**
+	 * Returns names and aliases of the commands starting with the given prefix, ignoring case
+	 * Both short and fully qualified names are included, sorted alphabetically
+	 */
+	UFUNCTION(BlueprintPure, Category = "Utilities|ChatCommand")
+	TArray<FString> GetCommandNameCompletions(const FString& Prefix) const;
+
 	/*
 	 * Returns array of all registered commands
 	 */
@@ -53,7 +82,7 @@ public:
 
 	/**
 	* Parses command line and executes given command from the face of the given player
-	* Characters enclosed in "" are considered a single argument
+	* Characters enclosed in "" are considered a single argument, and backslash escapes the next character
 	* If command is not found, returns bad_arguments
 	*
 	* @param CommandLine Command line to execute, without prefix slash
@@ -61,6 +90,28 @@ public:
 	*/
 	UFUNCTION(BlueprintCallable, Category = "Utilities|ChatCommand")
 	EExecutionStatus RunChatCommand(const FString& CommandLine, UCommandSender* Sender);
+
+	/**
+	* Executes multiple command lines from the face of the given player in a single invocation
+	* Output of all commands is buffered and sent to the sender as a single reply, followed by the execution summary
+	* Every command is still checked against SML configuration, so batching cannot be used to run disabled commands
+	*
+	* @param CommandLines Command lines to execute, without prefix slash
+	* @param Sender Sender which caused command execution. Should implement ICommandSenderInterface
+	* @return COMPLETED if all commands have been completed, otherwise status of the first command which has not
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Utilities|ChatCommand")
+	EExecutionStatus RunChatCommandBatch(const TArray<FString>& CommandLines, UCommandSender* Sender);
+
+	/**
+	* Executes commands of the script as a single batch, see RunChatCommandBatch
+	* Script contains one command per line. Empty lines and lines starting with # are skipped, and prefix slash is optional
+	*
+	* @param Script Text of the script to execute
+	* @param Sender Sender which caused command execution. Should implement ICommandSenderInterface
+	*/
+	UFUNCTION(BlueprintCallable, Category = "Utilities|ChatCommand")
+	EExecutionStatus RunChatCommandScript(const FString& Script, UCommandSender* Sender);
 	
 	/**
 	* Parses given player name, returning all players matching
@@ -68,7 +119,7 @@ public:
 	* It supports multiple target selectors:
 	* @s(elf) - targets player who executed this command
 	* @a(ll) - targets all players on the server
-	* otherwise - treated as player nickname
+	* otherwise - treated as player nickname, matching players with exactly that nickname (ignoring case)
 	*
 	* @param Caller caller of the original command
 	* @param Name Name to parse against selectors
@@ -77,7 +128,38 @@ public:
 	*/
 	UFUNCTION(BlueprintPure, Category = "Utilities|ChatCommand", meta = (WorldContext = "WorldContext"))
 	static TArray<class AFGPlayerController*> ParsePlayerName(UCommandSender* Caller, const FString& Name, UObject* WorldContext);
+
+	/**
+	* Same as ParsePlayerName, but nicknames are matched loosely: exact matches are preferred, then case insensitive ones,
+	* and then the only player whose nickname starts with the given name. Prefix matching multiple players resolves nothing
+	* Should only be used by commands where targeting a player with the similar nickname is harmless
+	*
+	* @param Caller caller of the original command
+	* @param Name Name to parse against selectors
+	* @param WorldContext World Context
+	* @return Array of players matching given name
+	*/
+	UFUNCTION(BlueprintPure, Category = "Utilities|ChatCommand", meta = (WorldContext = "WorldContext"))
+	static TArray<class AFGPlayerController*> ParsePlayerNameFuzzy(UCommandSender* Caller, const FString& Name, UObject* WorldContext);
+
+	/**
+	* Parses multiple player names in one call, returning all players matching any of them
+	* Every player is only included once, in the order of the first name matching it
+	*
+	* @param Caller caller of the original command
+	* @param Names Names to parse against selectors, see ParsePlayerName
+	* @param WorldContext World Context
+	* @return Array of players matching any of the given names
+	*/
+	UFUNCTION(BlueprintPure, Category = "Utilities|ChatCommand", meta = (WorldContext = "WorldContext"))
+	static TArray<class AFGPlayerController*> ParsePlayerNames(UCommandSender* Caller, const TArray<FString>& Names, UObject* WorldContext);
+
+	/** Returns players whose nicknames start with the given prefix, ignoring case */
+	UFUNCTION(BlueprintPure, Category = "Utilities|ChatCommand")
+	TArray<class AFGPlayerController*> GetPlayerNameCompletions(const FString& Prefix) const;
 protected:
 	/** Initializes builtin commands for the command subsystem */
 	virtual void Init() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 };
\ No newline at end of file
@@ -0,0 +1,35 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+/**
+ * Case insensitive prefix tree of the chat command names and aliases, mapping them to the command indices
+ * Lookups walk the characters of the name directly, so they do not need to lowercase it into a new string
+ */
+class SML_API FChatCommandNameTrie {
+public:
+	FChatCommandNameTrie();
+
+	/** Maps name to the command index, replacing command previously registered under the same name */
+	void Add(const FString& Name, int32 CommandIndex);
+
+	/** Returns index of the command with the name matching exactly, ignoring case, or INDEX_NONE if there is none */
+	int32 Find(FStringView Name) const;
+
+	/** Appends names starting with the provided prefix, ignoring case, in their registered spelling */
+	void FindByPrefix(FStringView Prefix, TArray<FString>& OutNames) const;
+private:
+	struct FNode {
+		/** Lowercase character leading to the child node, and index of the child node */
+		TArray<TPair<TCHAR, int32>> Children;
+		/** Command registered under the name ending at this node, or INDEX_NONE */
+		int32 CommandIndex = INDEX_NONE;
+		/** Registered spelling of the name ending at this node */
+		FString Name;
+	};
+	/** Nodes of the tree, root node is always at index 0 */
+	TArray<FNode> Nodes;
+
+	int32 FindChild(int32 NodeIndex, TCHAR Character) const;
+	int32 FindNode(FStringView Name) const;
+};
@@ -0,0 +1,23 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+/** Single argument of the command line, pointing into the original command line string */
+struct SML_API FChatCommandToken {
+	FStringView Text;
+	/** True if token contains escape characters, which are removed when token is converted to string */
+	bool bHasEscapes = false;
+
+	/** Converts token into the string, removing escape characters from it */
+	FString ToString() const;
+};
+
+class SML_API FChatCommandTokenizer {
+public:
+	/**
+	 * Splits command line into the arguments separated by spaces, without copying them
+	 * Characters enclosed in "" are considered a single argument, and backslash escapes the character following it
+	 * Tokens point into the provided command line, so it should outlive them
+	 */
+	static void Tokenize(FStringView CommandLine, TArray<FChatCommandToken>& OutTokens);
+};
@@ -0,0 +1,26 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Command/CommandSender.h"
+#include "ConsoleCommandSender.generated.h"
+
+/**
+ * Command sender representing the server console
+ * Used for commands entered through the SML.RunChatCommand console command, and is allowed to run console only commands
+ * Chat messages sent to it are written into the log and the console output device
+ */
+UCLASS()
+class SML_API UConsoleCommandSender : public UCommandSender {
+    GENERATED_BODY()
+private:
+    FOutputDevice* OutputDevice;
+public:
+    UConsoleCommandSender();
+
+    /** Sets output device receiving chat messages in addition to the log, or NULL to only write them into the log */
+    void SetOutputDevice(FOutputDevice* InOutputDevice);
+
+    FString GetSenderName() const override;
+    bool IsPlayerSender() const override;
+    AFGPlayerController* GetPlayer() const override;
+    void SendChatMessage(const FString& Message, const FLinearColor PrefixColor) override;
+};
@@ -0,0 +1,46 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Containers/StringView.h"
+
+class AFGPlayerController;
+
+/**
+ * Index of the player names in the world, used to resolve player name arguments of the chat commands
+ * Players are kept sorted by their lowercase names, so exact, case insensitive and prefix lookups
+ * are all binary searches instead of the scan over every player controller
+ */
+class SML_API FPlayerNameIndex {
+public:
+	/** Adds player to the index, or updates name of the already indexed player */
+	void SetPlayerName(AFGPlayerController* Controller, const FString& PlayerName);
+
+	/** Removes player from the index */
+	void RemovePlayer(AFGPlayerController* Controller);
+
+	/** Removes all players from the index */
+	void Reset();
+
+	/** Appends players whose names are equal to the given one, ignoring case */
+	void FindPlayersByName(FStringView Name, TArray<AFGPlayerController*>& OutPlayers) const;
+
+	/**
+	 * Resolves players loosely matching the name
+	 * Exact matches are preferred, then case insensitive matches, and then the only player whose name starts with the given one
+	 * Prefix matching multiple players resolves nothing, so ambiguous names never target unintended players
+	 */
+	void ResolvePlayersFuzzy(FStringView Name, TArray<AFGPlayerController*>& OutPlayers) const;
+
+	/** Appends players whose names start with the prefix, ignoring case */
+	void FindPlayersByPrefix(FStringView Prefix, TArray<AFGPlayerController*>& OutPlayers) const;
+private:
+	struct FEntry {
+		TWeakObjectPtr<AFGPlayerController> Controller;
+		FString PlayerName;
+		FString LowerPlayerName;
+	};
+	/** Entries sorted by their lowercase names */
+	TArray<FEntry> Entries;
+
+	/** Returns range of the entries with lowercase names starting with the prefix, or matching it exactly if bExactMatch is set */
+	void FindEntryRange(FStringView Name, bool bExactMatch, int32& OutStartIndex, int32& OutEndIndex) const;
+};
@@ -0,0 +1,11 @@
+﻿#pragma once
+#include "Command/ChatCommandInstance.h"
+#include "BatchCommandInstance.generated.h"
+
+UCLASS(MinimalAPI)
+class ABatchCommandInstance : public AChatCommandInstance {
+    GENERATED_BODY()
+public:
+    ABatchCommandInstance();
+    EExecutionStatus ExecuteCommand_Implementation(UCommandSender* Sender, const TArray<FString>& Arguments, const FString& Label) override;
+};
@@ -0,0 +1,14 @@
+﻿#pragma once
+#include "Command/ChatCommandInstance.h"
+#include "ExecCommandInstance.generated.h"
+
+UCLASS(MinimalAPI)
+class AExecCommandInstance : public AChatCommandInstance {
+    GENERATED_BODY()
+public:
+    AExecCommandInstance();
+    EExecutionStatus ExecuteCommand_Implementation(UCommandSender* Sender, const TArray<FString>& Arguments, const FString& Label) override;
+
+    /** Returns directory chat command scripts are loaded from */
+    static FString GetScriptsDirectory();
+};
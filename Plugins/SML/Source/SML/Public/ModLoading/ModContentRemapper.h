@@ -1,6 +1,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Subsystems/EngineSubsystem.h"
+#include "Misc/ScopeRWLock.h"
 #include "ModContentRemapper.generated.h"
 
 UCLASS()
@@ -16,8 +17,23 @@ public:
 	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
 	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 private:
-	/** List of plugins which already have redirects applied to them */
-	TSet<FString> PluginsAlreadyHandled;
+	/**
+	 * Mounted content roots of the mod plugins, keyed by the plugin name
+	 * Package /Game/<Plugin>/<Path> is remapped to <ContentRoot><Path> by the core redirects hooks,
+	 * so lookup cost is a single hash lookup on the first path segment regardless of the plugin count
+	 */
+	static TMap<FName, FString> PluginContentRoots;
+	/** Guards plugin content roots, since package redirects are resolved from the async loading thread too */
+	static FRWLock PluginContentRootsLock;
+
+	/** Registers content root of the plugin. Returns false if plugin has already been registered */
+	static bool RegisterPluginContentRoot(class IPlugin& Plugin);
+
+	/** Remaps package name of the object if it's located inside of the /Game/<Plugin>/ directory of the registered plugin */
+	static bool RemapPluginPackageName(const struct FCoreRedirectObjectName& ObjectName, struct FCoreRedirectObjectName& OutRemappedName);
+
+	/** Installs core redirects hooks consulting plugin content roots */
+	static void InstallPackageRedirectHook();
 	
 	void OnNewPluginMounted(class IPlugin& Plugin);	
 };
\ No newline at end of file
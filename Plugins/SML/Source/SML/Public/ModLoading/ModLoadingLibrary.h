@@ -6,6 +6,7 @@
 
 class UTexture2D;
 class IPlugin;
+struct FDecodedImage;
 class FJsonObject;
 
 /** Mod name of the Satisfactory itself, backend by the dummy mod info with changelist-defined version number */
@@ -87,6 +88,28 @@ struct SML_API FSMLPluginDescriptorMetadata {
     void Load(const FString& PluginName, const TSharedPtr<FJsonObject> Source);
 };
 
+/** Mod icons packed into a single texture, for drawing long mod lists without a texture per mod */
+USTRUCT(BlueprintType)
+struct SML_API FModIconAtlas {
+    GENERATED_BODY()
+
+    /** Atlas texture containing all of the icons, or NULL if none of the icons could be loaded */
+    UPROPERTY(BlueprintReadOnly)
+    UTexture2D* Texture = NULL;
+
+    /** UV region of every mod icon inside of the atlas texture, in 0-1 range. Mods without a loadable icon are omitted */
+    UPROPERTY(BlueprintReadOnly)
+    TMap<FString, FBox2D> IconUVRegions;
+};
+
+/** Called once mod icon has been loaded, with the blank texture if it cannot be loaded */
+DECLARE_DELEGATE_TwoParams(FOnModIconLoaded, UTexture2D* /*IconTexture*/, bool /*bIsBlankTexture*/);
+/** Called once mod icon atlas has been built */
+DECLARE_DELEGATE_OneParam(FOnModIconAtlasBuilt, const FModIconAtlas& /*Atlas*/);
+
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnModIconTextureLoaded, UTexture2D*, IconTexture);
+DECLARE_DYNAMIC_DELEGATE_OneParam(FOnModIconAtlasBuiltDynamic, const FModIconAtlas&, Atlas);
+
 /** Provides access to the mod loading functionality for blueprints and allows accessing loaded mods list in implementation-agnostic manner */
 UCLASS()
 class SML_API UModLoadingLibrary : public UEngineSubsystem {
@@ -110,6 +133,14 @@ public:
     UFUNCTION(BlueprintCallable, Category = "SML|Mod Loading")
     UTexture2D* LoadModIconTexture(const FString& Name, UTexture2D* FallbackIcon);
 
+    /** Loads mod icon without blocking the game thread on decoding, and passes it or FallbackIcon if icon cannot be loaded to the callback */
+    UFUNCTION(BlueprintCallable, Category = "SML|Mod Loading")
+    void LoadModIconTextureAsync(const FString& Name, UTexture2D* FallbackIcon, const FOnModIconTextureLoaded& OnLoaded);
+
+    /** Asynchronously packs icons of the provided mods into a single atlas texture, each scaled to IconSize pixels */
+    UFUNCTION(BlueprintCallable, Category = "SML|Mod Loading")
+    void BuildModIconAtlasAsync(const TArray<FString>& Names, int32 IconSize, const FOnModIconAtlasBuiltDynamic& OnBuilt);
+
     /** Returns the currently used SML version */
     UFUNCTION(BlueprintPure, Category = "SML|Mod Loading", meta = (BlueprintThreadSafe))
     FVersion GetModLoaderVersion() const;
@@ -178,8 +209,30 @@ public:
 
     /** Loads a mod icon texture or retrieves it from cache if it has been loaded already */
     UTexture2D* FindOrLoadModIcon(const FString& PluginName, bool& bOutIsBlankTexture);
+
+    /**
+     * Loads a mod icon asynchronously, decoding it on the worker thread and only uploading the texture on the game thread
+     * Callback is fired immediately if icon is already cached, and concurrent requests for the same icon share a single load
+     */
+    void RequestModIcon(const FString& PluginName, const FOnModIconLoaded& Callback);
+
+    /**
+     * Asynchronously builds an atlas from the icons of the provided mods, each scaled to IconSize pixels
+     * All icons are decoded and packed on the worker threads, and atlas is uploaded as a single texture on the game thread
+     * Atlas is not cached, caller is responsible for keeping the texture referenced
+     */
+    void RequestModIconAtlas(const TArray<FString>& PluginNames, int32 IconSize, const FOnModIconAtlasBuilt& Callback);
 private:
+    /** Callbacks waiting for the asynchronously loaded icons, keyed by the plugin name */
+    TMap<FString, TArray<FOnModIconLoaded>> PendingIconRequests;
+    
     /** Actually loads mod icon */
     static UTexture2D* LoadModIcon(const FString& PluginName);
+
+    /** Returns path to the icon file of the mod, or empty string if plugin is not a loaded mod */
+    static FString GetModIconFilePath(const FString& PluginName);
+
+    /** Caches texture created from the decoded icon and fires pending callbacks */
+    void OnModIconDecoded(const FString& PluginName, const FDecodedImage& DecodedImage, bool bDecodedSuccessfully, const FString& ErrorMessage);
 };
 
@@ -1,6 +1,10 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Module/ModModule.h"
+#include "UObject/SoftObjectPath.h"
+#include "Util/TopologicalSort/DirectedGraph.h"
+
+struct FStreamableHandle;
 
 /** Describes a single discovered mod root module associated with it's owner plugin name */
 struct SML_API FDiscoveredModule {
@@ -8,14 +12,64 @@ struct SML_API FDiscoveredModule {
 	TSubclassOf<UModModule> ModuleClass;
 };
 
+/** Called once root modules of the requested type have been discovered and loaded */
+DECLARE_DELEGATE_OneParam(FOnRootModulesDiscovered, const TArray<FDiscoveredModule>& /*DiscoveredModules*/);
+
 class SML_API FPluginModuleLoader {
 public:
-	/** Retrieves all root modules of the provided type and their respective owners */
+	/**
+	 * Retrieves all root modules of the provided type and their respective owners
+	 * Modules are ordered so that modules of the plugin dependencies come before the modules of the plugins depending on them
+	 * Results are cached for the rest of the session, and pending asynchronous discovery of the same type is completed instead of starting a new one
+	 */
 	static TArray<FDiscoveredModule> FindRootModulesOfType(TSubclassOf<UModModule> ModuleType);
 
+	/**
+	 * Starts asynchronous discovery of the root modules of the provided type
+	 * Blueprint module classes are requested in one batched streamable load, and callback is fired once all of them are loaded
+	 * When modules of that type have already been discovered in this session, callback is fired immediately
+	 */
+	static void FindRootModulesOfTypeAsync(TSubclassOf<UModModule> ModuleType, const FOnRootModulesDiscovered& OnDiscovered = FOnRootModulesDiscovered());
+
 	/** Determines whenever we want to load modules for the provided world. Generally, we want to load modules only for standalone and PIE worlds */
 	static bool ShouldLoadModulesForWorld(UWorld* World);
 
 	/** Returns true if this world represents a main menu world */
 	static bool IsMainMenuWorld(UWorld* World);
-};
\ No newline at end of file
+
+	/**
+	 * Adds provided plugins and the whole closure of their descriptor dependencies to the graph, with edges going from the dependency to the dependent plugin
+	 * Plugins of the closure are added even when caller is not interested in them, otherwise dependency chains going through them would be lost
+	 */
+	static void AddPluginDependencyClosure(const TArray<FString>& PluginNames, TDirectedGraph<FString>& DependencyGraph);
+private:
+	/** State of the root module discovery for a single module type */
+	struct FRootModuleDiscovery {
+		/** Blueprint module classes requested by the discovery */
+		TArray<FSoftClassPath> BlueprintModuleClassPaths;
+		/** Native module classes, already loaded at the time discovery has been started */
+		TArray<UClass*> NativeModuleClasses;
+		/** Streamable handle keeping blueprint module classes loaded for the rest of the session */
+		TSharedPtr<FStreamableHandle> LoadHandle;
+		/** Callbacks waiting for the discovery to be completed */
+		TArray<FOnRootModulesDiscovered> PendingCallbacks;
+		/** Resulting modules, only valid after discovery has been completed */
+		TArray<FDiscoveredModule> DiscoveredModules;
+		bool bCompleted = false;
+	};
+
+	/** Discoveries started in this session, keyed by the module type */
+	static TMap<UClass*, TSharedPtr<FRootModuleDiscovery>> RootModuleDiscoveries;
+
+	/** Finds existing discovery for the module type or starts a new one, dropping cached discovery if module classes have been recompiled */
+	static TSharedRef<FRootModuleDiscovery> FindOrStartDiscovery(UClass* ModuleType);
+
+	/** Collects loaded module classes, orders them by the plugin dependencies and fires pending callbacks. Does nothing if discovery is already completed */
+	static void CompleteDiscovery(UClass* ModuleType, const TSharedRef<FRootModuleDiscovery>& Discovery);
+
+	/** Checks that loaded class is a non-abstract root module of the provided type */
+	static bool IsValidRootModuleClass(UClass* RootModuleClass, UClass* ModuleType);
+
+	/** Stable sorts modules so that modules of the plugin dependencies come before modules of the dependent plugins */
+	static void SortModulesByPluginDependencies(TArray<FDiscoveredModule>& Modules);
+};
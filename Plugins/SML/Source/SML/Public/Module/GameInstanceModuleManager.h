@@ -1,6 +1,7 @@
 #pragma once
 #include "Subsystems/GameInstanceSubsystem.h"
 #include "Module/GameInstanceModule.h"
+#include "Module/LifecycleDispatchWaves.h"
 #include "GameInstanceModuleManager.generated.h"
 
 /** Manages registered game instance modules and their lifecycle event processing */
@@ -15,6 +16,9 @@ private:
     /** Root module list for fast iteration according to order of registration */
     UPROPERTY()
     TArray<UGameInstanceModule*> RootModuleList;
+
+    /** Root modules grouped by their mod dependencies, built once all root modules are constructed */
+    FLifecycleDispatchWaves LifecycleDispatchWaves;
 public:
     UGameInstanceModuleManager();
     
@@ -0,0 +1,33 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Module/ModModule.h"
+
+/**
+ * Root modules grouped into waves by the plugin descriptor dependencies of their owning mods,
+ * including the transitive ones going through plugins that have no root modules of this type
+ * Modules in every wave only depend on the modules from the earlier waves, so modules inside of the wave
+ * are independent from each other and their thread safe lifecycle preparation can run concurrently
+ */
+struct SML_API FLifecycleDispatchWaves {
+    /** Root modules of every wave, in the order of their registration */
+    TArray<TArray<UModModule*>> Waves;
+
+    /** Groups provided root modules into the dependency waves. On dependency cycle, every module gets it's own wave */
+    template<typename T>
+    static FLifecycleDispatchWaves Build(const TArray<T*>& RootModules) {
+        return BuildInternal(TArray<UModModule*>(RootModules));
+    }
+
+    /**
+     * Dispatches lifecycle event wave by wave
+     * Every module is prepared for the phase first, concurrently for the modules declaring it as thread safe,
+     * and then lifecycle event is dispatched on the game thread in the order of registration
+     * Lifecycle events themselves are never dispatched concurrently, so only heavy work moved into the native
+     * PrepareLifecyclePhase overrides avoids waiting behind unrelated modules
+     *
+     * @param TimelineCategory category used for the phase timeline spans, must be a string literal
+     */
+    void Dispatch(ELifecyclePhase Phase, const TCHAR* TimelineCategory) const;
+private:
+    static FLifecycleDispatchWaves BuildInternal(const TArray<UModModule*>& RootModules);
+};
@@ -57,7 +57,24 @@ public:
     /** Handles received lifecycle event and dispatches it to all modules */
     virtual void DispatchLifecycleEvent(ELifecyclePhase Phase);
 
+    /**
+     * Returns true if PrepareLifecyclePhase of this module is thread safe for the provided phase
+     * Thread safe preparation runs on the worker threads, concurrently with other root modules of the same dependency wave
+     * Only preparation can run concurrently, DispatchLifecycleEvent is always called on the game thread, one module after another
+     * Not exposed to blueprints on purpose, since blueprint code cannot run on the worker threads. Only native modules can opt in
+     */
+    virtual bool IsLifecyclePhaseThreadSafe(ELifecyclePhase Phase) const { return false; }
+
+    /**
+     * Called on the root modules right before lifecycle event is dispatched to them, intended for heavy non-UObject data preparation
+     * When IsLifecyclePhaseThreadSafe returns true for the phase, it is called on a worker thread and must not touch other objects or game state
+     */
+    virtual void PrepareLifecyclePhase(ELifecyclePhase Phase) {}
+
     static FString LifecyclePhaseToString(ELifecyclePhase Phase);
+
+    /** Returns static name of the lifecycle phase, which unlike LifecyclePhaseToString does not allocate */
+    static const TCHAR* GetLifecyclePhaseName(ELifecyclePhase Phase);
 protected:
     /** Called when module receives lifetime event */
     UFUNCTION(BlueprintImplementableEvent, meta = (DisplayName = "On Lifecycle Event"))
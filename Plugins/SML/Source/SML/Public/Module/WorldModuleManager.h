@@ -2,6 +2,7 @@
 #include "CoreMinimal.h"
 #include "LatentActions.h"
 #include "Module/WorldModule.h"
+#include "Module/LifecycleDispatchWaves.h"
 #include "WorldModuleManager.generated.h"
 
 /** Manages registered world modules and their lifecycle events */
@@ -16,6 +17,9 @@ private:
     /** Root module list for fast iteration according to order of registration */
     UPROPERTY()
     TArray<UWorldModule*> RootModuleList;
+
+    /** Root modules grouped by their mod dependencies, built once all root modules are constructed */
+    FLifecycleDispatchWaves LifecycleDispatchWaves;
 public:
     /** Retrieves world module by provided mod reference */
     UFUNCTION(BlueprintPure)
@@ -46,7 +50,7 @@ private:
     /** Allocates root module object for instance and registers it */
     void CreateRootModule(const FName& ModReference, TSubclassOf<UWorldModule> ObjectClass);
 
-    /** Dispatches lifecycle event to all registered modules */
+    /** Dispatches lifecycle event to all registered modules, in waves ordered by their mod dependencies */
     void DispatchLifecycleEvent(ELifecyclePhase Phase);
 };
 
@@ -0,0 +1,74 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Templates/UniquePtr.h"
+
+/** Base of the values stored in the connection metadata slots, allows destroying them without knowing their type */
+struct FConnectionMetadataSlotValue {
+    virtual ~FConnectionMetadataSlotValue() {}
+};
+
+template<typename T>
+struct TConnectionMetadataSlotValue : FConnectionMetadataSlotValue {
+    T Value;
+};
+
+class SML_API FConnectionMetadataSlotRegistry {
+public:
+    /** Allocates index for the new slot. Slots are expected to be registered during static initialization on the single thread */
+    static int32 AllocateSlotIndex();
+
+    /** Returns amount of slots registered so far */
+    static int32 GetNumSlots();
+};
+
+/**
+ * Typed per connection metadata slot
+ * Slot should be declared as a static variable, which registers it and assigns it a fixed index,
+ * so value of the slot is retrieved from the connection metadata by indexing an array instead of the name lookup
+ */
+template<typename T>
+class TConnectionMetadataSlot {
+private:
+    int32 SlotIndex;
+public:
+    TConnectionMetadataSlot() : SlotIndex(FConnectionMetadataSlotRegistry::AllocateSlotIndex()) {
+    }
+
+    FORCEINLINE int32 GetSlotIndex() const { return SlotIndex; }
+
+    TConnectionMetadataSlot(const TConnectionMetadataSlot&) = delete;
+    TConnectionMetadataSlot& operator=(const TConnectionMetadataSlot&) = delete;
+};
+
+/**
+ * Values of the metadata slots of a single connection
+ * Values are allocated on first access and have stable addresses, they are destroyed together with the connection metadata
+ */
+struct FConnectionMetadataSlots {
+private:
+    TArray<TUniquePtr<FConnectionMetadataSlotValue>> Values;
+public:
+    /** Returns value of the slot, default constructing it if it does not exist yet */
+    template<typename T>
+    T& FindOrAdd(const TConnectionMetadataSlot<T>& Slot) {
+        const int32 SlotIndex = Slot.GetSlotIndex();
+        if (SlotIndex >= Values.Num()) {
+            Values.SetNum(FMath::Max(FConnectionMetadataSlotRegistry::GetNumSlots(), SlotIndex + 1));
+        }
+        TUniquePtr<FConnectionMetadataSlotValue>& Value = Values[SlotIndex];
+        if (!Value.IsValid()) {
+            Value = MakeUnique<TConnectionMetadataSlotValue<T>>();
+        }
+        return static_cast<TConnectionMetadataSlotValue<T>*>(Value.Get())->Value;
+    }
+
+    /** Returns value of the slot, or nullptr if it has not been created yet */
+    template<typename T>
+    T* Find(const TConnectionMetadataSlot<T>& Slot) const {
+        const int32 SlotIndex = Slot.GetSlotIndex();
+        if (SlotIndex < Values.Num() && Values[SlotIndex].IsValid()) {
+            return &static_cast<TConnectionMetadataSlotValue<T>*>(Values[SlotIndex].Get())->Value;
+        }
+        return nullptr;
+    }
+};
@@ -3,22 +3,78 @@
 #include "Subsystems/EngineSubsystem.h"
 #include "UObject/Object.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Network/ConnectionMetadataSlot.h"
 #include "NetworkHandler.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogModNetworkHandler, Log, All);
 DECLARE_DELEGATE_TwoParams(FMessageReceived, class UNetConnection* /*Connection*/, FString /*Data*/);
+DECLARE_DELEGATE_TwoParams(FLargeMessageReceived, class UNetConnection* /*Connection*/, const TArray<uint8>& /*Payload*/);
 DECLARE_MULTICAST_DELEGATE_TwoParams(FWelcomePlayer, UWorld* /*ServerWorld*/, class UNetConnection* /*Connection*/);
 DECLARE_MULTICAST_DELEGATE_OneParam(FClientInitialJoin, class UNetConnection* /*Connection*/);
 
 struct FMessageType {
     FString ModReference;
     int32 MessageId;
+    /** Local channel id of the message type, cached on registration or first lookup. Never set it manually */
+    mutable int32 CachedChannelId = INDEX_NONE;
 };
 
 struct FMessageEntry {
     bool bClientHandled;
     bool bServerHandled;
     FMessageReceived MessageReceived;
+    /** Called once large binary message sent with SendLargeMessage has been fully received and decompressed */
+    FLargeMessageReceived LargeMessageReceived;
+};
+
+/**
+ * Channel ids agreed with the remote side of the connection
+ * Every side sends the table of it's registered message types during the SML handshake,
+ * and messages are then sent using the compact local channel id instead of the mod reference string
+ */
+struct FModChannelConnectionState {
+    /** Maps channel ids of the remote side to the local channel ids, INDEX_NONE for message types not registered locally */
+    TArray<int32> RemoteToLocalChannels;
+    /** Amount of local channels sent to the remote side, channels registered later are sent with their string identifiers */
+    int32 NumLocalChannelsSent = 0;
+    /** True once remote side has sent it's channel table, which means it understands channel messages */
+    bool bRemoteSupportsChannels = false;
+
+    FORCEINLINE bool CanSendOnChannel(int32 ChannelId) const {
+        return bRemoteSupportsChannels && ChannelId < NumLocalChannelsSent;
+    }
+};
+
+/** Large message waiting to be sent in chunks */
+struct FOutgoingLargeMessage {
+    uint32 TransferId;
+    uint16 ChannelId;
+    int32 UncompressedSize;
+    /** Compressed payload, or raw payload if compression did not make it smaller */
+    TArray<uint8> Data;
+    int32 BytesSent = 0;
+    bool bBeginSent = false;
+};
+
+/** Large message being reassembled from the received chunks */
+struct FIncomingLargeMessage {
+    uint16 RemoteChannelId;
+    int32 UncompressedSize;
+    int32 DataSize;
+    /** Received data, grown as chunks arrive so announced but never sent data does not occupy any memory */
+    TArray<uint8> Data;
+    /** Time the last part of the message has been received at, stalled transfers are dropped after a timeout */
+    double LastReceiveTime;
+};
+
+/** Large message transfers of a single connection */
+struct FLargeMessageConnectionState {
+    /** Messages are sent one after another, in the order they were queued */
+    TArray<FOutgoingLargeMessage> OutgoingMessages;
+    TMap<uint32, FIncomingLargeMessage> IncomingMessages;
+    uint32 NextTransferId = 0;
+    /** Amount of bytes connection is allowed to send right now, refilled every tick according to the throughput limit */
+    double SendAllowance = 0.0;
 };
 
 /**
@@ -38,12 +94,44 @@ class SML_API UModNetworkHandler : public UEngineSubsystem {
 private:
     UPROPERTY()
     TMap<TWeakObjectPtr<class UNetConnection>, class UObjectMetadata*> Metadata;
-    TMap<FString, TMap<int32, FMessageEntry>> MessageHandlers;
+    /** Registered message entries, indexed by their local channel id */
+    TIndirectArray<FMessageEntry> MessageChannels;
+    /** Local channel ids of the registered message types, used to resolve messages sent with string identifiers */
+    TMap<FString, TMap<int32, int32>> ChannelIdsByMessageType;
+    /** Values of the typed metadata slots of every connection */
+    TMap<TWeakObjectPtr<class UNetConnection>, FConnectionMetadataSlots> ConnectionMetadataSlots;
+    /** Message type used to exchange channel tables, sent as a regular mod message so remote sides not supporting channels ignore it */
+    FMessageType MessageTypeChannelTable;
+    FDelegateHandle LargeMessageTickerHandle;
+    /** Handles of the native hooks subscribed by this subsystem */
+    FDelegateHandle CleanUpHookHandle;
+    FDelegateHandle WelcomePlayerHookHandle;
+    FDelegateHandle SendInitialJoinHookHandle;
+    FDelegateHandle WorldControlMessageHookHandle;
+    FDelegateHandle PendingGameControlMessageHookHandle;
     FWelcomePlayer WelcomePlayerDelegate;
     FClientInitialJoin ClientLoginDelegate;
 private:
+    FConnectionMetadataSlots& GetOrCreateMetadataSlots(class UNetConnection* Connection);
+    const FConnectionMetadataSlots* FindMetadataSlots(class UNetConnection* Connection) const;
+
     void ReceiveMessage(class UNetConnection* Connection, const FString& ModId, int32 MessageId, const FString& Content) const;
+    void ReceiveChannelMessage(class UNetConnection* Connection, uint16 RemoteChannelId, const FString& Content) const;
+    void DispatchMessage(class UNetConnection* Connection, int32 ChannelId, const FString& Content) const;
+
+    /** Sends table of the local channels to the remote side. Called on client initial join, and on server in response to the client's table */
+    void SendChannelTable(class UNetConnection* Connection);
+    void ReceiveChannelTable(class UNetConnection* Connection, FString Data);
+
+    /** Sends chunks of the queued large messages, limited by the throughput of every connection and it's reliable buffer */
+    bool TickLargeMessages(float DeltaTime);
+    void ReceiveLargeMessageBegin(class UNetConnection* Connection, uint16 RemoteChannelId, uint32 TransferId, int32 DataSize, int32 UncompressedSize);
+    void ReceiveLargeMessageChunk(class UNetConnection* Connection, uint32 TransferId, const TArray<uint8>& ChunkData);
+    void CompleteLargeMessage(class UNetConnection* Connection, FIncomingLargeMessage& Message);
 public:
+    virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+    virtual void Deinitialize() override;
+
     /**
      * Retrieves metadata object for given connection
      * Metadata object can be used to store information related to given connection before
@@ -51,6 +139,22 @@ public:
      */
     class UObjectMetadata* GetMetadataForConnection(UNetConnection* Connection);
 
+    /**
+     * Retrieves value of the typed metadata slot for given connection, default constructing it on first access
+     * Unlike GetMetadataForConnection, it does not perform any name lookups, and value is destroyed once connection is closed
+     */
+    template<typename T>
+    FORCEINLINE T& GetConnectionMetadata(UNetConnection* Connection, const TConnectionMetadataSlot<T>& Slot) {
+        return GetOrCreateMetadataSlots(Connection).FindOrAdd(Slot);
+    }
+
+    /** Retrieves value of the typed metadata slot for given connection, or nullptr if it has not been created yet */
+    template<typename T>
+    FORCEINLINE T* FindConnectionMetadata(UNetConnection* Connection, const TConnectionMetadataSlot<T>& Slot) const {
+        const FConnectionMetadataSlots* MetadataSlots = FindMetadataSlots(Connection);
+        return MetadataSlots != nullptr ? MetadataSlots->Find(Slot) : nullptr;
+    }
+
     /**
      * Delegate called on server when he received client join request and welcomed new player
      * You can send additional information to client here, or check information received by client
@@ -70,15 +174,28 @@ public:
      */
     FMessageEntry& RegisterMessageType(const FMessageType& MessageType);
 
+    /** Returns local channel id of the registered message type, or INDEX_NONE if it is not registered */
+    int32 FindChannelId(const FMessageType& MessageType) const;
+
     static void CloseWithFailureMessage(class UNetConnection* Connection, const FString& Message);
     
     /**
      * Send registered mod message to this connection to be processed on the remote side
+     * Once channel ids have been agreed with the remote side, message is sent using it's compact channel id
      */
-    static void SendMessage(class UNetConnection* Connection, FMessageType MessageType, FString Data);
-private:
-    friend class FSatisfactoryModLoader;
+    static void SendMessage(class UNetConnection* Connection, const FMessageType& MessageType, FString Data);
 
+    /**
+     * Queues binary payload to be sent to this connection and processed by LargeMessageReceived on the remote side
+     * Payload is compressed and sent in chunks over the following frames, limited by the per connection throughput,
+     * so it can be used for large data like serialized blueprints or configuration snapshots
+     * Requires channel ids of the message type to be agreed with the remote side, e.g message type should be registered before connection is established
+     * @return true if message has been queued for sending
+     */
+    static bool SendLargeMessage(class UNetConnection* Connection, const FMessageType& MessageType, const TArray<uint8>& Payload);
+private:
     /** Registers hooks associated with network handler */
-    static void InitializePatches();
+    void InitializePatches();
+    /** Removes hooks registered by InitializePatches */
+    void RemovePatches();
 };
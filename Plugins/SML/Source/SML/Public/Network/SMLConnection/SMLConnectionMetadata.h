@@ -1,8 +1,19 @@
 #pragma once
+#include "CoreMinimal.h"
 #include "UObject/Object.h"
 #include "Util/SemVersion.h"
 #include "SMLConnectionMetadata.generated.h"
 
+/** SML state of the connection, stored in the typed connection metadata slot */
+struct SML_API FSMLConnectionMetadata {
+    bool bIsInitialized = false;
+    TMap<FString, FVersion> InstalledClientMods;    
+};
+
+/**
+ * Deprecated, use FSMLNetworkManager::SMLMetadataSlot instead
+ * Still filled with the same data under the "SML" subobject of the connection metadata, for mods retrieving it by name
+ */
 UCLASS()
 class SML_API USMLConnectionMetadata : public UObject {
     GENERATED_BODY()
@@ -1,8 +1,13 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "Network/ConnectionMetadataSlot.h"
+#include "Network/SMLConnection/SMLConnectionMetadata.h"
 
 class SML_API FSMLNetworkManager {
 public:
+    /** Metadata slot holding SML state of the connection, e.g mods installed on the client */
+    static TConnectionMetadataSlot<FSMLConnectionMetadata> SMLMetadataSlot;
+
     /** Handles SML message being received on the server side */
     static void HandleMessageReceived(class UNetConnection* Connection, FString Data);
 
@@ -19,7 +24,7 @@ public:
     static FString SerializeLocalModList();
 
     /** Parses packaged json mod list string and sets relevant information on connection */
-    static bool HandleModListObject(class USMLConnectionMetadata* Metadata, const FString& ModList);
+    static bool HandleModListObject(FSMLConnectionMetadata& Metadata, const FString& ModList);
 
     /** Ensures that Connection has required SML initialization data and kicks player off if it doesn't */
     static void ValidateSMLConnectionData(class UNetConnection* Connection);
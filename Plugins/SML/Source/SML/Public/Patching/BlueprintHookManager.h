@@ -2,18 +2,31 @@
 #include "Subsystems/EngineSubsystem.h"
 #include "Engine/Engine.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "Patching/HookProfiler.h"
 #include "BlueprintHookManager.generated.h"
 
 DECLARE_LOG_CATEGORY_EXTERN(LogBlueprintHookManager, Log, All);
 
 using HookFunctionSignature = void(class FBlueprintHookHelper& HookHelper);
 
+/** Single hook installed at the code offset, together with the profiler counter it is attributed to */
+struct FBlueprintHookEntry {
+    TFunction<HookFunctionSignature> Hook;
+    int32 ProfilerCounterId;
+};
+
+/** Hooks installed at a single code offset of the function */
+struct FBlueprintHookList {
+    TArray<FBlueprintHookEntry> Hooks;
+    int32 ProfilerHookId = INDEX_NONE;
+};
+
 /** Holds information about hooked blueprint function */
 USTRUCT()
 struct FFunctionHookInfo {
     GENERATED_BODY()
 private:
-    TMap<int32, TArray<TFunction<HookFunctionSignature>>> CodeOffsetByHookList;
+    TMap<int32, FBlueprintHookList> CodeOffsetByHookList;
     int32 ReturnStatementOffset;
     friend class UBlueprintHookManager;
 public:
@@ -43,8 +56,9 @@ public:
     *
     * Multiple hooks bound to one hook offset will be processed in the order they were registered
     * UClass holding Function will be added to root set to avoid getting Garbage Collected
+    * OwnerName is used to attribute the hook to the mod installing it in the hook profiler
     */
-    void HookBlueprintFunction(UFunction* Function, const TFunction<HookFunctionSignature>& Hook, int32 HookOffset);
+    void HookBlueprintFunction(UFunction* Function, const TFunction<HookFunctionSignature>& Hook, int32 HookOffset, const FString& OwnerName = SML_HOOK_OWNER_NAME);
 private:
     /** Actually performs bytecode modification to install hook */
     static void InstallBlueprintHook(UFunction* Function, int32 HookOffset);
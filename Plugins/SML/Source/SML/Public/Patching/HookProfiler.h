@@ -0,0 +1,161 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "Util/ProfilingToolConsole.h"
+#include <atomic>
+
+DECLARE_LOG_CATEGORY_EXTERN(LogHookProfiler, Log, All);
+
+//Name of the module subscribing to the hook, used to attribute hook handlers to their owning mod in the profiler
+//Expanded at the call site, so it always refers to the module doing the subscription
+#ifdef UE_MODULE_NAME
+#define SML_HOOK_OWNER_NAME TEXT(UE_MODULE_NAME)
+#else
+#define SML_HOOK_OWNER_NAME TEXT("Unknown")
+#endif
+
+/** Kind of the instrumented hook */
+enum class EHookProfilerHookType : uint8 {
+	Native,
+	Blueprint
+};
+
+/** Kind of the profiler counter, every hook has one counter for itself, one for original function and one per handler */
+enum class EHookProfilerCounterType : uint8 {
+	Hook,
+	OriginalFunction,
+	HandlerBefore,
+	HandlerAfter
+};
+
+/** Aggregated counter values, summed across all threads */
+struct SML_API FHookProfilerCounterValue {
+	/** Amount of times counter was hit */
+	uint64 CallCount = 0;
+	/** Amount of times timing has been sampled */
+	uint64 SampleCount = 0;
+	/** Total amount of cycles spent in the sampled calls */
+	uint64 SampledCycles = 0;
+
+	/** Average time of the single sampled call, in microseconds */
+	double GetAverageMicroseconds() const;
+
+	/** Estimated total time across all calls, sampled or not, in milliseconds */
+	double GetEstimatedTotalMilliseconds() const;
+};
+
+/**
+ * Optional instrumentation for native and blueprint hooks
+ * Counts calls of every hook and every handler subscribed to it, and samples timing of every N-th hook dispatch
+ * Counters are thread-local, so hooks running on worker threads do not contend with each other
+ *
+ * Profiling is disabled by default and can be toggled using SML.HookProfiler.Enabled console variable,
+ * results are dumped using SML.HookProfiler.Dump [json|csv] [FilePath] console command
+ * Counters of the removed handlers are dropped from the results, and their ids are reused by the handlers registered later
+ */
+class SML_API FHookProfiler {
+public:
+	/** Registers a new hook and returns a counter id for it */
+	static int32 RegisterHook(const FString& HookName, EHookProfilerHookType HookType);
+
+	/** Returns a counter id used for recording original function calls of the provided hook */
+	static int32 GetOriginalFunctionCounter(int32 HookCounterId);
+
+	/** Registers a handler subscribed to the provided hook, attributed to the owning module or mod */
+	static int32 RegisterHandler(int32 HookCounterId, const FString& OwnerName, EHookProfilerCounterType HandlerType);
+
+	/** Unregisters counter of the handler that has been removed from its hook */
+	static void UnregisterHandler(int32 CounterId);
+
+	/** Returns true if hook profiling is currently enabled. Can be called from any thread */
+	FORCEINLINE static bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+
+	/** Enables or disables hook profiling */
+	static void SetEnabled(bool bNewEnabled);
+
+	/** Records a hook dispatch and returns true if timing should be sampled for it */
+	static bool BeginDispatch(int32 HookCounterId);
+
+	/** Records a single call of the provided counter */
+	static void RecordCall(int32 CounterId);
+
+	/** Records timing sample for the provided counter */
+	static void RecordSample(int32 CounterId, uint64 Cycles);
+
+	/** Resets all of the counters, including the ones belonging to the threads that already exited */
+	static void ResetCounters();
+
+	/** Serializes gathered statistics into JSON string */
+	static FString ExportJson();
+
+	/** Serializes gathered statistics into CSV string, one row per counter */
+	static FString ExportCsv();
+
+	/**
+	 * Dumps gathered statistics into the file in the provided format (json or csv)
+	 * When FilePath is empty, a file in the Saved/Profiling directory is created
+	 * @return true if file has been written successfully
+	 */
+	static bool DumpToFile(const FString& Format, const FString& FilePath, FString& OutFilePath);
+private:
+	static std::atomic<bool> bEnabled;
+	static FProfilingToolConsole Console;
+};
+
+/**
+ * Instruments a single dispatch of the hook
+ * While profiling is off, the dispatch only pays for reading the enabled flag once
+ */
+struct FHookProfilerDispatchScope {
+private:
+	int32 HookCounterId;
+	bool bActive;
+	bool bTimed;
+	uint64 StartCycles;
+	/** Cycles spent in the handlers and the original function called from inside the current handler */
+	uint64 NestedCycles;
+public:
+	FORCEINLINE explicit FHookProfilerDispatchScope(int32 InHookCounterId) :
+		HookCounterId(InHookCounterId), bActive(FHookProfiler::IsEnabled() && InHookCounterId != INDEX_NONE),
+		bTimed(false), StartCycles(0), NestedCycles(0) {
+		if (bActive) {
+			bTimed = FHookProfiler::BeginDispatch(HookCounterId);
+			StartCycles = bTimed ? FPlatformTime::Cycles64() : 0;
+		}
+	}
+
+	FORCEINLINE ~FHookProfilerDispatchScope() {
+		if (bTimed) {
+			FHookProfiler::RecordSample(HookCounterId, FPlatformTime::Cycles64() - StartCycles);
+		}
+	}
+
+	FHookProfilerDispatchScope(const FHookProfilerDispatchScope&) = delete;
+	FHookProfilerDispatchScope& operator=(const FHookProfilerDispatchScope&) = delete;
+
+	/**
+	 * Invokes the handler and attributes time spent in it to the provided counter
+	 * Time spent in the handlers and the original function called by the handler through the scope
+	 * is excluded, so each handler is only charged for its own work
+	 */
+	template<typename TFunc>
+	FORCEINLINE void Invoke(int32 CounterId, TFunc&& Func) {
+		if (!bActive || CounterId == INDEX_NONE) {
+			Func();
+			return;
+		}
+		FHookProfiler::RecordCall(CounterId);
+		if (!bTimed) {
+			Func();
+			return;
+		}
+		const uint64 NestedCyclesBefore = NestedCycles;
+		const uint64 CallStartCycles = FPlatformTime::Cycles64();
+		Func();
+		const uint64 InclusiveCycles = FPlatformTime::Cycles64() - CallStartCycles;
+		const uint64 ChildCycles = NestedCycles - NestedCyclesBefore;
+		FHookProfiler::RecordSample(CounterId, InclusiveCycles > ChildCycles ? InclusiveCycles - ChildCycles : 0);
+		//For the caller this whole call is a nested one
+		NestedCycles = NestedCyclesBefore + InclusiveCycles;
+	}
+};
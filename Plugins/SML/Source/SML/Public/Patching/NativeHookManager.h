@@ -1,5 +1,11 @@
 #pragma once
 #include "CoreMinimal.h"
+#include "Patching/HookProfiler.h"
+#include "Templates/Function.h"
+#include "Templates/TypeCompatibleBytes.h"
+#include "Delegates/IDelegateInstance.h"
+#include "Misc/ScopeLock.h"
+#include <atomic>
 #include <functional>
 #include <type_traits>
 
@@ -52,19 +58,159 @@ public:
 	static void* GetHandlerListInternal(void* RealFunctionAddress);
 	static void SetHandlerListInstanceInternal(void* RealFunctionAddress, void* handlerList);
 	static void* RegisterHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment, void* HookFunctionPointer, void** OutTrampolineFunction);
+
+	/** Resolves the address of the function implementation that should be hooked, following virtual function thunks */
+	static void* ResolveHookFunction(const FString& DebugSymbolName, void* OriginalFunctionPointer, void* SampleObjectInstance, int ThisAdjustment);
+
+	/**
+	 * Installs the hook at the resolved function address, or returns the trampoline of the already installed hook
+	 * Trampoline is published before the function code is patched, so it is always valid once the hook can be entered
+	 */
+	static void InstallHookFunction(const FString& DebugSymbolName, void* ResolvedFunctionPointer, void* HookFunctionPointer, std::atomic<void*>& OutTrampolineFunction);
+
+	/**
+	 * Restores the original code of the function hooked by InstallHookFunction, and publishes the function itself as the trampoline
+	 * Trampoline is only freed once in-flight hook dispatches are finished, but the code itself is patched in place,
+	 * so it should only be done while function is not being entered by other threads
+	 */
+	static void UninstallHookFunction(const FString& DebugSymbolName, void* ResolvedFunctionPointer, std::atomic<void*>& OutTrampolineFunction);
+
+	/** Lock guarding hook installation and handler list modification. Never taken by the hook dispatch */
+	static FCriticalSection* GetHookRegistrationLock();
+
+	/** Marks current thread as executing a hook dispatch, until the matching ExitDispatch call. Returns thread state token */
+	static void* EnterDispatch();
+	static void ExitDispatch(void* ThreadState);
+
+	/**
+	 * Schedules the handler list snapshot for deletion once no thread can observe it anymore
+	 * Should be called with the registration lock held, after the new snapshot has been published
+	 */
+	static void RetireHandlerList(void* HandlerList, void(*Deleter)(void*));
+};
+
+/** Keeps handler list snapshots loaded by the current thread alive for the duration of the hook dispatch */
+struct FNativeHookDispatchGuard {
+private:
+	void* ThreadState;
+public:
+	FORCEINLINE FNativeHookDispatchGuard() : ThreadState(FNativeHookManagerInternal::EnterDispatch()) {}
+	FORCEINLINE ~FNativeHookDispatchGuard() { FNativeHookManagerInternal::ExitDispatch(ThreadState); }
+
+	FNativeHookDispatchGuard(const FNativeHookDispatchGuard&) = delete;
+	FNativeHookDispatchGuard& operator=(const FNativeHookDispatchGuard&) = delete;
 };
 
+/** Hook handler together with the profiler counter it is attributed to and the handle used to unsubscribe it */
+template <typename T>
+struct THookHandlerEntry {
+	T Handler;
+	int32 ProfilerCounterId;
+	FDelegateHandle Handle;
+};
+
+/** Immutable snapshot of the handlers subscribed to the hook, never modified once published */
+template <typename T, typename E>
+struct THandlerListSnapshot {
+	TArray<THookHandlerEntry<T>> HandlersBefore;
+	TArray<THookHandlerEntry<E>> HandlersAfter;
+};
+
+//Handler lists are copy-on-write: registration builds a new snapshot under the registration lock and swaps it in atomically,
+//while the dispatch just loads the current snapshot without taking any locks. Replaced snapshots are reclaimed
+//once every thread that could have loaded them has left its hook dispatch
 template <typename T, typename E>
 struct THandlerLists {
-	TArray<T> HandlersBefore;
-	TArray<E> HandlersAfter;
+	using SnapshotType = THandlerListSnapshot<T, E>;
+
+	std::atomic<const SnapshotType*> Snapshot;
+	int32 ProfilerHookId = INDEX_NONE;
+	int32 ProfilerOriginalFunctionId = INDEX_NONE;
+
+	//Function called to continue into the original code. Shared by the hook invokers of all modules, since either of them
+	//can reinstall the hook, and only loaded inside of the hook dispatch so the retired trampoline outlives its readers
+	std::atomic<void*> TrampolineFunction{nullptr};
+
+	//Hook installation state is shared by the hook invokers of all modules, and is only accessed with the registration lock held
+	void* FunctionAddress = nullptr;
+	FString DebugSymbolName;
+	bool bHookInstalled = false;
+
+	THandlerLists() : Snapshot(new SnapshotType()) {}
+
+	/** Returns the current snapshot. It is only safe to use while FNativeHookDispatchGuard is alive on the calling thread */
+	FORCEINLINE const SnapshotType* GetSnapshot() const {
+		return Snapshot.load(std::memory_order_seq_cst);
+	}
+
+	/** Returns function continuing into the original code. It is only safe to call while FNativeHookDispatchGuard is alive on the calling thread */
+	template <typename TFunction>
+	FORCEINLINE TFunction GetTrampoline() const {
+		return reinterpret_cast<TFunction>(TrampolineFunction.load(std::memory_order_seq_cst));
+	}
+
+	/** Publishes a modified copy of the current snapshot */
+	template <typename TMutator>
+	void Modify(TMutator&& Mutator) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
+		const SnapshotType* OldSnapshot = Snapshot.load(std::memory_order_relaxed);
+		SnapshotType* NewSnapshot = new SnapshotType(*OldSnapshot);
+		Mutator(*NewSnapshot);
+		Snapshot.store(NewSnapshot, std::memory_order_seq_cst);
+		FNativeHookManagerInternal::RetireHandlerList(const_cast<SnapshotType*>(OldSnapshot), &DeleteSnapshot);
+	}
+
+	/**
+	 * Removes handler with the provided handle from the hook, returns false if there was no such handler
+	 * Removed handler is destroyed together with the replaced snapshot, so calls already running it can finish safely
+	 * When bUninstallHookIfUnused is set and no handlers are left, the original function code is restored
+	 */
+	bool RemoveHandler(FDelegateHandle Handle, bool bUninstallHookIfUnused) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
+		const SnapshotType* CurrentSnapshot = Snapshot.load(std::memory_order_relaxed);
+		auto MatchesHandle = [&](const auto& Entry) { return Entry.Handle == Handle; };
+		const bool bHandlerFound = Handle.IsValid() &&
+			(CurrentSnapshot->HandlersBefore.ContainsByPredicate(MatchesHandle) || CurrentSnapshot->HandlersAfter.ContainsByPredicate(MatchesHandle));
+		if (bHandlerFound) {
+			for (const auto& Entry : CurrentSnapshot->HandlersBefore) {
+				if (MatchesHandle(Entry)) {
+					FHookProfiler::UnregisterHandler(Entry.ProfilerCounterId);
+				}
+			}
+			for (const auto& Entry : CurrentSnapshot->HandlersAfter) {
+				if (MatchesHandle(Entry)) {
+					FHookProfiler::UnregisterHandler(Entry.ProfilerCounterId);
+				}
+			}
+			Modify([&](SnapshotType& NewSnapshot) {
+				NewSnapshot.HandlersBefore.RemoveAll(MatchesHandle);
+				NewSnapshot.HandlersAfter.RemoveAll(MatchesHandle);
+			});
+		}
+		const SnapshotType* NewSnapshot = Snapshot.load(std::memory_order_relaxed);
+		if (bUninstallHookIfUnused && bHookInstalled && NewSnapshot->HandlersBefore.Num() == 0 && NewSnapshot->HandlersAfter.Num() == 0) {
+			FNativeHookManagerInternal::UninstallHookFunction(DebugSymbolName, FunctionAddress, TrampolineFunction);
+			bHookInstalled = false;
+		}
+		return bHandlerFound;
+	}
+private:
+	static void DeleteSnapshot(void* HandlerList) {
+		delete static_cast<SnapshotType*>(HandlerList);
+	}
 };
 
 template <typename T, typename E>
-THandlerLists<T, E>* createHandlerLists(void* RealFunctionAddress) {
+THandlerLists<T, E>* createHandlerLists(void* RealFunctionAddress, const FString& DebugSymbolName) {
+	FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
 	void* handlerListRaw = FNativeHookManagerInternal::GetHandlerListInternal(RealFunctionAddress);
 	if (handlerListRaw == nullptr) {
-		handlerListRaw = new THandlerLists<T, E>();
+		THandlerLists<T, E>* NewHandlerLists = new THandlerLists<T, E>();
+		NewHandlerLists->ProfilerHookId = FHookProfiler::RegisterHook(DebugSymbolName, EHookProfilerHookType::Native);
+		NewHandlerLists->ProfilerOriginalFunctionId = FHookProfiler::GetOriginalFunctionCounter(NewHandlerLists->ProfilerHookId);
+		NewHandlerLists->FunctionAddress = RealFunctionAddress;
+		NewHandlerLists->DebugSymbolName = DebugSymbolName;
+		handlerListRaw = NewHandlerLists;
 		FNativeHookManagerInternal::SetHandlerListInstanceInternal(RealFunctionAddress, handlerListRaw);
 	}
 	return static_cast<THandlerLists<T, E>*>(handlerListRaw);
@@ -73,6 +219,31 @@ THandlerLists<T, E>* createHandlerLists(void* RealFunctionAddress) {
 template <typename TCallable, TCallable Callable>
 struct HookInvoker;
 
+//Describes how an argument of the hooked function is passed through the call scope and into the handlers
+//Arguments are stored once in the frame of the hook invoker and passed down by reference, so
+//handlers taking arguments by value only pay for a copy when they actually ask for one
+template<typename T>
+struct THookArgument {
+	using Type = typename std::remove_reference<T>::type;
+	using HandlerType = Type&;
+	using ForwardType = typename std::conditional<std::is_rvalue_reference<T>::value, T, Type&>::type;
+
+	//Binds to the existing argument without copying it
+	static FORCEINLINE Type& Bind(Type& Value) {
+		return Value;
+	}
+
+	//Materializes other values as a temporary, which lives until the end of the full expression
+	static FORCEINLINE Type& Bind(Type&& Value) {
+		return Value;
+	}
+
+	//Passes argument to the original function, restoring rvalue references if function accepts them
+	static FORCEINLINE ForwardType Forward(Type& Value) {
+		return static_cast<ForwardType>(Value);
+	}
+};
+
 template<typename TCallable>
 struct CallScope;
 
@@ -81,18 +252,27 @@ template <typename... Args>
 struct CallScope<void(*)(Args...)> {
 public:
 	typedef void HookType(Args...);
-	typedef void HookFuncSig(CallScope<void(*)(Args...)>&, Args...);
+	typedef void HookFuncSig(CallScope<void(*)(Args...)>&, typename THookArgument<Args>::HandlerType...);
 	typedef std::function<HookFuncSig> HookFunc;
 
+	typedef TArray<THookHandlerEntry<HookFunc>> HookFuncList;
+	typedef TFunctionRef<void(typename THookArgument<Args>::HandlerType...)> OriginalFunc;
+
 private:
-	TArray<HookFunc>* functionList;
+	const HookFuncList* functionList;
 	size_t handlerPtr = 0;
-	HookType* function;
+	OriginalFunc function;
+	FHookProfilerDispatchScope* profilerScope;
+	int32 profilerOriginalFunctionId;
 
 	bool forwardCall = true;
 
 public:
-	CallScope(TArray<HookFunc>* functionList, HookType* function) : functionList(functionList), function(function) {}
+	CallScope(const HookFuncList* functionList, OriginalFunc function, FHookProfilerDispatchScope* profilerScope = nullptr, int32 profilerOriginalFunctionId = INDEX_NONE) :
+		functionList(functionList), function(function), profilerScope(profilerScope), profilerOriginalFunctionId(profilerOriginalFunctionId) {}
+
+	CallScope(const CallScope&) = delete;
+	CallScope& operator=(const CallScope&) = delete;
 
 	inline bool shouldForwardCall() const {
 		return forwardCall;
@@ -102,16 +282,32 @@ public:
 		forwardCall = false;
 	}
 
-	inline void operator()(Args... args) {
+	//Continues the call chain. Arguments matching the hooked function parameter types exactly are passed
+	//down by reference, anything else is converted once into a temporary
+	template<typename... CallArgs>
+	FORCEINLINE void operator()(CallArgs&&... args) {
+		dispatch(THookArgument<Args>::Bind(Forward<CallArgs>(args))...);
+	}
+
+private:
+	void dispatch(typename THookArgument<Args>::HandlerType... args) {
 		if (functionList == nullptr || handlerPtr >= functionList->Num()) {
-			function(args...);
+			if (profilerScope) {
+				profilerScope->Invoke(profilerOriginalFunctionId, [&]() { function(args...); });
+			} else {
+				function(args...);
+			}
 			forwardCall = false;
 		} else {
 			auto cachePtr = handlerPtr + 1;
-			auto& handler = (*functionList)[handlerPtr++];
-			handler(*this, args...);
+			auto& entry = (*functionList)[handlerPtr++];
+			if (profilerScope) {
+				profilerScope->Invoke(entry.ProfilerCounterId, [&]() { entry.Handler(*this, args...); });
+			} else {
+				entry.Handler(*this, args...);
+			}
 			if (handlerPtr == cachePtr && forwardCall) {
-				(*this)(args...);
+				dispatch(args...);
 			}
 		}
 	}
@@ -121,59 +317,130 @@ public:
 template <typename Result, typename... Args>
 struct CallScope<Result(*)(Args...)> {
 public:
-	// typedef Result HookType(Args...);
-	typedef void HookFuncSig(CallScope<Result(*)(Args...)>&, Args...);
+	typedef void HookFuncSig(CallScope<Result(*)(Args...)>&, typename THookArgument<Args>::HandlerType...);
 	typedef std::function<HookFuncSig> HookFunc;
 
-    typedef std::function<Result(Args...)> HookType;
+	typedef TArray<THookHandlerEntry<HookFunc>> HookFuncList;
+	//Original function constructs its result directly into the provided uninitialized storage
+	typedef TFunctionRef<void(Result*, typename THookArgument<Args>::HandlerType...)> OriginalFunc;
 private:
-	TArray<HookFunc>* functionList;
+	const HookFuncList* functionList;
 	size_t handlerPtr = 0;
-	HookType function;
+	OriginalFunc function;
+	FHookProfilerDispatchScope* profilerScope;
+	int32 profilerOriginalFunctionId;
 	
 	bool forwardCall = true;
-	Result result;
+
+	//Result is either built in the caller provided memory, or in the inline storage of the scope
+	Result* resultStorage;
+	bool bResultConstructed = false;
+	TTypeCompatibleBytes<Result> inlineResultStorage;
 
 public:
-	CallScope(TArray<HookFunc>* functionList, HookType function) : functionList(functionList), function(function) {}
+	CallScope(const HookFuncList* functionList, OriginalFunc function, FHookProfilerDispatchScope* profilerScope = nullptr, int32 profilerOriginalFunctionId = INDEX_NONE, Result* externalResultStorage = nullptr) :
+		functionList(functionList), function(function), profilerScope(profilerScope), profilerOriginalFunctionId(profilerOriginalFunctionId),
+		resultStorage(externalResultStorage ? externalResultStorage : inlineResultStorage.GetTypedPtr()) {}
+
+	CallScope(const CallScope&) = delete;
+	CallScope& operator=(const CallScope&) = delete;
+
+	~CallScope() {
+		//Result built in the caller provided memory is owned by the caller now
+		if (bResultConstructed && resultStorage == inlineResultStorage.GetTypedPtr()) {
+			DestructItem(resultStorage);
+		}
+	}
 
 	inline bool shouldForwardCall() {
 		return forwardCall;
 	}
-	inline Result getResult() {
-		return result;
+
+	inline const Result& getResult() {
+		if (!bResultConstructed) {
+			new (resultStorage) Result();
+			bResultConstructed = true;
+		}
+		return *resultStorage;
+	}
+
+	//Moves result out of the scope, should only be called once the call chain is complete
+	inline Result takeResult() {
+		getResult();
+		return MoveTemp(*resultStorage);
 	}
 
 	void Override(const Result& newResult) {
 		this->forwardCall = false;
-		this->result = newResult;
+		setResult(newResult);
+	}
+
+	void Override(Result&& newResult) {
+		this->forwardCall = false;
+		setResult(MoveTemp(newResult));
+	}
+
+	//Continues the call chain. Arguments matching the hooked function parameter types exactly are passed
+	//down by reference, anything else is converted once into a temporary
+	template<typename... CallArgs>
+	FORCEINLINE const Result& operator()(CallArgs&&... args) {
+		dispatch(THookArgument<Args>::Bind(Forward<CallArgs>(args))...);
+		return getResult();
+	}
+
+private:
+	template<typename TValue>
+	void setResult(TValue&& newResult) {
+		if (bResultConstructed) {
+			*resultStorage = Forward<TValue>(newResult);
+		} else {
+			new (resultStorage) Result(Forward<TValue>(newResult));
+			bResultConstructed = true;
+		}
+	}
+
+	void callOriginal(typename THookArgument<Args>::HandlerType... args) {
+		//Original function always constructs a new result, so get rid of the previous one first
+		if (bResultConstructed) {
+			DestructItem(resultStorage);
+			bResultConstructed = false;
+		}
+		function(resultStorage, args...);
+		bResultConstructed = true;
 	}
 
-	inline Result operator()(Args... args) {
+	void dispatch(typename THookArgument<Args>::HandlerType... args) {
 		if (functionList == nullptr || handlerPtr >= functionList->Num()) {
-			result = function(args...);
+			if (profilerScope) {
+				profilerScope->Invoke(profilerOriginalFunctionId, [&]() { callOriginal(args...); });
+			} else {
+				callOriginal(args...);
+			}
 			this->forwardCall = false;
 		} else {
 			auto cachePtr = handlerPtr + 1;
-			auto handler = (*functionList)[handlerPtr++];
-			handler(*this, args...);
+			auto& entry = (*functionList)[handlerPtr++];
+			if (profilerScope) {
+				profilerScope->Invoke(entry.ProfilerCounterId, [&]() { entry.Handler(*this, args...); });
+			} else {
+				entry.Handler(*this, args...);
+			}
 			if (handlerPtr == cachePtr && forwardCall) {
-				(*this)(args...);
+				dispatch(args...);
 			}
 		}
-		return result;
 	}
 };
 
 template<typename Ret, typename... A>
 class HandlerAfterFunc {
 public:
-	typedef void Value(const Ret&, A...);
+	typedef void Value(const Ret&, typename THookArgument<A>::HandlerType...);
 };
 template<typename... A>
 class HandlerAfterFunc<void, A...> {
 public:
-	typedef void Value(A...);
+	typedef void Value(typename THookArgument<A>::HandlerType...);
 };
 
 template<typename T>
@@ -187,29 +454,45 @@ struct HookInvokerExecutorGlobalFunction {
 public:
 	using HookType = TCallable;
 	using ScopeType = CallScope<TCallable>;
-	using HandlerSignature = void(ScopeType&, ArgumentTypes...);
+	using HandlerSignature = typename ScopeType::HookFuncSig;
 	using HandlerSignatureAfter = typename HandlerAfterFunc<ReturnType, ArgumentTypes...>::Value;
 	using Handler = std::function<HandlerSignature>;
 	using HandlerAfter = std::function<HandlerSignatureAfter>;
+	using HandlerListsType = THandlerLists<Handler, HandlerAfter>;
 private:
-	static TArray<Handler>* handlersBefore;
-	static TArray<HandlerAfter>* handlersAfter;
-	static TCallable functionPtr;
+	static HandlerListsType* handlerLists;
 	static bool bHookInitialized;
 public:
+	//Arguments received here are the only copies made by the hook itself, everything below passes them by reference
 	static ReturnType applyCall(ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
+		//Trampoline is loaded inside of the dispatch, so it cannot be freed by the hook being uninstalled concurrently
+		FNativeHookDispatchGuard dispatchGuard;
+		const TCallable functionPtr = handlerLists->template GetTrampoline<TCallable>();
+		auto Original = [functionPtr](ReturnType* resultStorage, typename THookArgument<ArgumentTypes>::HandlerType... args_) {
+			new (resultStorage) ReturnType(functionPtr(THookArgument<ArgumentTypes>::Forward(args_)...));
+		};
+		const typename HandlerListsType::SnapshotType* handlers = handlerLists->GetSnapshot();
+		FHookProfilerDispatchScope profilerScope(handlerLists->ProfilerHookId);
+		ScopeType scope(&handlers->HandlersBefore, Original, &profilerScope, handlerLists->ProfilerOriginalFunctionId);
 		scope(args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(scope.getResult(), args...);
-		return scope.getResult();
+		const ReturnType& result = scope.getResult();
+		for (const THookHandlerEntry<HandlerAfter>& entry : handlers->HandlersAfter)
+			profilerScope.Invoke(entry.ProfilerCounterId, [&]() { entry.Handler(result, args...); });
+		return scope.takeResult();
 	}
 
 	static void applyCallVoid(ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
+		FNativeHookDispatchGuard dispatchGuard;
+		const TCallable functionPtr = handlerLists->template GetTrampoline<TCallable>();
+		auto Original = [functionPtr](typename THookArgument<ArgumentTypes>::HandlerType... args_) {
+			functionPtr(THookArgument<ArgumentTypes>::Forward(args_)...);
+		};
+		const typename HandlerListsType::SnapshotType* handlers = handlerLists->GetSnapshot();
+		FHookProfilerDispatchScope profilerScope(handlerLists->ProfilerHookId);
+		ScopeType scope(&handlers->HandlersBefore, Original, &profilerScope, handlerLists->ProfilerOriginalFunctionId);
 		scope(args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(args...);
+		for (const THookHandlerEntry<HandlerAfter>& entry : handlers->HandlersAfter)
+			profilerScope.Invoke(entry.ProfilerCounterId, [&]() { entry.Handler(args...); });
 	}
 
 private:
@@ -228,22 +511,49 @@ public:
 	//This hook invoker is for global non-member static functions, so we don't have to deal with
 	//member function pointers and virtual functions here
 	static void InstallHook(const FString& DebugSymbolName) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
 		if (!bHookInitialized) {
 			bHookInitialized = true;
-			void* HookFunctionPointer = static_cast<void*>(getApplyCall());
-			void* RealFunctionAddress = FNativeHookManagerInternal::RegisterHookFunction(DebugSymbolName, Callable, NULL, 0, HookFunctionPointer, (void**) &functionPtr);
-			auto* HandlerLists = createHandlerLists<Handler, HandlerAfter>(RealFunctionAddress);
-			handlersBefore = &HandlerLists->HandlersBefore;
-			handlersAfter = &HandlerLists->HandlersAfter;
+			void* RealFunctionAddress = FNativeHookManagerInternal::ResolveHookFunction(DebugSymbolName, Callable, NULL, 0);
+			//Handler lists should be ready before the hook is installed, since it can be called from any thread right away
+			handlerLists = createHandlerLists<Handler, HandlerAfter>(RealFunctionAddress, DebugSymbolName);
 		}
+		ensureHookInstalled();
+	}
+
+	static FDelegateHandle addHandlerBefore(Handler handler, const FString& OwnerName = SML_HOOK_OWNER_NAME) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
+		//Hook could have been uninstalled by the last handler removed in between InstallHook and this call
+		ensureHookInstalled();
+		const int32 ProfilerCounterId = FHookProfiler::RegisterHandler(handlerLists->ProfilerHookId, OwnerName, EHookProfilerCounterType::HandlerBefore);
+		const FDelegateHandle Handle(FDelegateHandle::GenerateNewHandle);
+		handlerLists->Modify([&](typename HandlerListsType::SnapshotType& Snapshot) {
+			Snapshot.HandlersBefore.Add(THookHandlerEntry<Handler>{MoveTemp(handler), ProfilerCounterId, Handle});
+		});
+		return Handle;
 	}
 
-	static void addHandlerBefore(Handler handler) {
-		handlersBefore->Add(handler);
+	static FDelegateHandle addHandlerAfter(HandlerAfter handler, const FString& OwnerName = SML_HOOK_OWNER_NAME) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
+		ensureHookInstalled();
+		const int32 ProfilerCounterId = FHookProfiler::RegisterHandler(handlerLists->ProfilerHookId, OwnerName, EHookProfilerCounterType::HandlerAfter);
+		const FDelegateHandle Handle(FDelegateHandle::GenerateNewHandle);
+		handlerLists->Modify([&](typename HandlerListsType::SnapshotType& Snapshot) {
+			Snapshot.HandlersAfter.Add(THookHandlerEntry<HandlerAfter>{MoveTemp(handler), ProfilerCounterId, Handle});
+		});
+		return Handle;
 	}
 
-	static void addHandlerAfter(HandlerAfter handler) {
-		handlersAfter->Add(handler);
+	static bool removeHandler(FDelegateHandle Handle, bool bUninstallHookIfUnused = false) {
+		return handlerLists != nullptr && handlerLists->RemoveHandler(Handle, bUninstallHookIfUnused);
+	}
+private:
+	static void ensureHookInstalled() {
+		if (!handlerLists->bHookInstalled) {
+			void* HookFunctionPointer = static_cast<void*>(getApplyCall());
+			FNativeHookManagerInternal::InstallHookFunction(handlerLists->DebugSymbolName, handlerLists->FunctionAddress, HookFunctionPointer, handlerLists->TrampolineFunction);
+			handlerLists->bHookInstalled = true;
+		}
 	}
 };
 
@@ -255,34 +565,37 @@ public:
 	using CallScopeFunctionSignature = ReturnType(*)(ConstCorrectThisPtr, ArgumentTypes...); 
 	typedef CallScope<CallScopeFunctionSignature> ScopeType;
 	
-	typedef void HandlerSignature(ScopeType&, ConstCorrectThisPtr, ArgumentTypes...);
+	typedef typename ScopeType::HookFuncSig HandlerSignature;
 	typedef typename HandlerAfterFunc<ReturnType, ConstCorrectThisPtr, ArgumentTypes...>::Value HandlerSignatureAfter;
 	typedef ReturnType HookType(ConstCorrectThisPtr, ArgumentTypes...);
 
 	using Handler = std::function<HandlerSignature>;
 	using HandlerAfter = std::function<HandlerSignatureAfter>;
+	using HandlerListsType = THandlerLists<Handler, HandlerAfter>;
 private:
-    static TArray<Handler>* handlersBefore;
-	static TArray<HandlerAfter>* handlersAfter;
-	static HookType* functionPtr;
+	static HandlerListsType* handlerLists;
 	static bool bHookInitialized;
 
 	//Methods which return class/struct/union by value have out pointer inserted
 	//as first parameter after this pointer, with all arguments shifted right by 1 for it
+	//The scope builds the result directly in the caller provided outReturnValue memory,
+	//and the original function is passed that memory as its own out pointer, so the result is never copied
 	static ReturnType* applyCallUserTypeByValue(CallableType* self, ReturnType* outReturnValue, ArgumentTypes... args) {
-		// Capture the pointer of the return value
-		// so ScopeType does not have to know about that special case
-		auto Trampoline = [&](ConstCorrectThisPtr self_, ArgumentTypes... args_) -> ReturnType {
-			(reinterpret_cast<ReturnType*(*)(ConstCorrectThisPtr, ReturnType*, ArgumentTypes...)>(functionPtr))(self_, outReturnValue, args_...);
-			return *outReturnValue;
+		FNativeHookDispatchGuard dispatchGuard;
+		using UserTypeByValueSignature = ReturnType*(*)(ConstCorrectThisPtr, ReturnType*, ArgumentTypes...);
+		const UserTypeByValueSignature functionPtr = handlerLists->template GetTrampoline<UserTypeByValueSignature>();
+		auto Original = [functionPtr](ReturnType* resultStorage, ConstCorrectThisPtr& self_, typename THookArgument<ArgumentTypes>::HandlerType... args_) {
+			functionPtr(self_, resultStorage, THookArgument<ArgumentTypes>::Forward(args_)...);
 		};
-
-		ScopeType scope(handlersBefore, Trampoline);
-		scope(self, args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(scope.getResult(), self, args...);
-		//We always return outReturnValue, so copy our result to output variable and return it
-		*outReturnValue = scope.getResult();
+		ConstCorrectThisPtr selfPtr = self;
+
+		const typename HandlerListsType::SnapshotType* handlers = handlerLists->GetSnapshot();
+		FHookProfilerDispatchScope profilerScope(handlerLists->ProfilerHookId);
+		ScopeType scope(&handlers->HandlersBefore, Original, &profilerScope, handlerLists->ProfilerOriginalFunctionId, outReturnValue);
+		scope(selfPtr, args...);
+		const ReturnType& result = scope.getResult();
+		for (const THookHandlerEntry<HandlerAfter>& entry : handlers->HandlersAfter)
+			profilerScope.Invoke(entry.ProfilerCounterId, [&]() { entry.Handler(result, selfPtr, args...); });
 		return outReturnValue;
 	}
 
@@ -290,19 +603,38 @@ private:
 	//If it were returning user type by value, first argument would be R*, which is incorrect - that's why we need separate
 	//applyCallUserType with correct argument order
 	static ReturnType applyCallScalar(CallableType* self, ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
-		scope(self, args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(scope.getResult(), self, args...);
-		return scope.getResult();
+		FNativeHookDispatchGuard dispatchGuard;
+		HookType* functionPtr = handlerLists->template GetTrampoline<HookType*>();
+		auto Original = [functionPtr](ReturnType* resultStorage, ConstCorrectThisPtr& self_, typename THookArgument<ArgumentTypes>::HandlerType... args_) {
+			new (resultStorage) ReturnType(functionPtr(self_, THookArgument<ArgumentTypes>::Forward(args_)...));
+		};
+		ConstCorrectThisPtr selfPtr = self;
+
+		const typename HandlerListsType::SnapshotType* handlers = handlerLists->GetSnapshot();
+		FHookProfilerDispatchScope profilerScope(handlerLists->ProfilerHookId);
+		ScopeType scope(&handlers->HandlersBefore, Original, &profilerScope, handlerLists->ProfilerOriginalFunctionId);
+		scope(selfPtr, args...);
+		const ReturnType& result = scope.getResult();
+		for (const THookHandlerEntry<HandlerAfter>& entry : handlers->HandlersAfter)
+			profilerScope.Invoke(entry.ProfilerCounterId, [&]() { entry.Handler(result, selfPtr, args...); });
+		return scope.takeResult();
 	}
 
 	//Call for void return type - nothing special to do with void
 	static void applyCallVoid(CallableType* self, ArgumentTypes... args) {
-		ScopeType scope(handlersBefore, functionPtr);
-		scope(self, args...);
-		for (HandlerAfter& handler : *handlersAfter)
-			handler(self, args...);
+		FNativeHookDispatchGuard dispatchGuard;
+		HookType* functionPtr = handlerLists->template GetTrampoline<HookType*>();
+		auto Original = [functionPtr](ConstCorrectThisPtr& self_, typename THookArgument<ArgumentTypes>::HandlerType... args_) {
+			functionPtr(self_, THookArgument<ArgumentTypes>::Forward(args_)...);
+		};
+		ConstCorrectThisPtr selfPtr = self;
+
+		const typename HandlerListsType::SnapshotType* handlers = handlerLists->GetSnapshot();
+		FHookProfilerDispatchScope profilerScope(handlerLists->ProfilerHookId);
+		ScopeType scope(&handlers->HandlersBefore, Original, &profilerScope, handlerLists->ProfilerOriginalFunctionId);
+		scope(selfPtr, args...);
+		for (const THookHandlerEntry<HandlerAfter>& entry : handlers->HandlersAfter)
+			profilerScope.Invoke(entry.ProfilerCounterId, [&]() { entry.Handler(selfPtr, args...); });
 	}
 
     static void* getApplyCall1(std::true_type) {
@@ -330,31 +662,56 @@ private:
 public:
 	//Handles normal member function hooking, e.g hooking fixed symbol implementation in executable
 	static void InstallHook(const FString& DebugSymbolName, void* SampleObjectInstance = NULL) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
 		if (!bHookInitialized) {
 			bHookInitialized = true;
-			void* HookFunctionPointer = getApplyCall();
 			TMemberFunctionPointer<TCallable> RawFunctionPointer{};
 			RawFunctionPointer.MemberFunctionPointer = Callable;
 			const FMemberFunctionPointer MemberFunctionPointer = ConvertFunctionPointer(&RawFunctionPointer);
 			
-			void* RealFunctionAddress = FNativeHookManagerInternal::RegisterHookFunction(DebugSymbolName,
+			void* RealFunctionAddress = FNativeHookManagerInternal::ResolveHookFunction(DebugSymbolName,
 				MemberFunctionPointer.FunctionAddress,
 				SampleObjectInstance,
-				MemberFunctionPointer.ThisAdjustment,
-				HookFunctionPointer, (void**) &functionPtr);
+				MemberFunctionPointer.ThisAdjustment);
 			
-			auto* HandlerLists = createHandlerLists<Handler, HandlerAfter>(RealFunctionAddress);
-			handlersBefore = &HandlerLists->HandlersBefore;
-			handlersAfter = &HandlerLists->HandlersAfter;
+			//Handler lists should be ready before the hook is installed, since it can be called from any thread right away
+			handlerLists = createHandlerLists<Handler, HandlerAfter>(RealFunctionAddress, DebugSymbolName);
 		}
+		ensureHookInstalled();
+	}
+
+	static FDelegateHandle addHandlerBefore(Handler handler, const FString& OwnerName = SML_HOOK_OWNER_NAME) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
+		//Hook could have been uninstalled by the last handler removed in between InstallHook and this call
+		ensureHookInstalled();
+		const int32 ProfilerCounterId = FHookProfiler::RegisterHandler(handlerLists->ProfilerHookId, OwnerName, EHookProfilerCounterType::HandlerBefore);
+		const FDelegateHandle Handle(FDelegateHandle::GenerateNewHandle);
+		handlerLists->Modify([&](typename HandlerListsType::SnapshotType& Snapshot) {
+			Snapshot.HandlersBefore.Add(THookHandlerEntry<Handler>{MoveTemp(handler), ProfilerCounterId, Handle});
+		});
+		return Handle;
 	}
 
-	static void addHandlerBefore(Handler handler) {
-		handlersBefore->Add(handler);
+	static FDelegateHandle addHandlerAfter(HandlerAfter handler, const FString& OwnerName = SML_HOOK_OWNER_NAME) {
+		FScopeLock ScopeLock(FNativeHookManagerInternal::GetHookRegistrationLock());
+		ensureHookInstalled();
+		const int32 ProfilerCounterId = FHookProfiler::RegisterHandler(handlerLists->ProfilerHookId, OwnerName, EHookProfilerCounterType::HandlerAfter);
+		const FDelegateHandle Handle(FDelegateHandle::GenerateNewHandle);
+		handlerLists->Modify([&](typename HandlerListsType::SnapshotType& Snapshot) {
+			Snapshot.HandlersAfter.Add(THookHandlerEntry<HandlerAfter>{MoveTemp(handler), ProfilerCounterId, Handle});
+		});
+		return Handle;
 	}
 
-	static void addHandlerAfter(HandlerAfter handler) {
-		handlersAfter->Add(handler);
+	static bool removeHandler(FDelegateHandle Handle, bool bUninstallHookIfUnused = false) {
+		return handlerLists != nullptr && handlerLists->RemoveHandler(Handle, bUninstallHookIfUnused);
+	}
+private:
+	static void ensureHookInstalled() {
+		if (!handlerLists->bHookInstalled) {
+			FNativeHookManagerInternal::InstallHookFunction(handlerLists->DebugSymbolName, handlerLists->FunctionAddress, getApplyCall(), handlerLists->TrampolineFunction);
+			handlerLists->bHookInstalled = true;
+		}
 	}
 };
 
@@ -373,48 +730,52 @@ template<typename R, typename... A, R(*Callable)(A...)>
 struct HookInvoker<R(*)(A...), Callable> : HookInvokerExecutorGlobalFunction<R(*)(A...), Callable, R, A...> {
 };
 
-template <typename TCallable, TCallable Callable, bool bIsConst, typename ReturnType, typename CallableType, typename... ArgumentTypes>
-typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::HookType* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::functionPtr = nullptr;
-
 template <typename TCallable, TCallable Callable, bool bIsConst, typename ReturnType, typename CallableType, typename... ArgumentTypes>
 bool HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::bHookInitialized = false;
 
 template <typename TCallable, TCallable Callable, bool bIsConst, typename ReturnType, typename CallableType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::Handler>* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::handlersBefore = nullptr;
-
-template <typename TCallable, TCallable Callable, bool bIsConst, typename ReturnType, typename CallableType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::HandlerAfter>* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::handlersAfter = nullptr;
-
+typename HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::HandlerListsType* HookInvokerExecutorMemberFunction<TCallable, Callable, bIsConst, ReturnType, CallableType, ArgumentTypes...>::handlerLists = nullptr;
 
-template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
-typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::HookType HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::functionPtr = nullptr;
 
 template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
 bool HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::bHookInitialized = false;
 
 template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::Handler>* HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::handlersBefore = nullptr;
-
-template <typename TCallable, TCallable Callable, typename ReturnType, typename... ArgumentTypes>
-TArray<typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::HandlerAfter>* HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::handlersAfter = nullptr;
+typename HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::HandlerListsType* HookInvokerExecutorGlobalFunction<TCallable, Callable, ReturnType, ArgumentTypes...>::handlerLists = nullptr;
 
 
+//Subscription macros return FDelegateHandle that can be passed to the matching UNSUBSCRIBE_METHOD macro
+//Handlers bound to world or module lifetime should be unsubscribed when their owner is destroyed,
+//otherwise they will keep running on every call of the hooked function forever
 #define SUBSCRIBE_METHOD(MethodReference, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference)); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerBefore(Handler);
+(HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference)), \
+HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerBefore(Handler))
 
 #define SUBSCRIBE_METHOD_AFTER(MethodReference, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference)); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerAfter(Handler);
+(HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference)), \
+HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerAfter(Handler))
 
 #define SUBSCRIBE_METHOD_VIRTUAL(MethodReference, SampleObjectInstance, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerBefore(Handler);
+(HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance), \
+HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerBefore(Handler))
 
 #define SUBSCRIBE_METHOD_VIRTUAL_AFTER(MethodReference, SampleObjectInstance, Handler) \
-HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance); \
-HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerAfter(Handler);
+(HookInvoker<decltype(&MethodReference), &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance), \
+HookInvoker<decltype(&MethodReference), &MethodReference>::addHandlerAfter(Handler))
 
 #define SUBSCRIBE_METHOD_EXPLICIT_VIRTUAL_AFTER(MethodSignature, MethodReference, SampleObjectInstance, Handler) \
-HookInvoker<MethodSignature, &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance); \
-HookInvoker<MethodSignature, &MethodReference>::addHandlerAfter(Handler);
\ No newline at end of file
+(HookInvoker<MethodSignature, &MethodReference>::InstallHook(TEXT(#MethodReference), SampleObjectInstance), \
+HookInvoker<MethodSignature, &MethodReference>::addHandlerAfter(Handler))
+
+//Removes handler subscribed by any of the SUBSCRIBE_METHOD macros. Returns false if handle is not subscribed to this method
+//Handler is destroyed only after all hook calls currently running it are finished
+#define UNSUBSCRIBE_METHOD(MethodReference, Handle) \
+HookInvoker<decltype(&MethodReference), &MethodReference>::removeHandler(Handle)
+
+//Same as UNSUBSCRIBE_METHOD, but also restores the original function code when no handlers are left
+//Function code is patched in place, so it should only be used when function cannot be called concurrently
+#define UNSUBSCRIBE_METHOD_AND_UNINSTALL(MethodReference, Handle) \
+HookInvoker<decltype(&MethodReference), &MethodReference>::removeHandler(Handle, true)
+
+#define UNSUBSCRIBE_METHOD_EXPLICIT(MethodSignature, MethodReference, Handle) \
+HookInvoker<MethodSignature, &MethodReference>::removeHandler(Handle)
@@ -0,0 +1,75 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "FGRemoteCallObject.h"
+#include "Engine/EngineBaseTypes.h"
+#include "Registry/RemoteCallObjectRegistry.h"
+#include "ModRemoteCallChannel.generated.h"
+
+/**
+ * Shared remote call channel multiplexing small mod calls registered in URemoteCallObjectRegistry
+ * Calls are identified by their interned ids and queued until the next net update of the world,
+ * when all of the queued calls are sent in a single batch RPC instead of one RPC per call
+ *
+ * Clients send calls to the server, and server sends them to the client owning the player controller
+ * Every call can only be sent in the direction it has been registered with, and calls received from the other side are dropped
+ */
+UCLASS(NotBlueprintable)
+class SML_API UModRemoteCallChannel : public UFGRemoteCallObject {
+    GENERATED_BODY()
+public:
+    /** Returns channel of the player controller, or nullptr if remote call objects have not been registered on it yet */
+    static UModRemoteCallChannel* Get(class AFGPlayerController* PlayerController);
+
+    /**
+     * Queues registered call to be sent to the remote side with the next net update
+     * Delivery guarantees are determined by the mode call has been registered with
+     */
+    void QueueCall(uint32 CallId, const TArray<uint8>& Payload);
+
+    /** Sends all of the queued calls right away. Called automatically before the net update of the world */
+    void FlushCalls();
+
+    UFUNCTION(Server, Reliable, WithValidation)
+    void Server_ReceiveReliableBatch(const TArray<uint8>& Batch);
+
+    UFUNCTION(Server, Unreliable, WithValidation)
+    void Server_ReceiveUnreliableBatch(const TArray<uint8>& Batch);
+
+    UFUNCTION(Client, Reliable)
+    void Client_ReceiveReliableBatch(const TArray<uint8>& Batch);
+
+    UFUNCTION(Client, Unreliable)
+    void Client_ReceiveUnreliableBatch(const TArray<uint8>& Batch);
+
+    void GetLifetimeReplicatedProps(TArray<class FLifetimeProperty>& OutLifetimeProps) const override;
+private:
+    friend class URemoteCallObjectRegistry;
+
+    struct FQueuedCall {
+        uint32 CallId;
+        TArray<uint8> Payload;
+    };
+    /** Reliable calls of all modes, in the order they have been queued */
+    TArray<FQueuedCall> ReliableCalls;
+    /** Unreliable calls, in the order they have been queued */
+    TArray<FQueuedCall> UnreliableCalls;
+    /** Index of the pending call in ReliableCalls for every coalesced call id */
+    TMap<uint32, int32> CoalescedCallIndices;
+    bool bFlushScheduled;
+
+    /** Needed for RCO to work */
+    UPROPERTY(Replicated)
+    int32 DummyReplicatedField;
+
+    /** Channels with queued calls, flushed before the net update of their world */
+    static TArray<TWeakObjectPtr<UModRemoteCallChannel>> ChannelsPendingFlush;
+
+    /** Splits calls into the batches no larger than the limit and sends every one of them, emptying the calls array */
+    void SendBatches(TArray<FQueuedCall>& Calls, int32 MaxBatchSize, bool bReliable);
+    void SendBatch(const TArray<uint8>& Batch, bool bReliable);
+    /** Dispatches calls of the batch. Calls not matching the direction are dropped, unset direction accepts calls looped back on the listen server host */
+    void ReceiveBatch(const TArray<uint8>& Batch, TOptional<EModRemoteCallDirection> Direction);
+
+    /** Flushes channels of the world, bound to the world post actor tick which happens right before the net update */
+    static void FlushChannelsOfWorld(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+};
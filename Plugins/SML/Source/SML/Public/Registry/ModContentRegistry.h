@@ -68,6 +68,33 @@ struct SML_API FResearchTreeRegistrationInfo : public FBasicRegistrationInfo {
 public:
 };
 
+//Read-only view over the registration entries of a registry state, iterating entries by reference without copying them
+//View is only valid until the next registration into the registry it was retrieved from
+template<typename T>
+struct TRegistrationInfoView {
+private:
+    const TArray<TSharedPtr<T>>* Entries;
+public:
+    struct FIterator {
+    private:
+        const TSharedPtr<T>* Current;
+    public:
+        FORCEINLINE explicit FIterator(const TSharedPtr<T>* Current) : Current(Current) {}
+        FORCEINLINE const T& operator*() const { return **Current; }
+        FORCEINLINE const T* operator->() const { return Current->Get(); }
+        FORCEINLINE FIterator& operator++() { ++Current; return *this; }
+        FORCEINLINE bool operator!=(const FIterator& Other) const { return Current != Other.Current; }
+    };
+
+    FORCEINLINE explicit TRegistrationInfoView(const TArray<TSharedPtr<T>>& Entries) : Entries(&Entries) {}
+
+    FORCEINLINE int32 Num() const { return Entries->Num(); }
+    FORCEINLINE const T& operator[](int32 Index) const { return *(*Entries)[Index]; }
+
+    FORCEINLINE FIterator begin() const { return FIterator(Entries->GetData()); }
+    FORCEINLINE FIterator end() const { return FIterator(Entries->GetData() + Entries->Num()); }
+};
+
 //Type T has to be serializable and should have serializable member with name RegisteredObject
 //Warning! You should manually call AddReferencedObjects so objects contained in this registry don't get GC'd
 template<typename T>
@@ -81,9 +108,6 @@ private:
     //Used for fast AddReferencedObjects implementation
     //It cannot be UPROPERTY() because UHT won't understand UPROPERTY() declaration inside template struct
     TArray<UObject*> ReferencedObjects;
-
-    /** Registration counter for this registry. Incremented every time registration occurs */
-    int64 RegistrationCounter = 0;
 public:
     FORCEINLINE bool ContainsObject(const KeyType& KeyType) const {
         return RegistrationMap.Contains(KeyType);
@@ -95,7 +119,6 @@ public:
         RegistrationList.Add(RegistrationEntry);
         RegistrationMap.Add(RegistrationEntry->RegisteredObject, RegistrationEntry);
         ReferencedObjects.Add(RegistrationEntry->RegisteredObject);
-        RegistrationCounter++;
         return RegistrationEntry;
     }
 
@@ -108,8 +131,36 @@ public:
         return RegistrationList;
     }
 
-    FORCEINLINE int64 GetRegistrationCounter() const {
-        return RegistrationCounter;
+    FORCEINLINE TRegistrationInfoView<T> GetView() const {
+        return TRegistrationInfoView<T>(RegistrationList);
+    }
+
+    /** Returns pointer to the registration entry, valid for as long as the registry itself, or NULL if object is not registered */
+    FORCEINLINE const T* FindObjectPtr(const KeyType& KeyType) const {
+        TSharedPtr<T> const* Object = RegistrationMap.Find(KeyType);
+        return Object ? Object->Get() : NULL;
+    }
+
+    /** Copies up to Count registration entries starting at Offset, in registration order */
+    void GetObjectsPage(int32 Offset, int32 Count, TArray<T>& OutObjects) const {
+        OutObjects.Reset();
+        const int32 StartIndex = FMath::Clamp(Offset, 0, RegistrationList.Num());
+        const int32 EndIndex = StartIndex + FMath::Clamp(Count, 0, RegistrationList.Num() - StartIndex);
+        OutObjects.Reserve(EndIndex - StartIndex);
+        for (int32 i = StartIndex; i < EndIndex; i++) {
+            OutObjects.Add(*RegistrationList[i]);
+        }
+    }
+
+    /** Returns registered objects without their registration entries */
+    template<typename ClassType>
+    TArray<TSubclassOf<ClassType>> GetRegisteredClasses() const {
+        TArray<TSubclassOf<ClassType>> OutClasses;
+        OutClasses.Reserve(RegistrationList.Num());
+        for (const TSharedPtr<T>& RegistrationEntry : RegistrationList) {
+            OutClasses.Add(RegistrationEntry->RegisteredObject);
+        }
+        return OutClasses;
     }
 
     FORCEINLINE void AddReferencedObjects(UObject* Outer, FReferenceCollector& ReferenceCollector) {
@@ -117,9 +168,75 @@ public:
     }
 };
 
+//Set-backed adjacency between two kinds of registered content, indexed in both directions
+//Classes stored there are always registered in one of the registry states, so they are kept alive by them
+template<typename TFrom, typename TTo>
+struct TRegistryDependencyIndex {
+private:
+    TMap<UClass*, TSet<UClass*>> ReferencedByFrom;
+    TMap<UClass*, TSet<UClass*>> ReferencersOfTo;
+
+    template<typename T>
+    FORCEINLINE static TArray<TSubclassOf<T>> ToClassArray(const TSet<UClass*>* ClassSet) {
+        TArray<TSubclassOf<T>> Result;
+        if (ClassSet != NULL) {
+            Result.Reserve(ClassSet->Num());
+            for (UClass* Class : *ClassSet) {
+                Result.Add(Class);
+            }
+        }
+        return Result;
+    }
+public:
+    /** Records that From references To, returns false if relationship has already been recorded */
+    FORCEINLINE bool AddEdge(UClass* From, UClass* To) {
+        bool bIsAlreadyInSet = false;
+        ReferencedByFrom.FindOrAdd(From).Add(To, &bIsAlreadyInSet);
+        if (!bIsAlreadyInSet) {
+            ReferencersOfTo.FindOrAdd(To).Add(From);
+        }
+        return !bIsAlreadyInSet;
+    }
+
+    /** Returns set of objects referenced by the provided one, or NULL if it doesn't reference anything */
+    FORCEINLINE const TSet<UClass*>* FindReferenced(UClass* From) const {
+        return ReferencedByFrom.Find(From);
+    }
+
+    /** Returns set of objects referencing the provided one, or NULL if nothing references it */
+    FORCEINLINE const TSet<UClass*>* FindReferencers(UClass* To) const {
+        return ReferencersOfTo.Find(To);
+    }
+
+    FORCEINLINE TArray<TSubclassOf<TTo>> GetReferenced(UClass* From) const {
+        return ToClassArray<TTo>(FindReferenced(From));
+    }
+
+    FORCEINLINE TArray<TSubclassOf<TFrom>> GetReferencers(UClass* To) const {
+        return ToClassArray<TFrom>(FindReferencers(To));
+    }
+};
+
 struct FMissingObjectStruct {
     FString ObjectType;
     FString ObjectPath;
+    /** Mod owning the missing object, None if the object class could not be loaded at all */
+    FName OwnerModReference;
+};
+
+/** Results of reconciling saved data with the frozen registry state */
+struct SML_API FMissingContentReport {
+    /** Unregistered modded objects referenced in savegame, grouped by their owning mod. They are cleared from the save */
+    TMap<FName, TArray<FMissingObjectStruct>> MissingObjectsByMod;
+    /** Unregistered vanilla objects referenced in savegame. They are NOT cleared from the save */
+    TArray<FMissingObjectStruct> UnregisteredVanillaObjects;
+
+    /** Total amount of missing objects across all mods */
+    int32 GetMissingObjectCount() const;
+
+    FORCEINLINE bool IsEmpty() const {
+        return MissingObjectsByMod.Num() == 0 && UnregisteredVanillaObjects.Num() == 0;
+    }
 };
 
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnSchematicRegistered, TSubclassOf<UFGSchematic>, Schematic, FSchematicRegistrationInfo, RegistrationInfo);
@@ -203,8 +320,9 @@ public:
     UFUNCTION(BlueprintPure)
     FORCEINLINE TArray<FRecipeRegistrationInfo> GetRegisteredRecipes() const {
         TArray<FRecipeRegistrationInfo> RegistrationInfos;
-        for (const TSharedPtr<FRecipeRegistrationInfo>& RegistrationInfo : RecipeRegistryState.GetAllObjects()) {
-            RegistrationInfos.Add(*RegistrationInfo);
+        RegistrationInfos.Reserve(RecipeRegistryState.GetAllObjects().Num());
+        for (const FRecipeRegistrationInfo& RegistrationInfo : RecipeRegistryState.GetView()) {
+            RegistrationInfos.Add(RegistrationInfo);
         }
         return RegistrationInfos;
     }
@@ -220,8 +338,9 @@ public:
     UFUNCTION(BlueprintPure)
     FORCEINLINE TArray<FResearchTreeRegistrationInfo> GetRegisteredResearchTrees() const {
         TArray<FResearchTreeRegistrationInfo> RegistrationInfos;
-        for (const TSharedPtr<FResearchTreeRegistrationInfo>& RegistrationInfo : ResearchTreeRegistryState.GetAllObjects()) {
-            RegistrationInfos.Add(*RegistrationInfo);
+        RegistrationInfos.Reserve(ResearchTreeRegistryState.GetAllObjects().Num());
+        for (const FResearchTreeRegistrationInfo& RegistrationInfo : ResearchTreeRegistryState.GetView()) {
+            RegistrationInfos.Add(RegistrationInfo);
         }
         return RegistrationInfos;
     }
@@ -237,8 +356,9 @@ public:
     UFUNCTION(BlueprintPure)
     FORCEINLINE TArray<FSchematicRegistrationInfo> GetRegisteredSchematics() const {
         TArray<FSchematicRegistrationInfo> RegistrationInfos;
-        for (const TSharedPtr<FSchematicRegistrationInfo>& RegistrationInfo : SchematicRegistryState.GetAllObjects()) {
-            RegistrationInfos.Add(*RegistrationInfo);
+        RegistrationInfos.Reserve(SchematicRegistryState.GetAllObjects().Num());
+        for (const FSchematicRegistrationInfo& RegistrationInfo : SchematicRegistryState.GetView()) {
+            RegistrationInfos.Add(RegistrationInfo);
         }
         return RegistrationInfos;
     }
@@ -250,6 +370,120 @@ public:
         return RegistrationInfo.IsValid() ? *RegistrationInfo : FSchematicRegistrationInfo{};
     }
 
+    /** Retrieves all registered recipes having provided item descriptor as one of their products */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGRecipe>> GetRecipesProducingItem(TSubclassOf<UFGItemDescriptor> ItemDescriptor) const {
+        return RecipeProductIndex.GetReferencers(ItemDescriptor);
+    }
+
+    /** Retrieves all registered recipes having provided item descriptor as one of their ingredients */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGRecipe>> GetRecipesConsumingItem(TSubclassOf<UFGItemDescriptor> ItemDescriptor) const {
+        return RecipeIngredientIndex.GetReferencers(ItemDescriptor);
+    }
+
+    /** Retrieves product item descriptors of the registered recipe */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGItemDescriptor>> GetRecipeProducts(TSubclassOf<UFGRecipe> Recipe) const {
+        return RecipeProductIndex.GetReferenced(Recipe);
+    }
+
+    /** Retrieves ingredient item descriptors of the registered recipe */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGItemDescriptor>> GetRecipeIngredients(TSubclassOf<UFGRecipe> Recipe) const {
+        return RecipeIngredientIndex.GetReferenced(Recipe);
+    }
+
+    /** Retrieves all registered schematics unlocking provided recipe */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGSchematic>> GetSchematicsUnlockingRecipe(TSubclassOf<UFGRecipe> Recipe) const {
+        return SchematicRecipeIndex.GetReferencers(Recipe);
+    }
+
+    /** Retrieves all recipes unlocked by the registered schematic */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGRecipe>> GetRecipesUnlockedBySchematic(TSubclassOf<UFGSchematic> Schematic) const {
+        return SchematicRecipeIndex.GetReferenced(Schematic);
+    }
+
+    /** Retrieves all registered research trees containing provided schematic */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGResearchTree>> GetResearchTreesContainingSchematic(TSubclassOf<UFGSchematic> Schematic) const {
+        return ResearchTreeSchematicIndex.GetReferencers(Schematic);
+    }
+
+    /** Retrieves all schematics contained in the registered research tree */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGSchematic>> GetSchematicsInResearchTree(TSubclassOf<UFGResearchTree> ResearchTree) const {
+        return ResearchTreeSchematicIndex.GetReferenced(ResearchTree);
+    }
+
+    //Native accessors returning registration entries by reference. They avoid copying registration info structs and their arrays,
+    //but returned views and pointers are only valid until the next registration, so they should not be stored
+
+    FORCEINLINE TRegistrationInfoView<FRecipeRegistrationInfo> GetRecipeRegistrations() const { return RecipeRegistryState.GetView(); }
+    FORCEINLINE TRegistrationInfoView<FSchematicRegistrationInfo> GetSchematicRegistrations() const { return SchematicRegistryState.GetView(); }
+    FORCEINLINE TRegistrationInfoView<FResearchTreeRegistrationInfo> GetResearchTreeRegistrations() const { return ResearchTreeRegistryState.GetView(); }
+    /** Item descriptors known to the registry, which includes all item descriptors referenced by registered recipes */
+    FORCEINLINE TRegistrationInfoView<FItemRegistrationInfo> GetItemDescriptorRegistrations() const { return ItemRegistryState.GetView(); }
+
+    FORCEINLINE const FRecipeRegistrationInfo* FindRecipeRegistration(TSubclassOf<UFGRecipe> Recipe) const { return RecipeRegistryState.FindObjectPtr(Recipe); }
+    FORCEINLINE const FSchematicRegistrationInfo* FindSchematicRegistration(TSubclassOf<UFGSchematic> Schematic) const { return SchematicRegistryState.FindObjectPtr(Schematic); }
+    FORCEINLINE const FResearchTreeRegistrationInfo* FindResearchTreeRegistration(TSubclassOf<UFGResearchTree> ResearchTree) const { return ResearchTreeRegistryState.FindObjectPtr(ResearchTree); }
+    FORCEINLINE const FItemRegistrationInfo* FindItemDescriptorRegistration(TSubclassOf<UFGItemDescriptor> ItemDescriptor) const { return ItemRegistryState.FindObjectPtr(ItemDescriptor); }
+
+    /** Retrieves amount of currently registered recipes */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE int32 GetRegisteredRecipeCount() const { return RecipeRegistryState.GetAllObjects().Num(); }
+
+    /** Retrieves amount of currently registered schematics */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE int32 GetRegisteredSchematicCount() const { return SchematicRegistryState.GetAllObjects().Num(); }
+
+    /** Retrieves amount of currently registered research trees */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE int32 GetRegisteredResearchTreeCount() const { return ResearchTreeRegistryState.GetAllObjects().Num(); }
+
+    /** Retrieves amount of item descriptors known to the registry, which includes all item descriptors referenced by registered recipes */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE int32 GetItemDescriptorCount() const { return ItemRegistryState.GetAllObjects().Num(); }
+
+    /** Retrieves a page of registered recipes, in registration order. Returns total amount of registered recipes */
+    UFUNCTION(BlueprintCallable)
+    int32 GetRegisteredRecipesPage(int32 Offset, int32 Count, TArray<FRecipeRegistrationInfo>& OutRecipes) const;
+
+    /** Retrieves a page of registered schematics, in registration order. Returns total amount of registered schematics */
+    UFUNCTION(BlueprintCallable)
+    int32 GetRegisteredSchematicsPage(int32 Offset, int32 Count, TArray<FSchematicRegistrationInfo>& OutSchematics) const;
+
+    /** Retrieves a page of registered research trees, in registration order. Returns total amount of registered research trees */
+    UFUNCTION(BlueprintCallable)
+    int32 GetRegisteredResearchTreesPage(int32 Offset, int32 Count, TArray<FResearchTreeRegistrationInfo>& OutResearchTrees) const;
+
+    /**
+     * Retrieves a page of item descriptors known to the registry, in registration order. Returns total amount of them
+     * Unlike GetObtainableItemDescriptors, item descriptors not referenced by any recipe are included
+     */
+    UFUNCTION(BlueprintCallable)
+    int32 GetItemDescriptorsPage(int32 Offset, int32 Count, TArray<FItemRegistrationInfo>& OutItemDescriptors) const;
+
+    /** Retrieves classes of all registered recipes, cheaper than GetRegisteredRecipes when registration info is not needed */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGRecipe>> GetRegisteredRecipeClasses() const { return RecipeRegistryState.GetRegisteredClasses<UFGRecipe>(); }
+
+    /** Retrieves classes of all registered schematics, cheaper than GetRegisteredSchematics when registration info is not needed */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGSchematic>> GetRegisteredSchematicClasses() const { return SchematicRegistryState.GetRegisteredClasses<UFGSchematic>(); }
+
+    /** Retrieves classes of all registered research trees, cheaper than GetRegisteredResearchTrees when registration info is not needed */
+    UFUNCTION(BlueprintPure)
+    FORCEINLINE TArray<TSubclassOf<UFGResearchTree>> GetRegisteredResearchTreeClasses() const { return ResearchTreeRegistryState.GetRegisteredClasses<UFGResearchTree>(); }
+
+    /** Returns the result of the last savegame reconciliation. Only populated on authority after BeginPlay */
+    FORCEINLINE const FMissingContentReport& GetMissingContentReport() const {
+        return MissingContentReport;
+    }
+
     /** Returns true when given recipe is registered */
     UFUNCTION(BlueprintPure)
     FORCEINLINE bool IsRecipeRegistered(TSubclassOf<UFGRecipe> Recipe) const {
@@ -315,9 +549,15 @@ private:
     /** True if content registry is frozen and does not accept registrations anymore */
     bool bIsRegistryFrozen;
 
-    /** Internal state counters for vanilla managers */
-    int64 SchematicManagerInternalState;
-    int64 ResearchManagerInternalState;
+    /** Amount of registry entries already flushed into the vanilla managers, INDEX_NONE if they have not been flushed yet */
+    int32 SchematicManagerFlushedCount;
+    int32 ResearchManagerFlushedCount;
+
+    /** True when research trees have been added to the research manager, but unlocked research trees were not updated yet */
+    bool bPendingResearchTreeUpdate;
+
+    /** True when schematics have been added after the initial flush, and schematics flushed earlier were not re-checked for availability yet */
+    bool bPendingSchematicAvailabilityUpdate;
 
     /** True when we have subscribed to schematic manager delegates already */
     bool bSubscribedToSchematicManager;
@@ -346,11 +586,26 @@ private:
     /** List of all registered research trees */
     TInternalRegistryState<FResearchTreeRegistrationInfo> ResearchTreeRegistryState;
 
-    /** Flushes schematic registry state into schematic manager */
-    void FlushStateToSchematicManager(class AFGSchematicManager* SchematicManager) const;
+    /** Relationships between registered content, populated during registration */
+    TRegistryDependencyIndex<UFGRecipe, UFGItemDescriptor> RecipeProductIndex;
+    TRegistryDependencyIndex<UFGRecipe, UFGItemDescriptor> RecipeIngredientIndex;
+    TRegistryDependencyIndex<UFGSchematic, UFGRecipe> SchematicRecipeIndex;
+    TRegistryDependencyIndex<UFGResearchTree, UFGSchematic> ResearchTreeSchematicIndex;
+
+    /** Objects referenced by the loaded savegame that were not registered */
+    FMissingContentReport MissingContentReport;
 
-    /** Flushes research tree registry state into research manager */
-    void FlushStateToResearchManager(class AFGResearchManager* ResearchManager) const;
+    /**
+     * Flushes schematics registered since the last flush into schematic manager
+     * Once late registrations are fully flushed, schematics that were not available before are re-checked,
+     * since their availability can depend on the content registered later
+     * Stops once FlushDeadline (in FPlatformTime::Seconds) is reached, zero deadline means no limit
+     * @return true if schematic manager is fully up to date with the registry
+     */
+    bool FlushStateToSchematicManager(class AFGSchematicManager* SchematicManager, double FlushDeadline);
+
+    /** Flushes research trees registered since the last flush into research manager, same as FlushStateToSchematicManager */
+    bool FlushStateToResearchManager(class AFGResearchManager* ResearchManager, double FlushDeadline);
 
     /** Subscribes to schematic manager delegates */
     void SubscribeToSchematicManager(AFGSchematicManager* SchematicManager);
@@ -364,14 +619,19 @@ private:
 	/** Called when module content registration is finished and registry can be frozen */
 	void NotifyModuleRegistrationFinished();
 
-	/** Flushed pending resource sink registrations into the resource sink subsystem, if it is available */
-	void FlushPendingResourceSinkRegistrations();
+	/** Flushed pending resource sink registrations into the resource sink subsystem, if it is available. Zero deadline means no limit */
+	void FlushPendingResourceSinkRegistrations(double FlushDeadline = 0.0);
 
     /** Freezes registry in place and clears out all unreferenced objects */
     void FreezeRegistryState();
+    /**
+     * Checks all registered content for broken data and references, and logs found issues grouped by the owning mod
+     * Checks only read class default objects and run in parallel. Returns amount of found issues
+     */
+    int32 ValidateRegistryState() const;
     /** Ensures that registry is not frozen and we can perform registration */
     void EnsureRegistryUnfrozen() const;
-    /** Checks SaveGame fields for unregistered objects and NULLs. Requires registry to be frozen already */
+    /** Checks SaveGame fields for unregistered objects and NULLs, and fills MissingContentReport. Requires registry to be frozen already */
     void CheckSavedDataForMissingObjects();
 	/** Unlocks tutorial schematics if it's needed */
 	void UnlockTutorialSchematics();
@@ -383,15 +643,22 @@ private:
     /** Associate items referenced in recipe with given mod reference if they are not associated already */
     void MarkItemDescriptorsFromRecipe(const TSubclassOf<UFGRecipe>& Recipe, const FName ModReference);
 
+    /** Registers item descriptors from the recipe item amounts and records them in the provided index */
+    void MarkItemDescriptorsFromItemAmounts(const TSubclassOf<UFGRecipe>& Recipe, const TArray<FItemAmount>& ItemAmounts,
+        TRegistryDependencyIndex<UFGRecipe, UFGItemDescriptor>& DependencyIndex, const FName ModReference);
+
     /** Associate the customization recipe referenced in recipe with given mod reference if it is not associated already */
     void MarkCustomizationRecipeFromRecipe(const TSubclassOf<UFGRecipe>& Recipe, const FName ModReference);
 
     TSharedPtr<FItemRegistrationInfo> RegisterItemDescriptor(const FName OwnerModReference, const FName RegistrarModReference, const TSubclassOf<UFGItemDescriptor>& ItemDescriptor);
 
-    void FindMissingSchematics(class AFGSchematicManager* SchematicManager, TArray<FMissingObjectStruct>& MissingObjects, TArray<FMissingObjectStruct>& UnregisteredVanillaObjects) const;
-    void FindMissingResearchTrees(class AFGResearchManager* ResearchManager, TArray<FMissingObjectStruct>& MissingObjects, TArray<FMissingObjectStruct>& UnregisteredVanillaObjects) const;
-    void FindMissingRecipes(class AFGRecipeManager* RecipeManager, TArray<FMissingObjectStruct>& MissingObjects, TArray<FMissingObjectStruct>& UnregisteredVanillaObjects) const;
-    static void WarnAboutMissingObjects(const TArray<FMissingObjectStruct>& MissingObjects);
+    //Each of these removes unregistered modded objects from the manager in a single pass and records them in the report
+    void FindMissingSchematics(class AFGSchematicManager* SchematicManager, FMissingContentReport& Report) const;
+    void FindMissingResearchTrees(class AFGResearchManager* ResearchManager, FMissingContentReport& Report) const;
+    void FindMissingRecipes(class AFGRecipeManager* RecipeManager, FMissingContentReport& Report) const;
+    /** Adds unregistered object to the report, returns true if object is modded and should be cleared from the save */
+    static bool ReportUnregisteredObject(FMissingContentReport& Report, TSet<UClass*>& ReportedObjects, const TCHAR* ObjectType, UClass* Object, bool bIsVanilla);
+    static void WarnAboutMissingObjects(const FMissingContentReport& Report);
     static void WarnAboutUnregisteredVanillaObjects(const TArray<FMissingObjectStruct>& UnregisteredVanillaObjects);
 
     template<typename T>
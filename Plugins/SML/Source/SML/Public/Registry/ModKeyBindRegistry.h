@@ -2,6 +2,60 @@
 #include "FGInputLibrary.h"
 #include "ModKeyBindRegistry.generated.h"
 
+/** Single key binding registered as a part of the key bind batch */
+USTRUCT(BlueprintType)
+struct SML_API FModKeyBindRegistration {
+    GENERATED_BODY()
+
+    /** Information about key mapping being registered */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FInputActionKeyMapping KeyMapping;
+
+    /** Name of the key binding used for options/controls menu */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FText DisplayName;
+};
+
+/** Single axis binding registered as a part of the key bind batch */
+USTRUCT(BlueprintType)
+struct SML_API FModAxisBindRegistration {
+    GENERATED_BODY()
+
+    /** Information about axis key in positive direction (Scale > 0) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FInputAxisKeyMapping PositiveAxisMapping;
+
+    /** Information about axis key in negative direction (Scale < 0) */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FInputAxisKeyMapping NegativeAxisMapping;
+
+    /** Name of the positive axis binding for options/controls menu */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FText PositiveDisplayName;
+
+    /** Name of the negative axis binding for options/controls menu */
+    UPROPERTY(EditAnywhere, BlueprintReadWrite)
+    FText NegativeDisplayName;
+};
+
+class FModKeyBindRegistrationBatch;
+
+/**
+ * Groups all key and axis bindings registered during the lifetime of the scope into a single registration batch
+ * Existing mappings are looked up once for the whole batch, and keymaps of the active player inputs are rebuilt once the scope ends
+ * Mappings added to the input settings directly while the scope is active are not seen by the batch
+ * Nested scopes join the outermost one. Can only be used on the game thread
+ */
+struct SML_API FScopedModKeyBindBatch {
+    FScopedModKeyBindBatch();
+    ~FScopedModKeyBindBatch();
+
+    FScopedModKeyBindBatch(const FScopedModKeyBindBatch&) = delete;
+    FScopedModKeyBindBatch& operator=(const FScopedModKeyBindBatch&) = delete;
+private:
+    bool bOwnsBatch;
+};
+
 UCLASS()
 class SML_API UModKeyBindRegistry : public UBlueprintFunctionLibrary {
     GENERATED_BODY()
@@ -35,4 +89,23 @@ public:
      */
     UFUNCTION(BlueprintCallable)
     static void RegisterModAxisBind(const FString& ModReference, FInputAxisKeyMapping PositiveAxisMapping, FInputAxisKeyMapping NegativeAxisMapping, const FText& PositiveDisplayName, const FText& NegativeDisplayName);
+
+    /**
+     * Registers all of the given key and axis bindings and associates them with mod reference provided
+     * Every binding follows the same rules as with RegisterModKeyBind and RegisterModAxisBind, but existing mappings
+     * are only looked up once for the whole batch, and keymaps of the active player inputs are rebuilt once at the end
+     * Prefer this over registering bindings one by one when mod has more than a few of them
+     * When called inside of the FScopedModKeyBindBatch, bindings join the already active batch instead
+     *
+     * @param ModReference reference of the mod these bindings belong to
+     * @param KeyBinds key bindings to register
+     * @param AxisBinds axis bindings to register
+     */
+    UFUNCTION(BlueprintCallable)
+    static void RegisterModKeyBinds(const FString& ModReference, const TArray<FModKeyBindRegistration>& KeyBinds, const TArray<FModAxisBindRegistration>& AxisBinds);
+private:
+    friend struct FScopedModKeyBindBatch;
+
+    /** Batch opened by the outermost FScopedModKeyBindBatch, single registrations go through it while it is active */
+    static FModKeyBindRegistrationBatch* ActiveBatch;
 };
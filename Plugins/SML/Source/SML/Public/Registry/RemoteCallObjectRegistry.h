@@ -4,6 +4,45 @@
 #include "Kismet/BlueprintFunctionLibrary.h"
 #include "RemoteCallObjectRegistry.generated.h"
 
+DECLARE_LOG_CATEGORY_EXTERN(LogRemoteCallObjectRegistry, Log, All);
+DECLARE_DELEGATE_TwoParams(FOnModRemoteCallReceived, class AFGPlayerController* /*PlayerController*/, const TArray<uint8>& /*Payload*/);
+
+/** Delivery guarantees of the mod remote call */
+UENUM(BlueprintType)
+enum class EModRemoteCallMode : uint8 {
+    /** Call can be dropped, and is sent in the unreliable batch */
+    Unreliable,
+    /** Every call is delivered, in the order calls have been queued */
+    Reliable,
+    /**
+     * Only the latest call with the same id queued during one net update is delivered, earlier ones are discarded
+     * Suitable for calls carrying the complete state, like the position or the settings of something
+     */
+    ReliableLatestOnly
+};
+
+/** Side of the connection mod remote call is sent from */
+UENUM(BlueprintType)
+enum class EModRemoteCallDirection : uint8 {
+    /** Call is sent by the client and handled by the server */
+    ClientToServer,
+    /** Call is sent by the server and handled by the client owning the player controller */
+    ServerToClient
+};
+
+/** Call id that is never assigned to any mod remote call, returned when registration fails */
+static constexpr uint32 InvalidModRemoteCallId = 0;
+
+/** Mod remote call multiplexed through the shared UModRemoteCallChannel */
+struct FModRemoteCall {
+    FString Name;
+    EModRemoteCallMode Mode;
+    /** Calls received from the opposite direction are dropped, so clients cannot invoke calls meant for them on the server */
+    EModRemoteCallDirection Direction;
+    /** Called with the player controller owning the channel call has been received through */
+    FOnModRemoteCallReceived OnReceived;
+};
+
 UCLASS()
 class SML_API URemoteCallObjectRegistry : public UGameInstanceSubsystem {
     GENERATED_BODY()
@@ -11,6 +50,19 @@ public:
     UFUNCTION(BlueprintCallable)
     void RegisterRemoteCallObject(TSubclassOf<UFGRemoteCallObject> RemoteCallObject);
 
+    /**
+     * Registers small mod remote call multiplexed through the shared UModRemoteCallChannel
+     * Call id is the hash of the mod reference and call name, so it matches on client and server without any negotiation
+     * Calls should be registered on both sides before they are sent, calls with unknown ids are skipped
+     * Registration is rejected with an error when the id is already taken by another call, including a hash collision with another mod
+     *
+     * @return call id to be passed to UModRemoteCallChannel::QueueCall, or InvalidModRemoteCallId if registration has been rejected
+     */
+    uint32 RegisterModRemoteCall(const FString& ModReference, const FString& CallName, EModRemoteCallMode Mode, EModRemoteCallDirection Direction, const FOnModRemoteCallReceived& OnReceived);
+
+    /** Returns registered mod remote call with the provided id, or nullptr if there is none */
+    FORCEINLINE const FModRemoteCall* FindModRemoteCall(uint32 CallId) const { return ModRemoteCalls.Find(CallId); }
+
     virtual void Initialize(FSubsystemCollectionBase& Collection) override;
 private:
     friend class FSatisfactoryModLoader;
@@ -18,6 +70,9 @@ private:
     UPROPERTY()
     TArray<TSubclassOf<UFGRemoteCallObject>> RegisteredRCOs;
 
+    /** Registered mod remote calls by their ids */
+    TMap<uint32, FModRemoteCall> ModRemoteCalls;
+
     static void RegisterRCOsOnGameMode(class AGameModeBase* GameMode);
     
     /** Registers this registry related hooks */
@@ -23,7 +23,7 @@ public:
 	static TMap<FName, FString> GetExtraAttributes();
 	
 	/** Returns active SML configuration. If not loaded, it will return empty struct */
-	FORCEINLINE static FSMLConfiguration GetSMLConfiguration() { return SMLConfigurationPrivate; }
+	FORCEINLINE static const FSMLConfiguration& GetSMLConfiguration() { return SMLConfigurationPrivate; }
 private:
 	friend class FSMLModule;
 	
@@ -1,6 +1,7 @@
 #pragma once
 #include "CoreMinimal.h"
 #include "Kismet/BlueprintFunctionLibrary.h"
+#include "UObject/SoftObjectPath.h"
 #include "BlueprintAssetHelperLibrary.generated.h"
 
 UCLASS()
@@ -11,6 +12,12 @@ public:
 	UFUNCTION(BlueprintCallable)
 	static void FindBlueprintAssetsByTag(UClass* BaseClass, const FName TagName, const TArray<FString>& TagValues, TArray<UClass*>& FoundAssets);
 
+	/**
+	 * Finds generated class paths of the blueprint assets having (one of) provided values of the given asset tag, without loading them
+	 * Resulting classes are not guaranteed to be children of any particular class, so it should be verified after they are loaded
+	 */
+	static void FindBlueprintAssetClassPathsByTag(const FName TagName, const TArray<FString>& TagValues, TArray<FSoftClassPath>& OutClassPaths);
+
 	/** Iterates all loaded native classes and finds these extending the provided one. Will actually include even abstract classes! */
 	UFUNCTION(BlueprintCallable)
 	static void FindNativeClassesByType(UClass* BaseClass, TArray<UClass*>& FoundClasses);
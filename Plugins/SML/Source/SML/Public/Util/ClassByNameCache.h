@@ -0,0 +1,47 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "UObject/UObjectArray.h"
+
+/**
+ * Caches classes found by their names in any package, either directly or through the redirector with that name
+ * Classes are referenced weakly, so destroyed classes are detected on lookup, and entries are dropped once a redirector with the same name is created
+ * Names that could not be resolved are not cached, since the class can be loaded at any point later
+ */
+class SML_API FClassByNameCache : public FUObjectArray::FUObjectCreateListener {
+public:
+	/** Returns the global class cache, registering it's object create listener on first use */
+	static FClassByNameCache& Get();
+
+	/** Finds class by it's name, or by the name of the redirector pointing to it. Returns nullptr if there is no such class loaded */
+	UClass* FindClassByName(const FString& ClassName);
+
+	/** Finds classes for all of the provided names, OutClasses will have nullptr for every name that could not be resolved */
+	void FindClassesByName(const TArray<FString>& ClassNames, TArray<UClass*>& OutClasses);
+
+	/** Drops all of the cached entries */
+	void Reset();
+
+	//Begin FUObjectCreateListener
+	virtual void NotifyUObjectCreated(const UObjectBase* Object, int32 Index) override;
+	virtual void OnUObjectArrayShutdown() override;
+	//End FUObjectCreateListener
+private:
+	struct FCachedClass {
+		TWeakObjectPtr<UClass> Class;
+		/** True if class has been found through the redirector, so it's name will not match the cached one */
+		bool bResolvedThroughRedirector;
+	};
+
+	FClassByNameCache();
+
+	/** Returns cached class for the name, dropping the entry if it is no longer valid. Cache lock should be held by the caller */
+	UClass* FindCachedClassLocked(FName ClassName);
+
+	/** Resolves class by it's name without using the cache */
+	static UClass* ResolveClassByName(const FString& ClassName, bool& bOutResolvedThroughRedirector);
+
+	TMap<FName, FCachedClass> CachedClasses;
+	/** Redirectors can be created on the async loading thread, so cache access is guarded */
+	FCriticalSection CacheLock;
+	bool bListenersRegistered;
+};
@@ -2,6 +2,13 @@
 #include "CoreMinimal.h"
 #include "Engine/Texture2D.h"
 
+/** Raw image decoded into BGRA pixels with 8 bits per channel, matching EPixelFormat::PF_B8G8R8A8 */
+struct SML_API FDecodedImage {
+    int32 Width = 0;
+    int32 Height = 0;
+    TArray<uint8> BGRAData;
+};
+
 class SML_API FImageLoadingUtil {
 public:    
     /** Loads image from passed byte array and returns texture object */
@@ -9,4 +16,22 @@ public:
 
     /** Loads image from file at the given path */
     static UTexture2D* LoadImageFromFile(const FString& FilePath, FString& OutErrorMessage);
-};
+
+    /**
+     * Decodes image from passed byte array into raw pixels without creating any objects
+     * Safe to call from any thread, as long as ImageWrapper module has been loaded already (see EnsureImageWrapperModuleLoaded)
+     */
+    static bool DecodeImageFromByteArray(const TArray<uint8>& InByteArray, FDecodedImage& OutImage, FString& OutErrorMessage);
+
+    /** Reads and decodes image from file at the given path. Same threading rules as DecodeImageFromByteArray apply */
+    static bool DecodeImageFromFile(const FString& FilePath, FDecodedImage& OutImage, FString& OutErrorMessage);
+
+    /**
+     * Creates transient texture from the decoded image and uploads it's pixels. Must be called on the game thread
+     * Unlike LoadImageFromByteArray, texture is not added to the root set, so caller is responsible for keeping it referenced
+     */
+    static UTexture2D* CreateTextureFromDecodedImage(const FDecodedImage& Image, FString& OutErrorMessage);
+
+    /** Makes sure ImageWrapper module is loaded. Must be called on the game thread before decoding images on the worker threads */
+    static void EnsureImageWrapperModuleLoaded();
+};
\ No newline at end of file
@@ -0,0 +1,92 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "HAL/PlatformTime.h"
+#include "Util/ProfilingToolConsole.h"
+#include <atomic>
+
+DECLARE_LOG_CATEGORY_EXTERN(LogPhaseTimeline, Log, All);
+
+/** Single recorded span of the timeline */
+struct SML_API FPhaseTimelineSpan {
+	/** Category of the span, e.g WorldModule or ContentRegistry. Always a string literal */
+	const TCHAR* Category;
+	/** Phase inside of the category. Always a string literal */
+	const TCHAR* Phase;
+	/** Mod the span is attributed to, or None if it is not attributed to any particular mod */
+	FName ModReference;
+	uint64 StartCycles;
+	uint64 EndCycles;
+	uint32 ThreadId;
+};
+
+/**
+ * Records startup and world loading phases (module construction and lifecycle events, configuration loading,
+ * content registry discovery) attributed to the mods they are performed for, and exports them as Chrome trace JSON
+ * that can be opened in chrome://tracing or Perfetto
+ *
+ * Recording is disabled by default and can be toggled using SML.Timeline.Enabled console variable,
+ * or enabled from the process start using -SMLTimeline command line switch
+ * Results are written using SML.Timeline.Dump [FilePath] console command
+ */
+class SML_API FPhaseTimeline {
+public:
+	/** Returns true if timeline recording is currently enabled. Can be called from any thread */
+	FORCEINLINE static bool IsEnabled() { return bEnabled.load(std::memory_order_relaxed); }
+
+	/** Enables or disables timeline recording */
+	static void SetEnabled(bool bNewEnabled);
+
+	/** Records a completed span. Category and Phase must be string literals, since they are not copied */
+	static void RecordSpan(const TCHAR* Category, const TCHAR* Phase, FName ModReference, uint64 StartCycles, uint64 EndCycles);
+
+	/** Drops all of the recorded spans */
+	static void Reset();
+
+	/** Serializes recorded spans into Chrome trace event format JSON */
+	static FString ExportChromeTrace();
+
+	/**
+	 * Writes recorded spans into the file as Chrome trace, and logs mods that took the most time
+	 * When FilePath is empty, a file in the Saved/Profiling directory is created
+	 * @return true if file has been written successfully
+	 */
+	static bool DumpToFile(const FString& FilePath, FString& OutFilePath);
+private:
+	static std::atomic<bool> bEnabled;
+	static FProfilingToolConsole Console;
+};
+
+/**
+ * Records a timeline span covering the lifetime of the scope
+ * Start time is only taken when recording is enabled at the moment the scope is entered
+ */
+struct FPhaseTimelineScope {
+private:
+	const TCHAR* Category;
+	const TCHAR* Phase;
+	FName ModReference;
+	uint64 StartCycles;
+public:
+	FORCEINLINE FPhaseTimelineScope(const TCHAR* InCategory, const TCHAR* InPhase, FName InModReference = NAME_None) :
+		Category(InCategory), Phase(InPhase), ModReference(InModReference),
+		StartCycles(FPhaseTimeline::IsEnabled() ? FPlatformTime::Cycles64() : 0) {
+	}
+
+	/** Mod reference is only converted to the name when recording is enabled */
+	FORCEINLINE FPhaseTimelineScope(const TCHAR* InCategory, const TCHAR* InPhase, const FString& InModReference) :
+		Category(InCategory), Phase(InPhase), StartCycles(0) {
+		if (FPhaseTimeline::IsEnabled()) {
+			ModReference = *InModReference;
+			StartCycles = FPlatformTime::Cycles64();
+		}
+	}
+
+	FORCEINLINE ~FPhaseTimelineScope() {
+		if (StartCycles != 0) {
+			FPhaseTimeline::RecordSpan(Category, Phase, ModReference, StartCycles, FPlatformTime::Cycles64());
+		}
+	}
+
+	FPhaseTimelineScope(const FPhaseTimelineScope&) = delete;
+	FPhaseTimelineScope& operator=(const FPhaseTimelineScope&) = delete;
+};
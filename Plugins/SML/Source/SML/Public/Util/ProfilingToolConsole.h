@@ -0,0 +1,58 @@
+#pragma once
+#include "CoreMinimal.h"
+#include "Templates/Function.h"
+#include <atomic>
+
+DECLARE_LOG_CATEGORY_EXTERN(LogProfilingTool, Log, All);
+
+/**
+ * Console plumbing shared by SML profiling tools
+ * Registers <Prefix>.Enabled console variable driving the enabled flag of the tool, and <Prefix>.Dump and <Prefix>.Reset commands
+ * Dumps without an explicit path are written into the Saved/Profiling/SML directory
+ *
+ * Should be declared as a static variable in the translation unit implementing the tool,
+ * and console objects are unregistered once it is destroyed
+ */
+class SML_API FProfilingToolConsole {
+public:
+	/** Writes the dump, with Args being the arguments of the dump command. Returns false if nothing has been written */
+	using FDumpFunction = TFunction<bool(const TArray<FString>& Args, FString& OutFilePath)>;
+
+	/**
+	 * @param InToolName human readable name of the tool, used in the log messages
+	 * @param ConsolePrefix prefix of the console variable and commands, e.g SML.HookProfiler
+	 * @param InEnabledFlag flag read by the tool on the hot path, only ever written by the console
+	 * @param CommandLineSwitch optional switch enabling the tool from the process start, before any console command can run
+	 */
+	FProfilingToolConsole(const TCHAR* InToolName, const TCHAR* ConsolePrefix, std::atomic<bool>& InEnabledFlag,
+		const TCHAR* EnabledHelp, const TCHAR* DumpHelp, FDumpFunction InDumpFunction, TFunction<void()> InResetFunction,
+		const TCHAR* CommandLineSwitch = NULL);
+	~FProfilingToolConsole();
+
+	FProfilingToolConsole(const FProfilingToolConsole&) = delete;
+	FProfilingToolConsole& operator=(const FProfilingToolConsole&) = delete;
+
+	/** Enables or disables the tool, logging the change */
+	void SetEnabled(bool bNewEnabled);
+
+	/** Returns provided path, or a new timestamped file path in the Saved/Profiling/SML directory if it is empty */
+	static FString MakeDumpFilePath(const FString& FilePath, const TCHAR* FileNamePrefix, const TCHAR* Extension);
+
+	/** Writes the contents of the dump into the file, logging an error if it fails */
+	static bool WriteDumpFile(const FString& Contents, const FString& FilePath);
+
+	/** Logs entries taking the most time, sorted by the time descending. Values are in milliseconds */
+	static void LogTopEntries(const FString& Title, TMap<FString, double> TimeByEntry, int32 MaxEntries = 10);
+private:
+	FString ToolName;
+	std::atomic<bool>& EnabledFlag;
+	FDumpFunction DumpFunction;
+	TFunction<void()> ResetFunction;
+
+	class IConsoleVariable* EnabledVariable;
+	class IConsoleObject* DumpCommand;
+	class IConsoleObject* ResetCommand;
+
+	void HandleEnabledChanged(class IConsoleVariable* Variable);
+	void HandleDumpCommand(const TArray<FString>& Args);
+};
@@ -45,6 +45,13 @@ public:
 		*/
 		UFUNCTION(BlueprintCallable, Category = "SML | Class")
 		static UClass * FindClassByName(FString ClassNameInput);
+
+		/** 
+		*	Batched FindClassByName, resolves all of the names at once
+		*	Result has the same order as input names, and None for names that could not be resolved
+		*/
+		UFUNCTION(BlueprintCallable, Category = "SML | Class")
+		static TArray<UClass*> FindClassesByName(const TArray<FString>& ClassNames);
 		
 		/** Returns true in Editor*/
 		UFUNCTION(BlueprintPure, Category = "SML")
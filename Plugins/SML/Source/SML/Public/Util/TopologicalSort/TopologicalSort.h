@@ -3,62 +3,138 @@
 #include "Util/TopologicalSort/DirectedGraph.h"
 
 /**
- * Handles topological sorting of the directed graph
+ * Directed graph compressed into integer node indices, with edges of every node stored in a single flat array
+ * Node values are only hashed once when graph is compressed, so sorting itself never touches them
  */
-class FTopologicalSort {
-public:
-	template<typename T>
-    static bool ExploreNode(const T& Node, const TDirectedGraph<T>& Graph, TArray<T>& SortedResult, TSet<T>& VisitedNodes, TSet<T>& ExpandedNodes, TSet<T>* OutCycleNodes) {
-		// Have we been here before?
-		if (VisitedNodes.Contains(Node)) {
-			// And have completed this node before
-			if (ExpandedNodes.Contains(Node)) {
-				// Then we're fine
-				return true;
-			}
-			//It's a cycle in the input graph, so sorting is not possible, faulty nodes are the difference between already visited but not yet expanded nodes
-			const TSet<T> CycleList = VisitedNodes.Difference(ExpandedNodes);
-			if (OutCycleNodes) {
-				OutCycleNodes->Append(CycleList);
-			}
-			return false;
-		}
+struct SML_API FCompressedDirectedGraph {
+	/** Edges of the node N are EdgeTargets[EdgeOffsets[N]..EdgeOffsets[N + 1]) */
+	TArray<int32> EdgeOffsets;
+	TArray<int32> EdgeTargets;
 
-		// Visit this node
-		VisitedNodes.Add(Node);
+	FORCEINLINE int32 Num() const { return EdgeOffsets.Num() - 1; }
 
-		// Recursively explore inbound edges
-		bool bVisitedChildren = true;
-		for (const T& Inbound : Graph.EdgesFrom(Node)) {
-			bVisitedChildren &= ExploreNode(Inbound, Graph, SortedResult, VisitedNodes, ExpandedNodes, OutCycleNodes);
+	/** Compresses the graph, node indices match the order of TDirectedGraph::GetNodes */
+	template<typename T>
+	static FCompressedDirectedGraph Compress(const TDirectedGraph<T>& Graph) {
+		const TArray<T>& Nodes = Graph.GetNodes();
+		TMap<T, int32> NodeIndices;
+		NodeIndices.Reserve(Nodes.Num());
+		for (int32 i = 0; i < Nodes.Num(); i++) {
+			NodeIndices.Add(Nodes[i], i);
 		}
 
-		// Add ourselves now
-		SortedResult.Add(Node);
-		// And mark ourselves as explored
-		ExpandedNodes.Add(Node);
-		return bVisitedChildren;
+		FCompressedDirectedGraph Result;
+		Result.EdgeOffsets.Reserve(Nodes.Num() + 1);
+		for (const T& Node : Nodes) {
+			Result.EdgeOffsets.Add(Result.EdgeTargets.Num());
+			for (const T& To : Graph.EdgesFrom(Node)) {
+				Result.EdgeTargets.Add(NodeIndices.FindChecked(To));
+			}
+		}
+		Result.EdgeOffsets.Add(Result.EdgeTargets.Num());
+		return Result;
 	}
+};
+
+/** Result of the topological sort over the node indices of the compressed graph */
+struct SML_API FTopologicalSortIndexResult {
+	/** Sorted node indices, every node comes after all of the nodes having edges into it. Does not include nodes depending on the cycles */
+	TArray<int32> SortedNodes;
+	/** Level of the node is SortedNodes[LevelOffsets[Level]..LevelOffsets[Level + 1]) */
+	TArray<int32> LevelOffsets;
+	/** Every cycle found, as a path of nodes where each node has an edge into the next one, and the last one into the first one */
+	TArray<TArray<int32>> Cycles;
+};
+
+/**
+ * Handles topological sorting of the directed graph
+ * Uses iterative Kahn's algorithm, so it does not depend on the stack depth and runs in linear time
+ */
+class SML_API FTopologicalSort {
+public:
+	/**
+	 * Sorts the compressed graph and groups sorted nodes into levels
+	 * Nodes of every level only have edges coming from the nodes of the earlier levels, so nodes of the same level are independent
+	 * @return true if sorting was successful (e.g no cycles were encountered), false otherwise
+	 */
+	static bool SortIndices(const FCompressedDirectedGraph& Graph, FTopologicalSortIndexResult& OutResult);
 
 	/**
 	 * Performs a topological dependency sorting on a provided directed graph
 	 *
 	 * @param Graph graph to perform topological sort on
-	 * @param OutSortedNodes sorted nodes of the graph will be emitted into that array
+	 * @param OutSortedNodes sorted nodes of the graph will be emitted into that array. Nodes that could not be sorted because of cycles are appended to the end
 	 * @param OutCycleNodes pointer to the array in which cycle nodes will be reported
 	 * @return true if sorting was successful (e.g no cycle nodes were encountered), false otherwise
 	 */
 	template<typename T>
 	static bool TopologicalSort(const TDirectedGraph<T>& Graph, TArray<T>& OutSortedNodes, TSet<T>* OutCycleNodes = NULL) {
-		TDirectedGraph<T> ReversedGraph = Graph.InverseGraph();
-		TSet<T> VisitedNodes;
-		// A list of "fully explored" nodes. Leftovers in here indicate cycles in the graph
-		TSet<T> ExpandedNodes;
-		bool bSortingSuccess = true;
-		
-		for (const T& Node : ReversedGraph.OrderedNodes) {
-			bSortingSuccess &= ExploreNode(Node, ReversedGraph, OutSortedNodes, VisitedNodes, ExpandedNodes, OutCycleNodes);
+		const TArray<T>& Nodes = Graph.GetNodes();
+		FTopologicalSortIndexResult SortResult;
+		const bool bSortingSuccess = SortIndices(FCompressedDirectedGraph::Compress(Graph), SortResult);
+
+		OutSortedNodes.Reserve(OutSortedNodes.Num() + Nodes.Num());
+		for (const int32 NodeIndex : SortResult.SortedNodes) {
+			OutSortedNodes.Add(Nodes[NodeIndex]);
+		}
+		if (!bSortingSuccess) {
+			AppendUnsortedNodes(Nodes, SortResult, OutSortedNodes);
+			if (OutCycleNodes) {
+				for (const TArray<int32>& Cycle : SortResult.Cycles) {
+					for (const int32 NodeIndex : Cycle) {
+						OutCycleNodes->Add(Nodes[NodeIndex]);
+					}
+				}
+			}
 		}
 		return bSortingSuccess;
 	}
+
+	/**
+	 * Performs a topological sorting and groups sorted nodes into levels, nodes of the same level do not depend on each other
+	 * and can be processed in parallel once all of the earlier levels have been processed
+	 *
+	 * @param Graph graph to perform topological sort on
+	 * @param OutLevels sorted nodes grouped by their levels. Nodes that could not be sorted because of cycles are omitted
+	 * @param OutCyclePaths pointer to the array in which every found cycle is reported as the path of nodes
+	 * @return true if sorting was successful (e.g no cycles were encountered), false otherwise
+	 */
+	template<typename T>
+	static bool TopologicalSortLevels(const TDirectedGraph<T>& Graph, TArray<TArray<T>>& OutLevels, TArray<TArray<T>>* OutCyclePaths = NULL) {
+		const TArray<T>& Nodes = Graph.GetNodes();
+		FTopologicalSortIndexResult SortResult;
+		const bool bSortingSuccess = SortIndices(FCompressedDirectedGraph::Compress(Graph), SortResult);
+
+		const int32 LevelCount = SortResult.LevelOffsets.Num() - 1;
+		OutLevels.Reserve(OutLevels.Num() + LevelCount);
+		for (int32 Level = 0; Level < LevelCount; Level++) {
+			TArray<T>& LevelNodes = OutLevels.AddDefaulted_GetRef();
+			LevelNodes.Reserve(SortResult.LevelOffsets[Level + 1] - SortResult.LevelOffsets[Level]);
+			for (int32 i = SortResult.LevelOffsets[Level]; i < SortResult.LevelOffsets[Level + 1]; i++) {
+				LevelNodes.Add(Nodes[SortResult.SortedNodes[i]]);
+			}
+		}
+		if (OutCyclePaths) {
+			for (const TArray<int32>& Cycle : SortResult.Cycles) {
+				TArray<T>& CyclePath = OutCyclePaths->AddDefaulted_GetRef();
+				for (const int32 NodeIndex : Cycle) {
+					CyclePath.Add(Nodes[NodeIndex]);
+				}
+			}
+		}
+		return bSortingSuccess;
+	}
+private:
+	template<typename T>
+	static void AppendUnsortedNodes(const TArray<T>& Nodes, const FTopologicalSortIndexResult& SortResult, TArray<T>& OutSortedNodes) {
+		TBitArray<> SortedNodeMask(false, Nodes.Num());
+		for (const int32 NodeIndex : SortResult.SortedNodes) {
+			SortedNodeMask[NodeIndex] = true;
+		}
+		for (int32 i = 0; i < Nodes.Num(); i++) {
+			if (!SortedNodeMask[i]) {
+				OutSortedNodes.Add(Nodes[i]);
+			}
+		}
+	}
 };